@@ -10,11 +10,33 @@
 
 #include "../util/array2.h"
 #include "../util/util.h"
+#include <algorithm>
+#include <array>
 #include <vector>
 
+// Width in bytes of the vector registers targeted by bsplineBasisLanes()
+#ifndef TINYNURBS_SIMD_BYTES
+#if defined(__AVX512F__)
+#define TINYNURBS_SIMD_BYTES 64
+#elif defined(__AVX2__) || defined(__AVX__)
+#define TINYNURBS_SIMD_BYTES 32
+#else
+#define TINYNURBS_SIMD_BYTES 16
+#endif
+#endif
+
 namespace tinynurbs
 {
 
+/**
+ * Number of parameters evaluated together by bsplineBasisLanes(), i.e. the
+ * number of values of type T that fit in one vector register
+ */
+template <typename T> constexpr unsigned int simdLanes()
+{
+    return TINYNURBS_SIMD_BYTES / sizeof(T) > 0 ? TINYNURBS_SIMD_BYTES / sizeof(T) : 1;
+}
+
 /**
  * Find the span of the given parameter in the knot vector.
  * @param[in] degree Degree of the curve.
@@ -33,8 +55,9 @@ template <typename T> int findSpan(unsigned int degree, const std::vector<T> &kn
             return n;
         }
     */
-    // For values of u that lies outside the domain
-    if (u > (knots[n + 1] - std::numeric_limits<T>::epsilon()))
+    // For values of u that lies outside the domain. The comparison includes
+    // equality, since subtracting epsilon can round back to the last knot.
+    if (u >= (knots[n + 1] - std::numeric_limits<T>::epsilon()))
     {
         return n;
     }
@@ -43,24 +66,42 @@ template <typename T> int findSpan(unsigned int degree, const std::vector<T> &kn
         return degree;
     }
 
-    // Binary search
-    // TODO: Replace this with std::lower_bound
-    int low = degree;
-    int high = n + 1;
-    int mid = (int)std::floor((low + high) / 2.0);
-    while (u < knots[mid] || u >= knots[mid + 1])
+    // Last knot in [degree, n] that is not greater than u
+    auto it = std::upper_bound(knots.begin() + degree + 1, knots.begin() + n + 1, u);
+    return static_cast<int>(it - knots.begin()) - 1;
+}
+
+/**
+ * Find the span of the given parameter in the knot vector by walking forward
+ * from a previously found span. When parameters are visited in ascending order
+ * this is amortized O(1) per parameter; otherwise it falls back to findSpan().
+ * @param[in] degree Degree of the curve.
+ * @param[in] knots Knot vector of the curve.
+ * @param[in] u Parameter value.
+ * @param[in] hint Span of a previously visited parameter.
+ * @return Span index into the knot vector such that (span - 1) < u <= span
+ */
+template <typename T> int findSpan(unsigned int degree, const std::vector<T> &knots, T u, int hint)
+{
+    // index of last control point
+    int n = static_cast<int>(knots.size()) - degree - 2;
+    assert(n >= 0);
+    // Parameters at or before the start of the domain, or behind the hint
+    if (hint < static_cast<int>(degree) || hint > n || u < knots[hint] ||
+        u < (knots[degree] + std::numeric_limits<T>::epsilon()))
     {
-        if (u < knots[mid])
-        {
-            high = mid;
-        }
-        else
-        {
-            low = mid;
-        }
-        mid = (int)std::floor((low + high) / 2.0);
+        return findSpan(degree, knots, u);
+    }
+    // For values of u that lies outside the domain
+    if (u >= (knots[n + 1] - std::numeric_limits<T>::epsilon()))
+    {
+        return n;
     }
-    return mid;
+    while (hint < n && u >= knots[hint + 1])
+    {
+        ++hint;
+    }
+    return hint;
 }
 
 /**
@@ -115,90 +156,330 @@ template <typename T> T bsplineOneBasis(int i, unsigned int deg, const std::vect
     return N[0];
 }
 
+/////////////////////////////////////////////////////////////////////
+
+namespace internal
+{
+
 /**
- * Compute all non-zero B-spline basis functions
+ * Compute all non-zero B-spline basis functions of a degree known at compile
+ * time. The recurrences have constant trip counts and fixed-size storage, so the
+ * compiler can unroll them completely.
+ * @tparam Degree Degree of the basis functions.
+ * @param[in] span Index obtained from findSpan() corresponding the u and knots.
+ * @param[in] knots Knot vector corresponding to the basis functions.
+ * @param[in] u Parameter to evaluate the basis functions at.
+ * @param[out] N Values of (Degree+1) non-zero basis functions.
+ */
+template <unsigned int Degree, typename T>
+void fixedBsplineBasis(int span, const std::vector<T> &knots, T u, T *N)
+{
+    std::array<T, Degree + 1> left, right;
+    for (unsigned int j = 1; j <= Degree; j++)
+    {
+        left[j] = u - knots[span + 1 - j];
+        right[j] = knots[span + j] - u;
+    }
+
+    N[0] = 1.0;
+    for (unsigned int j = 1; j <= Degree; j++)
+    {
+        T saved = 0.0;
+        for (unsigned int r = 0; r < j; r++)
+        {
+            T temp = N[r] / (right[r + 1] + left[j - r]);
+            N[r] = saved + right[r + 1] * temp;
+            saved = left[j - r] * temp;
+        }
+        N[j] = saved;
+    }
+}
+
+/**
+ * Compute all non-zero derivatives of B-spline basis functions of a degree known
+ * at compile time, using fixed-size scratch storage
+ * @tparam Degree Degree of the basis functions.
+ * @param[in] span Index obtained from findSpan() corresponding the u and knots.
+ * @param[in] knots Knot vector corresponding to the basis functions.
+ * @param[in] u Parameter to evaluate the basis functions at.
+ * @param[in] num_ders Number of derivatives to compute (num_ders <= Degree)
+ * @param[out] ders Values of non-zero derivatives of basis functions.
+ */
+template <unsigned int Degree, typename T>
+void fixedBsplineDerBasis(int span, const std::vector<T> &knots, T u, int num_ders,
+                          array2<T> &ders)
+{
+    const int deg = static_cast<int>(Degree);
+    std::array<std::array<T, Degree + 1>, Degree + 1> ndu{};
+    std::array<std::array<T, Degree + 1>, 2> a{};
+    std::array<T, Degree + 1> left, right;
+    for (int j = 1; j <= deg; j++)
+    {
+        left[j] = u - knots[span + 1 - j];
+        right[j] = knots[span + j] - u;
+    }
+
+    ndu[0][0] = 1.0;
+    for (int j = 1; j <= deg; j++)
+    {
+        T saved = 0.0;
+        for (int r = 0; r < j; r++)
+        {
+            // Lower triangle
+            ndu[j][r] = right[r + 1] + left[j - r];
+            T temp = ndu[r][j - 1] / ndu[j][r];
+            // Upper triangle
+            ndu[r][j] = saved + right[r + 1] * temp;
+            saved = left[j - r] * temp;
+        }
+        ndu[j][j] = saved;
+    }
+
+    ders.resize(num_ders + 1, deg + 1);
+    for (int j = 0; j <= deg; j++)
+    {
+        ders(0, j) = ndu[j][deg];
+    }
+
+    for (int r = 0; r <= deg; r++)
+    {
+        int s1 = 0;
+        int s2 = 1;
+        a[0][0] = 1.0;
+
+        for (int k = 1; k <= num_ders; k++)
+        {
+            T d = 0.0;
+            int rk = r - k;
+            int pk = deg - k;
+
+            if (r >= k)
+            {
+                a[s2][0] = a[s1][0] / ndu[pk + 1][rk];
+                d = a[s2][0] * ndu[rk][pk];
+            }
+
+            int j1 = rk >= -1 ? 1 : -rk;
+            int j2 = (r - 1 <= pk) ? k - 1 : deg - r;
+
+            for (int j = j1; j <= j2; j++)
+            {
+                a[s2][j] = (a[s1][j] - a[s1][j - 1]) / ndu[pk + 1][rk + j];
+                d += a[s2][j] * ndu[rk + j][pk];
+            }
+
+            if (r <= pk)
+            {
+                a[s2][k] = -a[s1][k - 1] / ndu[pk + 1][r];
+                d += a[s2][k] * ndu[r][pk];
+            }
+
+            ders(k, r) = d;
+            std::swap(s1, s2);
+        }
+    }
+
+    T fac = static_cast<T>(deg);
+    for (int k = 1; k <= num_ders; k++)
+    {
+        for (int j = 0; j <= deg; j++)
+        {
+            ders(k, j) *= fac;
+        }
+        fac *= static_cast<T>(deg - k);
+    }
+}
+
+} // namespace internal
+
+/////////////////////////////////////////////////////////////////////
+
+/**
+ * Compute all non-zero B-spline basis functions into a caller-provided buffer.
+ * Does not allocate once N has capacity for (deg+1) values.
  * @param[in] deg Degree of the basis function.
  * @param[in] span Index obtained from findSpan() corresponding the u and knots.
  * @param[in] knots Knot vector corresponding to the basis functions.
  * @param[in] u Parameter to evaluate the basis functions at.
- * @return N Values of (deg+1) non-zero basis functions.
+ * @param[out] N Values of (deg+1) non-zero basis functions.
  */
 template <typename T>
-std::vector<T> bsplineBasis(unsigned int deg, int span, const std::vector<T> &knots, T u)
+void bsplineBasis(unsigned int deg, int span, const std::vector<T> &knots, T u, std::vector<T> &N)
 {
-    std::vector<T> N;
-    N.resize(deg + 1, T(0));
-    std::vector<T> left, right;
-    left.resize(deg + 1, static_cast<T>(0.0));
-    right.resize(deg + 1, static_cast<T>(0.0));
+    N.resize(deg + 1);
+
+    // Dispatch common degrees to the unrolled kernels
+    switch (deg)
+    {
+    case 1:
+        return internal::fixedBsplineBasis<1>(span, knots, u, N.data());
+    case 2:
+        return internal::fixedBsplineBasis<2>(span, knots, u, N.data());
+    case 3:
+        return internal::fixedBsplineBasis<3>(span, knots, u, N.data());
+    case 4:
+        return internal::fixedBsplineBasis<4>(span, knots, u, N.data());
+    case 5:
+        return internal::fixedBsplineBasis<5>(span, knots, u, N.data());
+    default:
+        break;
+    }
+
     T saved = 0.0, temp = 0.0;
 
     N[0] = 1.0;
 
     for (int j = 1; j <= deg; j++)
     {
-        left[j] = (u - knots[span + 1 - j]);
-        right[j] = knots[span + j] - u;
         saved = 0.0;
         for (int r = 0; r < j; r++)
         {
-            temp = N[r] / (right[r + 1] + left[j - r]);
-            N[r] = saved + right[r + 1] * temp;
-            saved = left[j - r] * temp;
+            // right[r + 1] and left[j - r] of the textbook algorithm
+            T right = knots[span + r + 1] - u;
+            T left = u - knots[span + 1 - j + r];
+            temp = N[r] / (right + left);
+            N[r] = saved + right * temp;
+            saved = left * temp;
         }
         N[j] = saved;
     }
+}
+
+/**
+ * Compute all non-zero B-spline basis functions
+ * @param[in] deg Degree of the basis function.
+ * @param[in] span Index obtained from findSpan() corresponding the u and knots.
+ * @param[in] knots Knot vector corresponding to the basis functions.
+ * @param[in] u Parameter to evaluate the basis functions at.
+ * @return N Values of (deg+1) non-zero basis functions.
+ */
+template <typename T>
+std::vector<T> bsplineBasis(unsigned int deg, int span, const std::vector<T> &knots, T u)
+{
+    std::vector<T> N;
+    bsplineBasis(deg, span, knots, u, N);
     return N;
 }
 
 /**
- * Compute all non-zero derivatives of B-spline basis functions
+ * Compute all non-zero B-spline basis functions for a block of parameters at
+ * once. Every step of the recurrence runs over all lanes in the innermost loop,
+ * with the knots of each lane gathered from its own span, so the compiler can
+ * map the lanes onto vector registers.
+ * @tparam Lanes Number of parameters in the block, usually simdLanes<T>().
+ * @param[in] deg Degree of the basis function.
+ * @param[in] spans Spans obtained from findSpan() for each of the parameters.
+ * @param[in] knots Knot vector corresponding to the basis functions.
+ * @param[in] u Parameters to evaluate the basis functions at.
+ * @param[out] N Values of (deg+1) non-zero basis functions per parameter, where
+ * N[j * Lanes + l] is the jth basis function of parameter u[l].
+ */
+template <unsigned int Lanes, typename T>
+void bsplineBasisLanes(unsigned int deg, const int *spans, const std::vector<T> &knots,
+                       const T *u, T *N)
+{
+    // Lane values are kept in local arrays so that stores to N cannot alias the
+    // knots, which would prevent vectorization
+    std::array<int, Lanes> s;
+    std::array<T, Lanes> x, saved, Nr;
+    for (unsigned int l = 0; l < Lanes; l++)
+    {
+        s[l] = spans[l];
+        x[l] = u[l];
+        N[l] = 1.0;
+    }
+
+    const T *U = knots.data();
+    for (int j = 1; j <= deg; j++)
+    {
+        saved.fill(0.0);
+        for (int r = 0; r < j; r++)
+        {
+            std::copy(N + r * Lanes, N + (r + 1) * Lanes, Nr.begin());
+            for (unsigned int l = 0; l < Lanes; l++)
+            {
+                T right = U[s[l] + r + 1] - x[l];
+                T left = x[l] - U[s[l] + 1 - j + r];
+                T temp = Nr[l] / (right + left);
+                Nr[l] = saved[l] + right * temp;
+                saved[l] = left * temp;
+            }
+            std::copy(Nr.begin(), Nr.end(), N + r * Lanes);
+        }
+        std::copy(saved.begin(), saved.end(), N + j * Lanes);
+    }
+}
+
+/**
+ * Compute all non-zero derivatives of B-spline basis functions into
+ * caller-provided buffers. Does not allocate once the buffers have grown to the
+ * required size.
  * @param[in] deg Degree of the basis function.
  * @param[in] span Index obtained from findSpan() corresponding the u and knots.
  * @param[in] knots Knot vector corresponding to the basis functions.
  * @param[in] u Parameter to evaluate the basis functions at.
  * @param[in] num_ders Number of derivatives to compute (num_ders <= deg)
- * @return ders Values of non-zero derivatives of basis functions.
+ * @param[out] ders Values of non-zero derivatives of basis functions.
+ * @param[inout] ndu Scratch table of basis functions and knot differences.
+ * @param[inout] a Scratch table of derivative coefficients.
  */
 template <typename T>
-array2<T> bsplineDerBasis(unsigned int deg, int span, const std::vector<T> &knots, T u,
-                          int num_ders)
+void bsplineDerBasis(unsigned int deg, int span, const std::vector<T> &knots, T u, int num_ders,
+                     array2<T> &ders, array2<T> &ndu, array2<T> &a)
 {
-    std::vector<T> left, right;
-    left.resize(deg + 1, 0.0);
-    right.resize(deg + 1, 0.0);
+    // Dispatch common degrees to the unrolled kernels
+    if (num_ders <= static_cast<int>(deg))
+    {
+        switch (deg)
+        {
+        case 1:
+            return internal::fixedBsplineDerBasis<1>(span, knots, u, num_ders, ders);
+        case 2:
+            return internal::fixedBsplineDerBasis<2>(span, knots, u, num_ders, ders);
+        case 3:
+            return internal::fixedBsplineDerBasis<3>(span, knots, u, num_ders, ders);
+        case 4:
+            return internal::fixedBsplineDerBasis<4>(span, knots, u, num_ders, ders);
+        case 5:
+            return internal::fixedBsplineDerBasis<5>(span, knots, u, num_ders, ders);
+        default:
+            break;
+        }
+    }
+
     T saved = 0.0, temp = 0.0;
 
-    array2<T> ndu(deg + 1, deg + 1);
+    ndu.resize(deg + 1, deg + 1);
     ndu(0, 0) = 1.0;
 
     for (int j = 1; j <= deg; j++)
     {
-        left[j] = u - knots[span + 1 - j];
-        right[j] = knots[span + j] - u;
         saved = 0.0;
 
         for (int r = 0; r < j; r++)
         {
+            // right[r + 1] and left[j - r] of the textbook algorithm
+            T right = knots[span + r + 1] - u;
+            T left = u - knots[span + 1 - j + r];
             // Lower triangle
-            ndu(j, r) = right[r + 1] + left[j - r];
+            ndu(j, r) = right + left;
             temp = ndu(r, j - 1) / ndu(j, r);
             // Upper triangle
-            ndu(r, j) = saved + right[r + 1] * temp;
-            saved = left[j - r] * temp;
+            ndu(r, j) = saved + right * temp;
+            saved = left * temp;
         }
 
         ndu(j, j) = saved;
     }
 
-    array2<T> ders(num_ders + 1, deg + 1, T(0));
+    ders.resize(num_ders + 1, deg + 1);
 
     for (int j = 0; j <= deg; j++)
     {
         ders(0, j) = ndu(j, deg);
     }
 
-    array2<T> a(2, deg + 1);
+    a.resize(2, deg + 1);
 
     for (int r = 0; r <= deg; r++)
     {
@@ -267,7 +548,23 @@ array2<T> bsplineDerBasis(unsigned int deg, int span, const std::vector<T> &knot
         }
         fac *= static_cast<T>(deg - k);
     }
+}
 
+/**
+ * Compute all non-zero derivatives of B-spline basis functions
+ * @param[in] deg Degree of the basis function.
+ * @param[in] span Index obtained from findSpan() corresponding the u and knots.
+ * @param[in] knots Knot vector corresponding to the basis functions.
+ * @param[in] u Parameter to evaluate the basis functions at.
+ * @param[in] num_ders Number of derivatives to compute (num_ders <= deg)
+ * @return ders Values of non-zero derivatives of basis functions.
+ */
+template <typename T>
+array2<T> bsplineDerBasis(unsigned int deg, int span, const std::vector<T> &knots, T u,
+                          int num_ders)
+{
+    array2<T> ders, ndu, a;
+    bsplineDerBasis(deg, span, knots, u, num_ders, ders, ndu, a);
     return ders;
 }
 
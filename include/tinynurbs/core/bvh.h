@@ -0,0 +1,683 @@
+/**
+ * Bounding volume hierarchies over the knot spans of curves and surfaces, for
+ * conservative culling in ray casting, projection and intersection queries.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found in
+ * the LICENSE file.
+ */
+
+#ifndef TINYNURBS_BVH_H
+#define TINYNURBS_BVH_H
+
+#include "../util/array2.h"
+#include "../util/util.h"
+#include "compiled.h"
+#include "curve.h"
+#include "glm/glm.hpp"
+#include "surface.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace tinynurbs
+{
+
+/**
+Struct for representing a box with orthonormal axes
+\tparam T Data type of the box (float or double)
+*/
+template <typename T> struct OrientedBox
+{
+    glm::vec<3, T> center;
+    glm::vec<3, T> axes[3];
+    // Half of the size of the box along each axis
+    glm::vec<3, T> half_extents;
+};
+
+/**
+Struct for representing a leaf of a BVH, which bounds a rectangle of parameters
+within one non-empty knot span along u and one along v. For curves, only the u
+components are used.
+\tparam T Data type of the bounds and parameters (float or double)
+*/
+template <typename T> struct BvhLeaf
+{
+    // Axis-aligned box of the Bezier control points of the piece
+    glm::vec<3, T> box_min, box_max;
+    // Parameter range of the piece
+    glm::vec<2, T> lo, hi;
+    // Index of the knot span along u and v
+    int span_u, span_v;
+};
+
+/**
+Struct for representing a node of a BVH. The first child of an inner node is
+stored right after it, so a depth-first traversal walks the node array forward.
+\tparam T Data type of the bounds (float or double)
+*/
+template <typename T> struct BvhNode
+{
+    glm::vec<3, T> box_min, box_max;
+    // Index of the second child of an inner node, 0 for leaves
+    unsigned int right;
+    // Index of the leaf in Bvh::leaves for leaves
+    unsigned int leaf;
+
+    bool isLeaf() const
+    {
+        return right == 0;
+    }
+};
+
+/**
+Struct for holding a bounding volume hierarchy over the pieces of a curve or
+surface. Each piece is contained in the box of its Bezier control points by the
+convex hull property, which requires positive weights. The nodes are stored in
+one flat array with the root first.
+\tparam T Data type of the bounds and parameters (float or double)
+*/
+template <typename T> struct Bvh
+{
+    std::vector<BvhNode<T>> nodes;
+    std::vector<BvhLeaf<T>> leaves;
+    // Oriented box of each leaf, empty unless requested on construction
+    std::vector<OrientedBox<T>> oriented_boxes;
+
+    bool empty() const
+    {
+        return nodes.empty();
+    }
+};
+
+namespace internal
+{
+
+template <typename T> glm::vec<3, T> bvhCartesian(const glm::vec<3, T> &pt)
+{
+    return pt;
+}
+
+template <typename T> glm::vec<3, T> bvhCartesian(const glm::vec<4, T> &pt)
+{
+    return util::homogenousToCartesian(pt);
+}
+
+/**
+ * Compute the Bezier control points of a knot span restricted to [a, b] as
+ * values of the blossom, using de Boor's algorithm with a and b as arguments
+ * @param[in] degree Degree of the curve.
+ * @param[in] knots Knot vector of the curve.
+ * @param[in] span Index of the knot span, with knots[span] <= a < b <= knots[span + 1].
+ * @param[in] cps The degree + 1 control points the span depends on, spaced by stride.
+ * @param[in] stride Distance between consecutive control points in cps.
+ * @param[in] a Start of the range.
+ * @param[in] b End of the range.
+ * @param[out] bezier The degree + 1 Bezier control points, which may be cps.
+ * @param[in] bezier_stride Distance between consecutive points in bezier.
+ * @param[in] work Buffer of 2 * (degree + 1) points.
+ */
+template <int dim, typename T>
+void bvhBlossom(unsigned int degree, const std::vector<T> &knots, int span,
+                const glm::vec<dim, T> *cps, size_t stride, T a, T b, glm::vec<dim, T> *bezier,
+                size_t bezier_stride, glm::vec<dim, T> *work)
+{
+    const int p = static_cast<int>(degree);
+    glm::vec<dim, T> *src = work + p + 1;
+    for (int i = 0; i <= p; ++i)
+    {
+        src[i] = cps[i * stride];
+    }
+    for (int j = 0; j <= p; ++j)
+    {
+        std::copy(src, src + p + 1, work);
+        // Blossom at (a, ..., a, b, ..., b) with j arguments equal to b
+        for (int r = 1; r <= p; ++r)
+        {
+            const T t = r <= p - j ? a : b;
+            for (int i = p; i >= r; --i)
+            {
+                const T k0 = knots[span - p + i], k1 = knots[span + 1 + i - r];
+                const T alpha = (t - k0) / (k1 - k0);
+                work[i] = (1 - alpha) * work[i - 1] + alpha * work[i];
+            }
+        }
+        bezier[j * bezier_stride] = work[p];
+    }
+}
+
+/**
+ * Compute the Bezier control points of a piece of a curve in cartesian coordinates
+ * @param[in] degree Degree of the curve.
+ * @param[in] knots Knot vector of the curve.
+ * @param[in] cps Control points of the curve.
+ * @param[in] leaf Piece of the curve.
+ * @param[out] hull Bezier control points of the piece.
+ * @param[in] bezier Buffer for the Bezier control points in homogenous coordinates.
+ * @param[in] work Buffer for bvhBlossom().
+ */
+template <int dim, typename T>
+void curveBvhHull(unsigned int degree, const std::vector<T> &knots,
+                  const std::vector<glm::vec<dim, T>> &cps, const BvhLeaf<T> &leaf,
+                  std::vector<glm::vec<3, T>> &hull, std::vector<glm::vec<dim, T>> &bezier,
+                  std::vector<glm::vec<dim, T>> &work)
+{
+    bezier.resize(degree + 1);
+    work.resize(2 * (degree + 1));
+    bvhBlossom(degree, knots, leaf.span_u, &cps[leaf.span_u - degree], 1, leaf.lo.x, leaf.hi.x,
+               bezier.data(), 1, work.data());
+    hull.resize(degree + 1);
+    for (unsigned int i = 0; i <= degree; ++i)
+    {
+        hull[i] = bvhCartesian(bezier[i]);
+    }
+}
+
+/**
+ * Compute the Bezier control points of a piece of a surface, stored row by row
+ * @param[in] degree_u Degree of the surface along u.
+ * @param[in] degree_v Degree of the surface along v.
+ * @param[in] knots_u Knot vector of the surface along u.
+ * @param[in] knots_v Knot vector of the surface along v.
+ * @param[in] cps Control points of the surface.
+ * @param[in] leaf Piece of the surface.
+ * @param[out] bezier The (degree_u + 1) x (degree_v + 1) Bezier control points,
+ * in homogenous coordinates if cps are.
+ * @param[in] work Buffer for bvhBlossom().
+ */
+template <int dim, typename T>
+void surfaceBvhBezier(unsigned int degree_u, unsigned int degree_v, const std::vector<T> &knots_u,
+                      const std::vector<T> &knots_v, const array2<glm::vec<dim, T>> &cps,
+                      const BvhLeaf<T> &leaf, std::vector<glm::vec<dim, T>> &bezier,
+                      std::vector<glm::vec<dim, T>> &work)
+{
+    const size_t cols = degree_v + 1;
+    bezier.resize((degree_u + 1) * cols);
+    work.resize(2 * (std::max(degree_u, degree_v) + 1));
+    const int row = leaf.span_u - static_cast<int>(degree_u);
+    const int col = leaf.span_v - static_cast<int>(degree_v);
+    // Convert along u one column at a time, then along v one row at a time
+    for (size_t j = 0; j < cols; ++j)
+    {
+        const glm::vec<dim, T> *first = cps.data() + row * cps.cols() + col + j;
+        bvhBlossom(degree_u, knots_u, leaf.span_u, first, cps.cols(), leaf.lo.x, leaf.hi.x,
+                   &bezier[j], cols, work.data());
+    }
+    for (unsigned int i = 0; i <= degree_u; ++i)
+    {
+        bvhBlossom(degree_v, knots_v, leaf.span_v, &bezier[i * cols], 1, leaf.lo.y, leaf.hi.y,
+                   &bezier[i * cols], 1, work.data());
+    }
+}
+
+/**
+ * Compute the Bezier control points of a piece of a surface in cartesian
+ * coordinates, stored row by row
+ * @param[in] degree_u Degree of the surface along u.
+ * @param[in] degree_v Degree of the surface along v.
+ * @param[in] knots_u Knot vector of the surface along u.
+ * @param[in] knots_v Knot vector of the surface along v.
+ * @param[in] cps Control points of the surface.
+ * @param[in] leaf Piece of the surface.
+ * @param[out] hull The (degree_u + 1) x (degree_v + 1) Bezier control points.
+ * @param[in] bezier Buffer for the Bezier control points in homogenous coordinates.
+ * @param[in] work Buffer for bvhBlossom().
+ */
+template <int dim, typename T>
+void surfaceBvhHull(unsigned int degree_u, unsigned int degree_v, const std::vector<T> &knots_u,
+                    const std::vector<T> &knots_v, const array2<glm::vec<dim, T>> &cps,
+                    const BvhLeaf<T> &leaf, std::vector<glm::vec<3, T>> &hull,
+                    std::vector<glm::vec<dim, T>> &bezier, std::vector<glm::vec<dim, T>> &work)
+{
+    surfaceBvhBezier(degree_u, degree_v, knots_u, knots_v, cps, leaf, bezier, work);
+    hull.resize(bezier.size());
+    for (size_t i = 0; i < bezier.size(); ++i)
+    {
+        hull[i] = bvhCartesian(bezier[i]);
+    }
+}
+
+/**
+ * Complete two directions to an orthonormal frame, falling back to the
+ * coordinate axes where they are degenerate
+ * @param[in] dir0 Direction of the first axis.
+ * @param[in] dir1 Direction the second axis is taken from.
+ * @param[out] axes Orthonormal axes.
+ */
+template <typename T>
+void orthonormalFrame(glm::vec<3, T> dir0, glm::vec<3, T> dir1, glm::vec<3, T> axes[3])
+{
+    const T tol = std::sqrt(std::numeric_limits<T>::epsilon());
+    T len = glm::length(dir0);
+    axes[0] = len > 0 ? dir0 / len : glm::vec<3, T>(1, 0, 0);
+    const T scale = glm::length(dir1);
+    dir1 -= glm::dot(dir1, axes[0]) * axes[0];
+    len = glm::length(dir1);
+    if (!(len > tol * scale))
+    {
+        // Any direction orthogonal to the first axis
+        glm::vec<3, T> a = glm::abs(axes[0]);
+        glm::vec<3, T> e(0);
+        e[a.x <= a.y && a.x <= a.z ? 0 : (a.y <= a.z ? 1 : 2)] = 1;
+        dir1 = e - glm::dot(e, axes[0]) * axes[0];
+        len = glm::length(dir1);
+    }
+    axes[1] = dir1 / len;
+    axes[2] = glm::cross(axes[0], axes[1]);
+}
+
+/**
+ * Bound points with a box of given orthonormal axes
+ * @param[in] pts Points to bound.
+ * @param[inout] box Box whose axes are set on input, and whose center and
+ * extents are set on output.
+ */
+template <typename T>
+void orientedBound(const std::vector<glm::vec<3, T>> &pts, OrientedBox<T> &box)
+{
+    glm::vec<3, T> lo(std::numeric_limits<T>::infinity());
+    glm::vec<3, T> hi(-std::numeric_limits<T>::infinity());
+    for (const glm::vec<3, T> &pt : pts)
+    {
+        glm::vec<3, T> local(glm::dot(pt, box.axes[0]), glm::dot(pt, box.axes[1]),
+                             glm::dot(pt, box.axes[2]));
+        lo = glm::min(lo, local);
+        hi = glm::max(hi, local);
+    }
+    const glm::vec<3, T> mid = (lo + hi) / T(2);
+    box.center = mid.x * box.axes[0] + mid.y * box.axes[1] + mid.z * box.axes[2];
+    box.half_extents = (hi - lo) / T(2);
+}
+
+/**
+ * Bound every leaf of a BVH with the box of its Bezier control points, and
+ * with an oriented box if the BVH holds them
+ * @param[inout] bvh BVH whose leaves have their parameter ranges set.
+ * @param[in] hull Function called as hull(leaf, pts) filling pts with the
+ * Bezier control points of the leaf.
+ * @param[in] axes Function called as axes(pts, dir0, dir1) setting the two
+ * directions the oriented box of the points is aligned with.
+ */
+template <typename T, typename Hull, typename Axes>
+void bvhBoundLeaves(Bvh<T> &bvh, Hull hull, Axes axes)
+{
+    std::vector<glm::vec<3, T>> pts;
+    for (size_t k = 0; k < bvh.leaves.size(); ++k)
+    {
+        BvhLeaf<T> &leaf = bvh.leaves[k];
+        hull(leaf, pts);
+        leaf.box_min = leaf.box_max = pts[0];
+        for (const glm::vec<3, T> &pt : pts)
+        {
+            leaf.box_min = glm::min(leaf.box_min, pt);
+            leaf.box_max = glm::max(leaf.box_max, pt);
+        }
+        if (!bvh.oriented_boxes.empty())
+        {
+            glm::vec<3, T> dir0, dir1;
+            axes(pts, dir0, dir1);
+            OrientedBox<T> &box = bvh.oriented_boxes[k];
+            orthonormalFrame(dir0, dir1, box.axes);
+            orientedBound(pts, box);
+        }
+    }
+}
+
+/**
+ * Add the nodes of a subtree over a range of leaves, splitting at the median
+ * of the box centers along the axis they spread most along
+ * @param[inout] bvh BVH whose leaves are bounded.
+ * @param[inout] order Leaf indices, reordered within [first, last).
+ * @param[in] centers Center of the box of each leaf.
+ * @param[in] first Start of the range of leaves in order.
+ * @param[in] last End of the range of leaves in order.
+ */
+template <typename T>
+void bvhBuildNodes(Bvh<T> &bvh, std::vector<unsigned int> &order,
+                   const std::vector<glm::vec<3, T>> &centers, size_t first, size_t last)
+{
+    const size_t index = bvh.nodes.size();
+    bvh.nodes.push_back(BvhNode<T>());
+    if (last - first == 1)
+    {
+        const BvhLeaf<T> &leaf = bvh.leaves[order[first]];
+        BvhNode<T> &node = bvh.nodes[index];
+        node.box_min = leaf.box_min;
+        node.box_max = leaf.box_max;
+        node.right = 0;
+        node.leaf = order[first];
+        return;
+    }
+
+    glm::vec<3, T> lo = centers[order[first]], hi = lo;
+    for (size_t k = first + 1; k < last; ++k)
+    {
+        lo = glm::min(lo, centers[order[k]]);
+        hi = glm::max(hi, centers[order[k]]);
+    }
+    const glm::vec<3, T> extent = hi - lo;
+    const int axis =
+        extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+    // Ties keep the parametric order of the leaves, so flat pieces stay adjacent
+    const size_t mid = (first + last) / 2;
+    std::nth_element(order.begin() + first, order.begin() + mid, order.begin() + last,
+                     [&](unsigned int a, unsigned int b) {
+                         return centers[a][axis] < centers[b][axis] ||
+                                (centers[a][axis] == centers[b][axis] && a < b);
+                     });
+
+    bvhBuildNodes(bvh, order, centers, first, mid);
+    const unsigned int right = static_cast<unsigned int>(bvh.nodes.size());
+    bvhBuildNodes(bvh, order, centers, mid, last);
+    BvhNode<T> &node = bvh.nodes[index];
+    node.box_min = glm::min(bvh.nodes[index + 1].box_min, bvh.nodes[right].box_min);
+    node.box_max = glm::max(bvh.nodes[index + 1].box_max, bvh.nodes[right].box_max);
+    node.right = right;
+    node.leaf = 0;
+}
+
+/**
+ * Build the nodes of a BVH over its bounded leaves, in O(n log n) for n leaves
+ * @param[inout] bvh BVH whose leaves are bounded.
+ */
+template <typename T> void bvhBuildNodes(Bvh<T> &bvh)
+{
+    bvh.nodes.clear();
+    if (bvh.leaves.empty())
+    {
+        return;
+    }
+    bvh.nodes.reserve(2 * bvh.leaves.size() - 1);
+    std::vector<unsigned int> order(bvh.leaves.size());
+    std::vector<glm::vec<3, T>> centers(bvh.leaves.size());
+    for (size_t k = 0; k < bvh.leaves.size(); ++k)
+    {
+        order[k] = static_cast<unsigned int>(k);
+        centers[k] = (bvh.leaves[k].box_min + bvh.leaves[k].box_max) / T(2);
+    }
+    bvhBuildNodes(bvh, order, centers, 0, order.size());
+}
+
+/**
+ * Update the boxes of the nodes of a BVH from the boxes of its leaves, in a
+ * single backward pass since children follow their parents
+ * @param[inout] bvh BVH whose leaves are bounded.
+ */
+template <typename T> void bvhRefitNodes(Bvh<T> &bvh)
+{
+    for (size_t k = bvh.nodes.size(); k-- > 0;)
+    {
+        BvhNode<T> &node = bvh.nodes[k];
+        if (node.isLeaf())
+        {
+            node.box_min = bvh.leaves[node.leaf].box_min;
+            node.box_max = bvh.leaves[node.leaf].box_max;
+        }
+        else
+        {
+            node.box_min = glm::min(bvh.nodes[k + 1].box_min, bvh.nodes[node.right].box_min);
+            node.box_max = glm::max(bvh.nodes[k + 1].box_max, bvh.nodes[node.right].box_max);
+        }
+    }
+}
+
+/**
+ * Split the non-empty spans of a knot vector into equal pieces
+ * @param[in] degree Degree of the basis functions.
+ * @param[in] knots Knot vector.
+ * @param[in] subdivisions Number of pieces per span.
+ * @param[out] ranges Start and end of each piece.
+ * @param[out] spans Span index of each piece.
+ */
+template <typename T>
+void bvhPieces(unsigned int degree, const std::vector<T> &knots, unsigned int subdivisions,
+               std::vector<glm::vec<2, T>> &ranges, std::vector<int> &spans)
+{
+    std::vector<T> breaks;
+    std::vector<int> span_indices;
+    compiledBreaks(degree, knots, breaks, span_indices);
+    subdivisions = std::max(subdivisions, 1u);
+    ranges.clear();
+    spans.clear();
+    for (size_t s = 0; s < span_indices.size(); ++s)
+    {
+        const T a = breaks[s], b = breaks[s + 1];
+        for (unsigned int k = 0; k < subdivisions; ++k)
+        {
+            ranges.push_back(glm::vec<2, T>(k == 0 ? a : a + (b - a) * k / subdivisions,
+                                            k + 1 == subdivisions
+                                                ? b
+                                                : a + (b - a) * (k + 1) / subdivisions));
+            spans.push_back(span_indices[s]);
+        }
+    }
+}
+
+template <int dim, typename T>
+void curveBvhRefit(unsigned int degree, const std::vector<T> &knots,
+                   const std::vector<glm::vec<dim, T>> &cps, Bvh<T> &bvh)
+{
+    std::vector<glm::vec<dim, T>> bezier, work;
+    bvhBoundLeaves(
+        bvh,
+        [&](const BvhLeaf<T> &leaf, std::vector<glm::vec<3, T>> &pts) {
+            curveBvhHull(degree, knots, cps, leaf, pts, bezier, work);
+        },
+        [](const std::vector<glm::vec<3, T>> &pts, glm::vec<3, T> &dir0, glm::vec<3, T> &dir1) {
+            // Along the chord, then towards the control point farthest from it
+            dir0 = pts.back() - pts.front();
+            dir1 = glm::vec<3, T>(0);
+            T far = 0;
+            for (const glm::vec<3, T> &pt : pts)
+            {
+                glm::vec<3, T> off = glm::cross(dir0, pt - pts.front());
+                if (glm::dot(off, off) > far)
+                {
+                    far = glm::dot(off, off);
+                    dir1 = pt - pts.front();
+                }
+            }
+        });
+    bvhRefitNodes(bvh);
+}
+
+template <int dim, typename T>
+void curveBvh(unsigned int degree, const std::vector<T> &knots,
+              const std::vector<glm::vec<dim, T>> &cps, unsigned int subdivisions, bool oriented,
+              Bvh<T> &bvh)
+{
+    std::vector<glm::vec<2, T>> ranges;
+    std::vector<int> spans;
+    bvhPieces(degree, knots, subdivisions, ranges, spans);
+    bvh.leaves.resize(ranges.size());
+    for (size_t k = 0; k < ranges.size(); ++k)
+    {
+        BvhLeaf<T> &leaf = bvh.leaves[k];
+        leaf.lo = glm::vec<2, T>(ranges[k].x, 0);
+        leaf.hi = glm::vec<2, T>(ranges[k].y, 0);
+        leaf.span_u = spans[k];
+        leaf.span_v = 0;
+    }
+    bvh.oriented_boxes.assign(oriented ? ranges.size() : 0, OrientedBox<T>());
+    curveBvhRefit(degree, knots, cps, bvh);
+    bvhBuildNodes(bvh);
+}
+
+template <int dim, typename T>
+void surfaceBvhRefit(unsigned int degree_u, unsigned int degree_v, const std::vector<T> &knots_u,
+                     const std::vector<T> &knots_v, const array2<glm::vec<dim, T>> &cps,
+                     Bvh<T> &bvh)
+{
+    std::vector<glm::vec<dim, T>> bezier, work;
+    const size_t cols = degree_v + 1;
+    bvhBoundLeaves(
+        bvh,
+        [&](const BvhLeaf<T> &leaf, std::vector<glm::vec<3, T>> &pts) {
+            surfaceBvhHull(degree_u, degree_v, knots_u, knots_v, cps, leaf, pts, bezier, work);
+        },
+        [&](const std::vector<glm::vec<3, T>> &pts, glm::vec<3, T> &dir0, glm::vec<3, T> &dir1) {
+            // Along the average of the opposite boundary chords in u and in v
+            const glm::vec<3, T> &p00 = pts[0], &p01 = pts[cols - 1];
+            const glm::vec<3, T> &p10 = pts[pts.size() - cols], &p11 = pts.back();
+            dir0 = (p10 - p00) + (p11 - p01);
+            dir1 = (p01 - p00) + (p11 - p10);
+        });
+    bvhRefitNodes(bvh);
+}
+
+template <int dim, typename T>
+void surfaceBvh(unsigned int degree_u, unsigned int degree_v, const std::vector<T> &knots_u,
+                const std::vector<T> &knots_v, const array2<glm::vec<dim, T>> &cps,
+                unsigned int subdivisions, bool oriented, Bvh<T> &bvh)
+{
+    std::vector<glm::vec<2, T>> ranges_u, ranges_v;
+    std::vector<int> spans_u, spans_v;
+    bvhPieces(degree_u, knots_u, subdivisions, ranges_u, spans_u);
+    bvhPieces(degree_v, knots_v, subdivisions, ranges_v, spans_v);
+    bvh.leaves.resize(ranges_u.size() * ranges_v.size());
+    for (size_t i = 0; i < ranges_u.size(); ++i)
+    {
+        for (size_t j = 0; j < ranges_v.size(); ++j)
+        {
+            BvhLeaf<T> &leaf = bvh.leaves[i * ranges_v.size() + j];
+            leaf.lo = glm::vec<2, T>(ranges_u[i].x, ranges_v[j].x);
+            leaf.hi = glm::vec<2, T>(ranges_u[i].y, ranges_v[j].y);
+            leaf.span_u = spans_u[i];
+            leaf.span_v = spans_v[j];
+        }
+    }
+    bvh.oriented_boxes.assign(oriented ? bvh.leaves.size() : 0, OrientedBox<T>());
+    surfaceBvhRefit(degree_u, degree_v, knots_u, knots_v, cps, bvh);
+    bvhBuildNodes(bvh);
+}
+
+} // namespace internal
+
+/////////////////////////////////////////////////////////////////////
+
+/**
+ * Build a bounding volume hierarchy over the knot spans of a curve
+ * @param[in] crv Curve object
+ * @param[in] subdivisions Number of leaves each non-empty span is split into.
+ * @param[in] oriented Whether to also bound each leaf with an oriented box.
+ * @return BVH of the curve
+ */
+template <typename T>
+Bvh<T> curveBvh(const Curve<T> &crv, unsigned int subdivisions = 1, bool oriented = false)
+{
+    Bvh<T> bvh;
+    internal::curveBvh(crv.degree, crv.knots, crv.control_points, subdivisions, oriented, bvh);
+    return bvh;
+}
+
+/**
+ * Build a bounding volume hierarchy over the knot spans of a rational curve
+ * @param[in] crv RationalCurve object
+ * @param[in] subdivisions Number of leaves each non-empty span is split into.
+ * @param[in] oriented Whether to also bound each leaf with an oriented box.
+ * @return BVH of the curve
+ */
+template <typename T>
+Bvh<T> curveBvh(const RationalCurve<T> &crv, unsigned int subdivisions = 1,
+                bool oriented = false)
+{
+    Bvh<T> bvh;
+    internal::curveBvh(crv.degree, crv.knots,
+                       util::cartesianToHomogenous(crv.control_points, crv.weights),
+                       subdivisions, oriented, bvh);
+    return bvh;
+}
+
+/**
+ * Update the boxes of a curve BVH after its control points moved, in linear
+ * time. The degree and knots must be those the BVH was built with.
+ * @param[in] crv Curve object
+ * @param[inout] bvh BVH built from the curve.
+ */
+template <typename T> void curveBvhRefit(const Curve<T> &crv, Bvh<T> &bvh)
+{
+    internal::curveBvhRefit(crv.degree, crv.knots, crv.control_points, bvh);
+}
+
+/**
+ * Update the boxes of a rational curve BVH after its control points or
+ * weights changed, in linear time. The degree and knots must be those the BVH
+ * was built with.
+ * @param[in] crv RationalCurve object
+ * @param[inout] bvh BVH built from the curve.
+ */
+template <typename T> void curveBvhRefit(const RationalCurve<T> &crv, Bvh<T> &bvh)
+{
+    internal::curveBvhRefit(crv.degree, crv.knots,
+                            util::cartesianToHomogenous(crv.control_points, crv.weights), bvh);
+}
+
+/**
+ * Build a bounding volume hierarchy over the knot spans of a surface
+ * @param[in] srf Surface object
+ * @param[in] subdivisions Number of leaves each non-empty span is split into
+ * along u and along v.
+ * @param[in] oriented Whether to also bound each leaf with an oriented box.
+ * @return BVH of the surface
+ */
+template <typename T>
+Bvh<T> surfaceBvh(const Surface<T> &srf, unsigned int subdivisions = 1, bool oriented = false)
+{
+    Bvh<T> bvh;
+    internal::surfaceBvh(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                         srf.control_points, subdivisions, oriented, bvh);
+    return bvh;
+}
+
+/**
+ * Build a bounding volume hierarchy over the knot spans of a rational surface
+ * @param[in] srf RationalSurface object
+ * @param[in] subdivisions Number of leaves each non-empty span is split into
+ * along u and along v.
+ * @param[in] oriented Whether to also bound each leaf with an oriented box.
+ * @return BVH of the surface
+ */
+template <typename T>
+Bvh<T> surfaceBvh(const RationalSurface<T> &srf, unsigned int subdivisions = 1,
+                  bool oriented = false)
+{
+    Bvh<T> bvh;
+    internal::surfaceBvh(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                         util::cartesianToHomogenous(srf.control_points, srf.weights),
+                         subdivisions, oriented, bvh);
+    return bvh;
+}
+
+/**
+ * Update the boxes of a surface BVH after its control points moved, in linear
+ * time. The degrees and knots must be those the BVH was built with.
+ * @param[in] srf Surface object
+ * @param[inout] bvh BVH built from the surface.
+ */
+template <typename T> void surfaceBvhRefit(const Surface<T> &srf, Bvh<T> &bvh)
+{
+    internal::surfaceBvhRefit(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                              srf.control_points, bvh);
+}
+
+/**
+ * Update the boxes of a rational surface BVH after its control points or
+ * weights changed, in linear time. The degrees and knots must be those the BVH
+ * was built with.
+ * @param[in] srf RationalSurface object
+ * @param[inout] bvh BVH built from the surface.
+ */
+template <typename T> void surfaceBvhRefit(const RationalSurface<T> &srf, Bvh<T> &bvh)
+{
+    internal::surfaceBvhRefit(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                              util::cartesianToHomogenous(srf.control_points, srf.weights),
+                              bvh);
+}
+
+// Typedefs for ease of use
+typedef Bvh<float> Bvh3f;
+typedef Bvh<double> Bvh3d;
+
+} // namespace tinynurbs
+
+#endif // TINYNURBS_BVH_H
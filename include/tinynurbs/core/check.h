@@ -11,6 +11,7 @@
 
 #include "curve.h"
 #include "glm/glm.hpp"
+#include "knots.h"
 #include "surface.h"
 #include <algorithm>
 #include <limits>
@@ -48,6 +49,17 @@ template <typename T> bool isKnotVectorMonotonic(const std::vector<T> &knots)
     return std::is_sorted(knots.begin(), knots.end());
 }
 
+/**
+ * isKnotVectorMonotonic returns whether the knots are in ascending order
+ * @tparam Type of knot values
+ * @param[in] knots Knot vector with cached properties
+ * @return Whether monotonic
+ */
+template <typename T> bool isKnotVectorMonotonic(const KnotVector<T> &knots)
+{
+    return knots.monotonic;
+}
+
 /**
  * Returns whether the curve is valid
  * @tparam T Type of control point coordinates, knot values
@@ -176,6 +188,18 @@ template <typename T> bool isKnotVectorClosed(unsigned int degree, const std::ve
     return true;
 }
 
+/**
+ * Returns whether the given knot vector is closed by checking the
+ * periodicity of knot vectors near the start and end
+ * @param[in] degree Degree of curve/surface
+ * @param[in] knots Knot vector with cached properties
+ * @return Whether knot vector is closed
+ */
+template <typename T> bool isKnotVectorClosed(unsigned int degree, const KnotVector<T> &knots)
+{
+    return (degree == knots.degree) ? knots.closed : isKnotVectorClosed(degree, knots.knots);
+}
+
 /**
  * Returns whether the given knot vector is closed by checking the
  * periodicity of knot vectors near the start and end
@@ -267,6 +291,30 @@ template <typename T> unsigned int knotMultiplicity(const std::vector<T> &knots,
     return mult;
 }
 
+/**
+ * Returns the multiplicity of the knot, by binary search over the breakpoints
+ * of the cached knot vector
+ * @tparam Type of knot values
+ * @param[in] knots Knot vector with cached properties
+ * @param[in] knot_val Knot of interest
+ * @return Multiplicity (>= 0)
+ */
+template <typename T> unsigned int knotMultiplicity(const KnotVector<T> &knots, T knot_val)
+{
+    T eps = std::numeric_limits<T>::epsilon();
+    const std::vector<T> &bps = knots.breakpoints;
+    unsigned int mult = 0;
+    for (auto it = std::lower_bound(bps.begin(), bps.end(), knot_val - eps);
+         it != bps.end() && *it <= knot_val + eps; ++it)
+    {
+        if (std::abs(knot_val - *it) < eps)
+        {
+            mult += knots.multiplicities[it - bps.begin()];
+        }
+    }
+    return mult;
+}
+
 /**
  * Returns the mulitplicity of the knot at index
  * @tparam Type of knot values
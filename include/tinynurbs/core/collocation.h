@@ -0,0 +1,249 @@
+/**
+ * Sparse collocation matrices mapping the control points of curves and surfaces
+ * to points and derivatives at fixed parameters.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found in
+ * the LICENSE file.
+ */
+
+#ifndef TINYNURBS_COLLOCATION_H
+#define TINYNURBS_COLLOCATION_H
+
+#include "../util/array2.h"
+#include "basis.h"
+#include "glm/glm.hpp"
+#include "workspace.h"
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace tinynurbs
+{
+
+/**
+Struct for representing a sparse matrix in compressed sparse row format. The
+non-zero entries of row r are values[k] at column col_index[k] for
+row_ptr[r] <= k < row_ptr[r + 1].
+\tparam T Data type of the entries (float or double)
+*/
+template <typename T> struct CsrMatrix
+{
+    size_t rows = 0, cols = 0;
+    std::vector<size_t> row_ptr;
+    std::vector<unsigned int> col_index;
+    std::vector<T> values;
+
+    /**
+     * Number of stored entries
+     */
+    size_t nonZeros() const
+    {
+        return values.size();
+    }
+};
+
+namespace internal
+{
+
+/**
+ * Build the collocation matrix of a curve
+ * @param[in] degree Degree of the curve.
+ * @param[in] knots Knot vector of the curve.
+ * @param[in] params Parameters to sample the curve at.
+ * @param[in] num_ders Number of derivatives to sample.
+ * @param[out] mat Matrix with one row per parameter and derivative, and one
+ * column per control point.
+ */
+template <typename T>
+void curveCollocationMatrix(unsigned int degree, const std::vector<T> &knots,
+                            const std::vector<T> &params, int num_ders, CsrMatrix<T> &mat)
+{
+    const size_t num_rows = params.size() * (num_ders + 1);
+    const int du = std::min(num_ders, static_cast<int>(degree));
+    mat.rows = num_rows;
+    mat.cols = knots.size() - degree - 1;
+    mat.row_ptr.clear();
+    mat.row_ptr.reserve(num_rows + 1);
+    mat.col_index.clear();
+    mat.col_index.reserve(params.size() * (du + 1) * (degree + 1));
+    mat.values.clear();
+    mat.values.reserve(params.size() * (du + 1) * (degree + 1));
+
+    EvalWorkspace<T> ws;
+    mat.row_ptr.push_back(0);
+    for (T u : params)
+    {
+        int span = ws.findSpanU(degree, knots, u);
+        bsplineDerBasis(degree, span, knots, u, du, ws.ders_u, ws.ndu, ws.a);
+        for (int k = 0; k <= num_ders; ++k)
+        {
+            // Derivatives above the degree are zero and their rows stay empty
+            for (unsigned int j = 0; k <= du && j <= degree; ++j)
+            {
+                mat.col_index.push_back(span - degree + j);
+                mat.values.push_back(ws.ders_u(k, j));
+            }
+            mat.row_ptr.push_back(mat.values.size());
+        }
+    }
+}
+
+/**
+ * Build the collocation matrix of a surface
+ * @param[in] degree_u Degree of the surface along u.
+ * @param[in] degree_v Degree of the surface along v.
+ * @param[in] knots_u Knot vector of the surface along u.
+ * @param[in] knots_v Knot vector of the surface along v.
+ * @param[in] us Parameters along u of the samples.
+ * @param[in] vs Parameters along v of the samples, of the same length as us.
+ * @param[in] num_ders Number of derivatives to sample.
+ * @param[out] mat Matrix with (num_ders + 1)^2 rows per sample and one column
+ * per control point.
+ */
+template <typename T>
+void surfaceCollocationMatrix(unsigned int degree_u, unsigned int degree_v,
+                              const std::vector<T> &knots_u, const std::vector<T> &knots_v,
+                              const std::vector<T> &us, const std::vector<T> &vs, int num_ders,
+                              CsrMatrix<T> &mat)
+{
+    assert(us.size() == vs.size());
+    const size_t num_cols_v = knots_v.size() - degree_v - 1;
+    const size_t num_rows = us.size() * (num_ders + 1) * (num_ders + 1);
+    const int du = std::min(num_ders, static_cast<int>(degree_u));
+    const int dv = std::min(num_ders, static_cast<int>(degree_v));
+    mat.rows = num_rows;
+    mat.cols = (knots_u.size() - degree_u - 1) * num_cols_v;
+    mat.row_ptr.clear();
+    mat.row_ptr.reserve(num_rows + 1);
+    mat.col_index.clear();
+    mat.values.clear();
+
+    EvalWorkspace<T> ws;
+    mat.row_ptr.push_back(0);
+    for (size_t s = 0; s < us.size(); ++s)
+    {
+        int span_u = ws.findSpanU(degree_u, knots_u, us[s]);
+        int span_v = ws.findSpanV(degree_v, knots_v, vs[s]);
+        bsplineDerBasis(degree_u, span_u, knots_u, us[s], du, ws.ders_u, ws.ndu, ws.a);
+        bsplineDerBasis(degree_v, span_v, knots_v, vs[s], dv, ws.ders_v, ws.ndu, ws.a);
+        for (int k = 0; k <= num_ders; ++k)
+        {
+            for (int l = 0; l <= num_ders; ++l)
+            {
+                // Rows of derivatives with k + l > num_ders, or that are zero
+                // because they exceed the degree, stay empty
+                if (k <= du && l <= dv && k + l <= num_ders)
+                {
+                    for (unsigned int a = 0; a <= degree_u; ++a)
+                    {
+                        size_t row = (span_u - degree_u + a) * num_cols_v;
+                        for (unsigned int b = 0; b <= degree_v; ++b)
+                        {
+                            mat.col_index.push_back(row + span_v - degree_v + b);
+                            mat.values.push_back(ws.ders_u(k, a) * ws.ders_v(l, b));
+                        }
+                    }
+                }
+                mat.row_ptr.push_back(mat.values.size());
+            }
+        }
+    }
+}
+
+/**
+ * Multiply a sparse matrix with a vector
+ * @param[in] mat Sparse matrix.
+ * @param[in] x Vector of mat.cols entries.
+ * @param[out] y Vector of mat.rows entries, y = mat * x.
+ */
+template <typename T, typename V> void csrMultiply(const CsrMatrix<T> &mat, const V *x, V *y)
+{
+    const size_t *row_ptr = mat.row_ptr.data();
+    const unsigned int *col_index = mat.col_index.data();
+    const T *values = mat.values.data();
+    for (size_t r = 0; r < mat.rows; ++r)
+    {
+        V sum(0);
+        for (size_t k = row_ptr[r]; k < row_ptr[r + 1]; ++k)
+        {
+            sum += values[k] * x[col_index[k]];
+        }
+        y[r] = sum;
+    }
+}
+
+} // namespace internal
+
+/////////////////////////////////////////////////////////////////////
+
+/**
+ * Build the matrix mapping the control points of a curve to its points and
+ * derivatives at fixed parameters. The matrix only depends on the degree and
+ * knots; applied to the homogenous control points of a rational curve, it gives
+ * the samples in homogenous coordinates.
+ * @param[in] crv Curve, RationalCurve, HomogenousCurve or CurveFamily object
+ * @param[in] params Parameters to sample the curve at.
+ * @param[out] mat Matrix whose row i * (num_ders + 1) + k gives the kth
+ * derivative at params[i] when multiplied with the control points.
+ * @param[in] num_ders Number of derivatives to sample.
+ */
+template <typename CurveType, typename T>
+void curveCollocationMatrix(const CurveType &crv, const std::vector<T> &params,
+                            CsrMatrix<T> &mat, int num_ders = 0)
+{
+    internal::curveCollocationMatrix(crv.degree, crv.knots, params, num_ders, mat);
+}
+
+/**
+ * Build the matrix mapping the control points of a surface to its points and
+ * derivatives at fixed pairs of parameters. The control point (i, j) is column
+ * i * control_points.cols() + j, matching the storage order of array2.
+ * @param[in] srf Surface, RationalSurface or HomogenousSurface object
+ * @param[in] us Parameters along u of the samples.
+ * @param[in] vs Parameters along v of the samples, of the same length as us.
+ * @param[out] mat Matrix whose row (i * (num_ders + 1) + k) * (num_ders + 1) + l
+ * gives the derivative of order k along u and l along v at (us[i], vs[i]) when
+ * multiplied with the control points. Rows with k + l > num_ders are empty.
+ * @param[in] num_ders Number of derivatives to sample.
+ */
+template <typename SurfaceType, typename T>
+void surfaceCollocationMatrix(const SurfaceType &srf, const std::vector<T> &us,
+                              const std::vector<T> &vs, CsrMatrix<T> &mat, int num_ders = 0)
+{
+    internal::surfaceCollocationMatrix(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v, us,
+                                       vs, num_ders, mat);
+}
+
+/**
+ * Apply a collocation matrix to the control points of a curve
+ * @param[in] mat Collocation matrix of the curve.
+ * @param[in] control_points Control points of the curve.
+ * @param[out] samples Points and derivatives in the order of the rows of mat.
+ */
+template <typename T, typename V>
+void csrMultiply(const CsrMatrix<T> &mat, const std::vector<V> &control_points,
+                 std::vector<V> &samples)
+{
+    assert(control_points.size() == mat.cols);
+    samples.resize(mat.rows);
+    internal::csrMultiply(mat, control_points.data(), samples.data());
+}
+
+/**
+ * Apply a collocation matrix to the control points of a surface
+ * @param[in] mat Collocation matrix of the surface.
+ * @param[in] control_points Control points of the surface.
+ * @param[out] samples Points and derivatives in the order of the rows of mat.
+ */
+template <typename T, typename V>
+void csrMultiply(const CsrMatrix<T> &mat, const array2<V> &control_points,
+                 std::vector<V> &samples)
+{
+    assert(control_points.size() == mat.cols);
+    samples.resize(mat.rows);
+    internal::csrMultiply(mat, control_points.data(), samples.data());
+}
+
+} // namespace tinynurbs
+
+#endif // TINYNURBS_COLLOCATION_H
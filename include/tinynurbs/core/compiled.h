@@ -0,0 +1,603 @@
+/**
+ * Curves and surfaces converted to piecewise polynomials in power basis, for
+ * fast repeated evaluation with Horner's scheme.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found in
+ * the LICENSE file.
+ */
+
+#ifndef TINYNURBS_COMPILED_H
+#define TINYNURBS_COMPILED_H
+
+#include "../util/array2.h"
+#include "../util/util.h"
+#include "basis.h"
+#include "curve.h"
+#include "evaluate.h"
+#include "glm/glm.hpp"
+#include "surface.h"
+#include "workspace.h"
+#include <algorithm>
+#include <vector>
+
+namespace tinynurbs
+{
+
+namespace internal
+{
+
+/**
+ * Find the non-empty spans of a knot vector
+ * @param[in] degree Degree of the basis functions.
+ * @param[in] knots Knot vector.
+ * @param[out] breaks Start of each non-empty span, followed by the end of the domain.
+ * @param[out] spans Index of each non-empty span.
+ */
+template <typename T>
+void compiledBreaks(unsigned int degree, const std::vector<T> &knots, std::vector<T> &breaks,
+                    std::vector<int> &spans)
+{
+    breaks.clear();
+    spans.clear();
+    int n = static_cast<int>(knots.size()) - degree - 2;
+    for (int span = degree; span <= n; ++span)
+    {
+        if (knots[span] < knots[span + 1])
+        {
+            breaks.push_back(knots[span]);
+            spans.push_back(span);
+        }
+    }
+    breaks.push_back(knots[n + 1]);
+}
+
+/**
+ * Find the segment containing a parameter. Parameters outside the domain map to
+ * the first or the last segment.
+ * @param[in] breaks Segment boundaries.
+ * @param[in] u Parameter to look up.
+ * @return Index of the segment.
+ */
+template <typename T> size_t compiledSegment(const std::vector<T> &breaks, T u)
+{
+    auto it = std::upper_bound(breaks.begin() + 1, breaks.end() - 1, u);
+    return static_cast<size_t>(it - (breaks.begin() + 1));
+}
+
+/**
+ * Evaluate the kth derivative of a polynomial in power basis with Horner's scheme
+ * @param[in] c Coefficients of the polynomial, from the constant term up.
+ * @param[in] degree Degree of the polynomial.
+ * @param[in] k Order of the derivative.
+ * @param[in] t Parameter to evaluate at.
+ * @return Value of the kth derivative at t.
+ */
+template <typename V, typename T>
+V hornerDerivative(const V *c, unsigned int degree, unsigned int k, T t)
+{
+    V d = V(0);
+    for (int i = degree; i >= static_cast<int>(k); --i)
+    {
+        // i! / (i - k)!
+        T f = 1;
+        for (unsigned int m = 0; m < k; ++m)
+        {
+            f *= static_cast<T>(i - m);
+        }
+        d = d * t + f * c[i];
+    }
+    return d;
+}
+
+/**
+ * Evaluate the (k, l)th partial derivative of a polynomial patch
+ * @param[in] c Coefficients of the patch, where c[i * (degree_v + 1) + j]
+ * belongs to s^i t^j.
+ * @param[in] degree_u Degree of the patch in s.
+ * @param[in] degree_v Degree of the patch in t.
+ * @param[in] k Order of the derivative in s.
+ * @param[in] l Order of the derivative in t.
+ * @param[in] s Parameter along u relative to the patch corner.
+ * @param[in] t Parameter along v relative to the patch corner.
+ * @return Value of the derivative at (s, t).
+ */
+template <typename V, typename T>
+V hornerDerivative(const V *c, unsigned int degree_u, unsigned int degree_v, unsigned int k,
+                   unsigned int l, T s, T t)
+{
+    V d = V(0);
+    for (int i = degree_u; i >= static_cast<int>(k); --i)
+    {
+        T f = 1;
+        for (unsigned int m = 0; m < k; ++m)
+        {
+            f *= static_cast<T>(i - m);
+        }
+        d = d * s + f * hornerDerivative(c + i * (degree_v + 1), degree_v, l, t);
+    }
+    return d;
+}
+
+} // namespace internal
+
+/////////////////////////////////////////////////////////////////////
+
+/**
+Struct for representing a NURBS curve as one polynomial per non-empty knot
+span. The polynomial of segment s is sum_i coeffs[s * (degree + 1) + i] * t^i,
+where t = u - breaks[s]. Rational curves are stored in homogenous coordinates,
+with the weight polynomial in wcoeffs.
+\tparam T Data type of control points and knots (float or double)
+*/
+template <typename T> struct CompiledCurve
+{
+    unsigned int degree;
+    // Start of each segment, followed by the end of the last segment
+    std::vector<T> breaks;
+    // Power basis coefficients of each segment, weighted for rational curves
+    std::vector<glm::vec<3, T>> coeffs;
+    // Power basis coefficients of the weight function, empty for non-rational curves
+    std::vector<T> wcoeffs;
+
+    CompiledCurve() = default;
+    CompiledCurve(const Curve<T> &crv)
+    {
+        compile(crv.degree, crv.knots, HomogenousCurve<T>(crv).control_points, false);
+    }
+    CompiledCurve(const RationalCurve<T> &crv)
+    {
+        compile(crv.degree, crv.knots, HomogenousCurve<T>(crv).control_points, true);
+    }
+
+    /**
+     * Compute the coefficients of each segment from the derivatives of the
+     * curve at the start of the segment
+     * @param[in] degree Degree of the curve.
+     * @param[in] knots Knot vector of the curve.
+     * @param[in] control_points Control points in homogenous coordinates.
+     * @param[in] rational Whether to keep the weight polynomials.
+     */
+    void compile(unsigned int degree, const std::vector<T> &knots,
+                 const std::vector<glm::vec<4, T>> &control_points, bool rational)
+    {
+        this->degree = degree;
+        coeffs.clear();
+        wcoeffs.clear();
+
+        std::vector<int> spans;
+        internal::compiledBreaks(degree, knots, breaks, spans);
+
+        EvalWorkspace<T> ws;
+        for (int span : spans)
+        {
+            T a = knots[span];
+            bsplineDerBasis(degree, span, knots, a, degree, ws.ders_u, ws.ndu, ws.a);
+
+            // Taylor coefficients C^(i)(a) / i!
+            T fact = 1;
+            for (int i = 0; i <= degree; ++i)
+            {
+                fact *= (i > 0) ? i : 1;
+                glm::vec<4, T> c(0.0);
+                for (int j = 0; j <= degree; ++j)
+                {
+                    c += ws.ders_u(i, j) * control_points[span - degree + j];
+                }
+                c /= fact;
+                coeffs.push_back(glm::vec<3, T>(c));
+                if (rational)
+                {
+                    wcoeffs.push_back(c[3]);
+                }
+            }
+        }
+    }
+};
+
+/**
+Struct for representing a NURBS surface as one polynomial patch per pair of
+non-empty knot spans. The coefficient of s^i t^j of patch (a, b) is at index
+((a * (breaks_v.size() - 1) + b) * (degree_u + 1) + i) * (degree_v + 1) + j,
+where s = u - breaks_u[a] and t = v - breaks_v[b]. Rational surfaces are stored
+in homogenous coordinates, with the weight polynomials in wcoeffs.
+\tparam T Data type of control points and knots (float or double)
+*/
+template <typename T> struct CompiledSurface
+{
+    unsigned int degree_u, degree_v;
+    // Start of each segment along u and v, followed by the end of the last segment
+    std::vector<T> breaks_u, breaks_v;
+    // Power basis coefficients of each patch, weighted for rational surfaces
+    std::vector<glm::vec<3, T>> coeffs;
+    // Power basis coefficients of the weight function, empty for non-rational surfaces
+    std::vector<T> wcoeffs;
+
+    CompiledSurface() = default;
+    CompiledSurface(const Surface<T> &srf)
+    {
+        compile(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                HomogenousSurface<T>(srf).control_points, false);
+    }
+    CompiledSurface(const RationalSurface<T> &srf)
+    {
+        compile(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                HomogenousSurface<T>(srf).control_points, true);
+    }
+
+    /**
+     * Compute the coefficients of each patch from the derivatives of the
+     * surface at the corner of the patch
+     * @param[in] degree_u Degree of the surface in u-direction.
+     * @param[in] degree_v Degree of the surface in v-direction.
+     * @param[in] knots_u Knot vector of the surface in u-direction.
+     * @param[in] knots_v Knot vector of the surface in v-direction.
+     * @param[in] control_points Control points in homogenous coordinates.
+     * @param[in] rational Whether to keep the weight polynomials.
+     */
+    void compile(unsigned int degree_u, unsigned int degree_v, const std::vector<T> &knots_u,
+                 const std::vector<T> &knots_v, const array2<glm::vec<4, T>> &control_points,
+                 bool rational)
+    {
+        this->degree_u = degree_u;
+        this->degree_v = degree_v;
+        coeffs.clear();
+        wcoeffs.clear();
+
+        std::vector<int> spans_u, spans_v;
+        internal::compiledBreaks(degree_u, knots_u, breaks_u, spans_u);
+        internal::compiledBreaks(degree_v, knots_v, breaks_v, spans_v);
+
+        EvalWorkspace<T> ws;
+        for (int span_u : spans_u)
+        {
+            T a = knots_u[span_u];
+            bsplineDerBasis(degree_u, span_u, knots_u, a, degree_u, ws.ders_u, ws.ndu, ws.a);
+            for (int span_v : spans_v)
+            {
+                T b = knots_v[span_v];
+                bsplineDerBasis(degree_v, span_v, knots_v, b, degree_v, ws.ders_v, ws.ndu, ws.a);
+
+                // Taylor coefficients S^(i,j)(a, b) / (i! j!)
+                T fact_i = 1;
+                for (int i = 0; i <= degree_u; ++i)
+                {
+                    fact_i *= (i > 0) ? i : 1;
+                    T fact_j = 1;
+                    for (int j = 0; j <= degree_v; ++j)
+                    {
+                        fact_j *= (j > 0) ? j : 1;
+                        glm::vec<4, T> c(0.0);
+                        for (int r = 0; r <= degree_u; ++r)
+                        {
+                            glm::vec<4, T> temp(0.0);
+                            for (int s = 0; s <= degree_v; ++s)
+                            {
+                                temp += ws.ders_v(j, s) * control_points(span_u - degree_u + r,
+                                                                         span_v - degree_v + s);
+                            }
+                            c += ws.ders_u(i, r) * temp;
+                        }
+                        c /= fact_i * fact_j;
+                        coeffs.push_back(glm::vec<3, T>(c));
+                        if (rational)
+                        {
+                            wcoeffs.push_back(c[3]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+};
+
+// Typedefs for ease of use
+typedef CompiledCurve<float> CompiledCurve3f;
+typedef CompiledCurve<double> CompiledCurve3d;
+typedef CompiledSurface<float> CompiledSurface3f;
+typedef CompiledSurface<double> CompiledSurface3d;
+
+/////////////////////////////////////////////////////////////////////
+
+namespace internal
+{
+
+/**
+ * Evaluate the polynomial of one segment of a compiled curve
+ * @param[in] crv CompiledCurve object
+ * @param[in] seg Index of the segment.
+ * @param[in] t Parameter relative to the start of the segment.
+ * @return Point on the polynomial of the segment at t.
+ */
+template <typename T>
+glm::vec<3, T> compiledCurvePoint(const CompiledCurve<T> &crv, size_t seg, T t)
+{
+    size_t base = seg * (crv.degree + 1);
+    glm::vec<3, T> point = hornerDerivative(&crv.coeffs[base], crv.degree, 0, t);
+    if (!crv.wcoeffs.empty())
+    {
+        point /= hornerDerivative(&crv.wcoeffs[base], crv.degree, 0, t);
+    }
+    return point;
+}
+
+/**
+ * Evaluate the polynomial of one patch of a compiled surface
+ * @param[in] srf CompiledSurface object
+ * @param[in] a Index of the patch along u.
+ * @param[in] b Index of the patch along v.
+ * @param[in] s Parameter along u relative to the patch corner.
+ * @param[in] t Parameter along v relative to the patch corner.
+ * @return Point on the polynomial of the patch at (s, t).
+ */
+template <typename T>
+glm::vec<3, T> compiledSurfacePoint(const CompiledSurface<T> &srf, size_t a, size_t b, T s, T t)
+{
+    size_t base = (a * (srf.breaks_v.size() - 1) + b) * (srf.degree_u + 1) * (srf.degree_v + 1);
+    glm::vec<3, T> point =
+        hornerDerivative(&srf.coeffs[base], srf.degree_u, srf.degree_v, 0, 0, s, t);
+    if (!srf.wcoeffs.empty())
+    {
+        point /= hornerDerivative(&srf.wcoeffs[base], srf.degree_u, srf.degree_v, 0, 0, s, t);
+    }
+    return point;
+}
+
+/**
+ * Largest distance between two ways of evaluating a curve at sample parameters
+ * spread over each segment, including both ends of the segment polynomial
+ */
+template <typename T, typename CurveType>
+T compiledCurveError(const CompiledCurve<T> &ccrv, const CurveType &crv, unsigned int samples)
+{
+    T error = 0;
+    for (size_t s = 0; s + 1 < ccrv.breaks.size(); ++s)
+    {
+        T a = ccrv.breaks[s], b = ccrv.breaks[s + 1];
+        for (unsigned int i = 0; i <= samples; ++i)
+        {
+            T u = (i == samples) ? b : a + (b - a) * i / samples;
+            error = std::max(error, glm::distance(compiledCurvePoint(ccrv, s, u - a),
+                                                  curvePoint(crv, u)));
+        }
+    }
+    return error;
+}
+
+/**
+ * Largest distance between two ways of evaluating a surface at sample parameters
+ * spread over each patch, including the edges of the patch polynomial
+ */
+template <typename T, typename SurfaceType>
+T compiledSurfaceError(const CompiledSurface<T> &csrf, const SurfaceType &srf,
+                       unsigned int samples)
+{
+    T error = 0;
+    for (size_t a = 0; a + 1 < csrf.breaks_u.size(); ++a)
+    {
+        T u0 = csrf.breaks_u[a], u1 = csrf.breaks_u[a + 1];
+        for (size_t b = 0; b + 1 < csrf.breaks_v.size(); ++b)
+        {
+            T v0 = csrf.breaks_v[b], v1 = csrf.breaks_v[b + 1];
+            for (unsigned int i = 0; i <= samples; ++i)
+            {
+                T u = (i == samples) ? u1 : u0 + (u1 - u0) * i / samples;
+                for (unsigned int j = 0; j <= samples; ++j)
+                {
+                    T v = (j == samples) ? v1 : v0 + (v1 - v0) * j / samples;
+                    error = std::max(error,
+                                     glm::distance(compiledSurfacePoint(csrf, a, b, u - u0, v - v0),
+                                                   surfacePoint(srf, u, v)));
+                }
+            }
+        }
+    }
+    return error;
+}
+
+} // namespace internal
+
+/////////////////////////////////////////////////////////////////////
+
+/**
+ * Evaluate point on a compiled curve
+ * @param[in] crv CompiledCurve object
+ * @param[in] u Parameter to evaluate the curve at.
+ * @return point Resulting point on the curve at parameter u.
+ */
+template <typename T> glm::vec<3, T> curvePoint(const CompiledCurve<T> &crv, T u)
+{
+    size_t seg = internal::compiledSegment(crv.breaks, u);
+    return internal::compiledCurvePoint(crv, seg, u - crv.breaks[seg]);
+}
+
+/**
+ * Evaluate derivatives of a compiled curve without allocating
+ * @param[in] crv CompiledCurve object
+ * @param[in] num_ders Number of times to differentiate.
+ * @param[in] u Parameter to evaluate the derivatives at.
+ * @param[out] curve_ders Derivatives of the curve at u, where curve_ders[n] is
+ * the nth derivative at u.
+ * @param[inout] ws Workspace reused across evaluations.
+ */
+template <typename T>
+void curveDerivatives(const CompiledCurve<T> &crv, int num_ders, T u,
+                      std::vector<glm::vec<3, T>> &curve_ders, EvalWorkspace<T> &ws)
+{
+    size_t seg = internal::compiledSegment(crv.breaks, u);
+    T t = u - crv.breaks[seg];
+    size_t base = seg * (crv.degree + 1);
+    bool rational = !crv.wcoeffs.empty();
+
+    curve_ders.resize(num_ders + 1);
+    ws.curve_wders.resize(num_ders + 1);
+    for (int k = 0; k <= num_ders; ++k)
+    {
+        curve_ders[k] = internal::hornerDerivative(&crv.coeffs[base], crv.degree, k, t);
+        if (rational)
+        {
+            ws.curve_wders[k] = internal::hornerDerivative(&crv.wcoeffs[base], crv.degree, k, t);
+        }
+    }
+
+    if (rational)
+    {
+        internal::curveQuotientRule(ws.curve_wders.data(), ws.binomials(num_ders), num_ders,
+                                    curve_ders.data());
+    }
+}
+
+/**
+ * Evaluate derivatives of a compiled curve
+ * @param[in] crv CompiledCurve object
+ * @param[in] num_ders Number of times to differentiate.
+ * @param[in] u Parameter to evaluate the derivatives at.
+ * @return curve_ders Derivatives of the curve at u.
+ * E.g. curve_ders[n] is the nth derivative at u, where 0 <= n <= num_ders.
+ */
+template <typename T>
+std::vector<glm::vec<3, T>> curveDerivatives(const CompiledCurve<T> &crv, int num_ders, T u)
+{
+    EvalWorkspace<T> ws;
+    std::vector<glm::vec<3, T>> curve_ders;
+    curveDerivatives(crv, num_ders, u, curve_ders, ws);
+    return curve_ders;
+}
+
+/**
+ * Evaluate point on a compiled surface
+ * @param[in] srf CompiledSurface object
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @return Resulting point on the surface at (u, v).
+ */
+template <typename T> glm::vec<3, T> surfacePoint(const CompiledSurface<T> &srf, T u, T v)
+{
+    size_t a = internal::compiledSegment(srf.breaks_u, u);
+    size_t b = internal::compiledSegment(srf.breaks_v, v);
+    return internal::compiledSurfacePoint(srf, a, b, u - srf.breaks_u[a], v - srf.breaks_v[b]);
+}
+
+/**
+ * Evaluate derivatives on a compiled surface without allocating
+ * @param[in] srf CompiledSurface object
+ * @param[in] num_ders Number of times to differentiate
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @param[out] surf_ders Derivatives on the surface at parameter (u, v).
+ * @param[inout] ws Workspace reused across evaluations.
+ */
+template <typename T>
+void surfaceDerivatives(const CompiledSurface<T> &srf, int num_ders, T u, T v,
+                        array2<glm::vec<3, T>> &surf_ders, EvalWorkspace<T> &ws)
+{
+    size_t a = internal::compiledSegment(srf.breaks_u, u);
+    size_t b = internal::compiledSegment(srf.breaks_v, v);
+    T s = u - srf.breaks_u[a], t = v - srf.breaks_v[b];
+    size_t base = (a * (srf.breaks_v.size() - 1) + b) * (srf.degree_u + 1) * (srf.degree_v + 1);
+    bool rational = !srf.wcoeffs.empty();
+
+    surf_ders.resize(num_ders + 1, num_ders + 1);
+    ws.surf_wders.resize(num_ders + 1, num_ders + 1);
+    for (int k = 0; k <= num_ders; ++k)
+    {
+        for (int l = 0; l <= num_ders; ++l)
+        {
+            surf_ders(k, l) = glm::vec<3, T>(0.0);
+            ws.surf_wders(k, l) = T(0);
+            if (k + l > num_ders)
+            {
+                continue;
+            }
+            surf_ders(k, l) = internal::hornerDerivative(&srf.coeffs[base], srf.degree_u,
+                                                         srf.degree_v, k, l, s, t);
+            if (rational)
+            {
+                ws.surf_wders(k, l) = internal::hornerDerivative(&srf.wcoeffs[base], srf.degree_u,
+                                                                 srf.degree_v, k, l, s, t);
+            }
+        }
+    }
+
+    if (rational)
+    {
+        internal::surfaceQuotientRule(ws.surf_wders, ws.binomials(num_ders), surf_ders);
+    }
+}
+
+/**
+ * Evaluate derivatives on a compiled surface
+ * @param[in] srf CompiledSurface object
+ * @param[in] num_ders Number of times to differentiate
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @return Derivatives on the surface at parameter (u, v).
+ */
+template <typename T>
+array2<glm::vec<3, T>> surfaceDerivatives(const CompiledSurface<T> &srf, int num_ders, T u, T v)
+{
+    EvalWorkspace<T> ws;
+    array2<glm::vec<3, T>> surf_ders;
+    surfaceDerivatives(srf, num_ders, u, v, surf_ders, ws);
+    return surf_ders;
+}
+
+/**
+ * Measure how closely a compiled curve reproduces the curve it was built from
+ * @param[in] ccrv CompiledCurve object
+ * @param[in] crv Curve object the compiled curve was built from
+ * @param[in] samples Number of intervals per segment, sampled at both ends
+ * @return Largest distance between the two curves over the samples
+ */
+template <typename T>
+T curveCompiledError(const CompiledCurve<T> &ccrv, const Curve<T> &crv, unsigned int samples = 16)
+{
+    return internal::compiledCurveError(ccrv, crv, samples);
+}
+
+/**
+ * Measure how closely a compiled curve reproduces the rational curve it was
+ * built from
+ * @param[in] ccrv CompiledCurve object
+ * @param[in] crv RationalCurve object the compiled curve was built from
+ * @param[in] samples Number of intervals per segment, sampled at both ends
+ * @return Largest distance between the two curves over the samples
+ */
+template <typename T>
+T curveCompiledError(const CompiledCurve<T> &ccrv, const RationalCurve<T> &crv,
+                     unsigned int samples = 16)
+{
+    return internal::compiledCurveError(ccrv, crv, samples);
+}
+
+/**
+ * Measure how closely a compiled surface reproduces the surface it was built from
+ * @param[in] csrf CompiledSurface object
+ * @param[in] srf Surface object the compiled surface was built from
+ * @param[in] samples Number of intervals per patch along each direction, sampled at both ends
+ * @return Largest distance between the two surfaces over the samples
+ */
+template <typename T>
+T surfaceCompiledError(const CompiledSurface<T> &csrf, const Surface<T> &srf,
+                       unsigned int samples = 8)
+{
+    return internal::compiledSurfaceError(csrf, srf, samples);
+}
+
+/**
+ * Measure how closely a compiled surface reproduces the rational surface it was
+ * built from
+ * @param[in] csrf CompiledSurface object
+ * @param[in] srf RationalSurface object the compiled surface was built from
+ * @param[in] samples Number of intervals per patch along each direction, sampled at both ends
+ * @return Largest distance between the two surfaces over the samples
+ */
+template <typename T>
+T surfaceCompiledError(const CompiledSurface<T> &csrf, const RationalSurface<T> &srf,
+                       unsigned int samples = 8)
+{
+    return internal::compiledSurfaceError(csrf, srf, samples);
+}
+
+} // namespace tinynurbs
+
+#endif // TINYNURBS_COMPILED_H
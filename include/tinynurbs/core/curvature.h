@@ -0,0 +1,868 @@
+/**
+ * Differential geometry of NURBS curves and surfaces: curvature, torsion and
+ * moving frames of curves, and fundamental forms and curvatures of surfaces,
+ * evaluated over many parameters
+ *
+ * Use of this source code is governed by a BSD-style license that can be found in
+ * the LICENSE file.
+ */
+
+#ifndef TINYNURBS_CURVATURE_H
+#define TINYNURBS_CURVATURE_H
+
+#include "../util/util.h"
+#include "curve.h"
+#include "evaluate.h"
+#include "glm/glm.hpp"
+#include "surface.h"
+#include "workspace.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace tinynurbs
+{
+
+/**
+Struct holding differential quantities of a surface over a grid of parameters.
+Each quantity is stored in its own 2D array so that it can be mapped to colours
+directly, and entry (i, j) of every array belongs to (us[i], vs[j]). The second
+fundamental form, the curvatures and the principal directions are taken with
+respect to the unit normal returned by surfaceNormal().
+\tparam T Data type of the quantities (float or double)
+*/
+template <typename T> struct SurfaceCurvatureField
+{
+    // Coefficients of the first fundamental form
+    array2<T> E, F, G;
+    // Coefficients of the second fundamental form
+    array2<T> L, M, N;
+    // Gaussian and mean curvature
+    array2<T> gaussian, mean;
+    // Principal curvatures with k1 >= k2
+    array2<T> k1, k2;
+    // Unit principal directions of k1 and k2
+    array2<glm::vec<3, T>> dir1, dir2;
+
+    /**
+     * Resize all arrays to the given grid size
+     * @param[in] rows Number of parameters along u.
+     * @param[in] cols Number of parameters along v.
+     */
+    void resize(size_t rows, size_t cols)
+    {
+        for (array2<T> *field : {&E, &F, &G, &L, &M, &N, &gaussian, &mean, &k1, &k2})
+        {
+            field->resize(rows, cols);
+        }
+        dir1.resize(rows, cols);
+        dir2.resize(rows, cols);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////
+
+namespace internal
+{
+
+/**
+ * Evaluate derivatives of a non-rational curve using the scratch buffers of a
+ * workspace
+ * @param[in] crv Curve object
+ * @param[in] num_ders Number of times to derivate.
+ * @param[in] u Parameter to evaluate the derivatives at.
+ * @param[out] ders Array of (num_ders + 1) derivatives of the curve at u.
+ * @param[inout] ws Workspace providing scratch buffers and the span hint.
+ */
+template <typename T>
+void curveSampleDerivatives(const Curve<T> &crv, int num_ders, T u, glm::vec<3, T> *ders,
+                            EvalWorkspace<T> &ws)
+{
+    curveDerivatives(crv.degree, crv.knots, crv.control_points, num_ders, u, ders, ws);
+}
+
+/**
+ * Evaluate derivatives of a rational curve using the scratch buffers of a
+ * workspace
+ * @param[in] crv RationalCurve object
+ * @param[in] num_ders Number of times to derivate.
+ * @param[in] u Parameter to evaluate the derivatives at.
+ * @param[out] ders Array of (num_ders + 1) derivatives of the curve at u.
+ * @param[inout] ws Workspace providing scratch buffers and the span hint.
+ */
+template <typename T>
+void curveSampleDerivatives(const RationalCurve<T> &crv, int num_ders, T u, glm::vec<3, T> *ders,
+                            EvalWorkspace<T> &ws)
+{
+    curveDerivatives(crv.degree, crv.knots, crv.control_points, crv.weights, num_ders, u, ders,
+                     ws);
+}
+
+/**
+ * Normalize a vector unless its length is close to zero
+ * @param[in] vec Vector to normalize
+ * @return Unit vector, or the input vector if it has zero length
+ */
+template <typename T> glm::vec<3, T> normalizeNonZero(const glm::vec<3, T> &vec)
+{
+    T len = glm::length(vec);
+    return util::close(len, T(0)) ? vec : vec / len;
+}
+
+/**
+ * Compute a unit vector perpendicular to the given direction by crossing it
+ * with the coordinate axis it is least aligned with
+ * @param[in] dir Direction
+ * @return Unit vector perpendicular to dir, or zero if dir is zero
+ */
+template <typename T> glm::vec<3, T> anyPerpendicular(const glm::vec<3, T> &dir)
+{
+    glm::vec<3, T> a = glm::abs(dir);
+    glm::vec<3, T> axis(0.0);
+    if (a.x <= a.y && a.x <= a.z)
+    {
+        axis.x = 1;
+    }
+    else if (a.y <= a.z)
+    {
+        axis.y = 1;
+    }
+    else
+    {
+        axis.z = 1;
+    }
+    return normalizeNonZero(glm::cross(dir, axis));
+}
+
+/**
+ * Compute the curvature of a curve from its first two derivatives
+ * @param[in] d1 First derivative
+ * @param[in] d2 Second derivative
+ * @return Curvature, or zero where the first derivative vanishes
+ */
+template <typename T> T curvatureFromDerivatives(const glm::vec<3, T> &d1, const glm::vec<3, T> &d2)
+{
+    T speed = glm::length(d1);
+    if (util::close(speed, T(0)))
+    {
+        return T(0);
+    }
+    return glm::length(glm::cross(d1, d2)) / (speed * speed * speed);
+}
+
+/**
+ * Compute the torsion of a curve from its first three derivatives
+ * @param[in] d1 First derivative
+ * @param[in] d2 Second derivative
+ * @param[in] d3 Third derivative
+ * @return Torsion, or zero where the curvature vanishes
+ */
+template <typename T>
+T torsionFromDerivatives(const glm::vec<3, T> &d1, const glm::vec<3, T> &d2,
+                         const glm::vec<3, T> &d3)
+{
+    glm::vec<3, T> b = glm::cross(d1, d2);
+    T b_len = glm::length(b);
+    if (util::close(b_len, T(0)))
+    {
+        return T(0);
+    }
+    return glm::dot(b, d3) / (b_len * b_len);
+}
+
+/**
+ * Compute the curvature of a curve at many parameters
+ * @param[in] crv Curve or RationalCurve object
+ * @param[in] params Parameters, preferably in ascending order
+ * @param[out] curvatures Curvature at each parameter
+ * @param[inout] ws Workspace providing scratch buffers and the span hint.
+ */
+template <typename CurveType, typename T>
+void curveCurvatures(const CurveType &crv, const std::vector<T> &params,
+                     std::vector<T> &curvatures, EvalWorkspace<T> &ws)
+{
+    std::array<glm::vec<3, T>, 3> ders;
+    curvatures.resize(params.size());
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        curveSampleDerivatives(crv, 2, params[i], ders.data(), ws);
+        curvatures[i] = curvatureFromDerivatives(ders[1], ders[2]);
+    }
+}
+
+/**
+ * Compute the torsion of a curve at many parameters
+ * @param[in] crv Curve or RationalCurve object
+ * @param[in] params Parameters, preferably in ascending order
+ * @param[out] torsions Torsion at each parameter
+ * @param[inout] ws Workspace providing scratch buffers and the span hint.
+ */
+template <typename CurveType, typename T>
+void curveTorsions(const CurveType &crv, const std::vector<T> &params, std::vector<T> &torsions,
+                   EvalWorkspace<T> &ws)
+{
+    std::array<glm::vec<3, T>, 4> ders;
+    torsions.resize(params.size());
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        curveSampleDerivatives(crv, 3, params[i], ders.data(), ws);
+        torsions[i] = torsionFromDerivatives(ders[1], ders[2], ders[3]);
+    }
+}
+
+/**
+ * Compute the Frenet frames of a curve at many parameters. Where the curvature
+ * vanishes the Frenet normal is undefined, and the previous normal projected
+ * onto the normal plane is used instead.
+ * @param[in] crv Curve or RationalCurve object
+ * @param[in] params Parameters, preferably in ascending order
+ * @param[out] tangents Unit tangent at each parameter
+ * @param[out] normals Unit principal normal at each parameter
+ * @param[out] binormals Unit binormal at each parameter
+ * @param[inout] ws Workspace providing scratch buffers and the span hint.
+ */
+template <typename CurveType, typename T>
+void curveFrenetFrames(const CurveType &crv, const std::vector<T> &params,
+                       std::vector<glm::vec<3, T>> &tangents, std::vector<glm::vec<3, T>> &normals,
+                       std::vector<glm::vec<3, T>> &binormals, EvalWorkspace<T> &ws)
+{
+    std::array<glm::vec<3, T>, 3> ders;
+    tangents.resize(params.size());
+    normals.resize(params.size());
+    binormals.resize(params.size());
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        curveSampleDerivatives(crv, 2, params[i], ders.data(), ws);
+        glm::vec<3, T> t = normalizeNonZero(ders[1]);
+        glm::vec<3, T> b = glm::cross(ders[1], ders[2]);
+        glm::vec<3, T> n;
+        T b_len = glm::length(b);
+        if (!util::close(b_len, T(0)))
+        {
+            b /= b_len;
+            n = glm::cross(b, t);
+        }
+        else
+        {
+            n = (i > 0) ? normalizeNonZero(normals[i - 1] - glm::dot(normals[i - 1], t) * t)
+                        : anyPerpendicular(t);
+            if (util::close(glm::length(n), T(0)))
+            {
+                n = anyPerpendicular(t);
+            }
+            b = glm::cross(t, n);
+        }
+        tangents[i] = t;
+        normals[i] = n;
+        binormals[i] = b;
+    }
+}
+
+/**
+ * Compute rotation minimizing frames of a curve at many parameters with the
+ * double reflection method of Wang et al. (2008). The first normal is the Frenet
+ * normal at params[0], or any normal if the curvature vanishes there, and each
+ * following normal is propagated from the previous sample.
+ * @param[in] crv Curve or RationalCurve object
+ * @param[in] params Parameters in ascending order
+ * @param[out] tangents Unit tangent at each parameter
+ * @param[out] normals Unit normal at each parameter
+ * @param[out] binormals Unit binormal at each parameter
+ * @param[inout] ws Workspace providing scratch buffers and the span hint.
+ */
+template <typename CurveType, typename T>
+void curveRotationMinimizingFrames(const CurveType &crv, const std::vector<T> &params,
+                                   std::vector<glm::vec<3, T>> &tangents,
+                                   std::vector<glm::vec<3, T>> &normals,
+                                   std::vector<glm::vec<3, T>> &binormals, EvalWorkspace<T> &ws)
+{
+    typedef glm::vec<3, T> tvec3;
+
+    std::array<tvec3, 3> ders;
+    tangents.resize(params.size());
+    normals.resize(params.size());
+    binormals.resize(params.size());
+    tvec3 prev_pt(0.0);
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        // Only the first frame needs the second derivative
+        curveSampleDerivatives(crv, (i == 0) ? 2 : 1, params[i], ders.data(), ws);
+        tvec3 t = normalizeNonZero(ders[1]);
+        tvec3 n;
+        if (i == 0)
+        {
+            n = normalizeNonZero(glm::cross(glm::cross(ders[1], ders[2]), t));
+            if (util::close(glm::length(n), T(0)))
+            {
+                n = anyPerpendicular(t);
+            }
+        }
+        else
+        {
+            // Reflect the previous frame in the bisecting plane of the two
+            // points, then in the bisecting plane of the two tangents
+            tvec3 v1 = ders[0] - prev_pt;
+            T c1 = glm::dot(v1, v1);
+            tvec3 n_l = normals[i - 1];
+            tvec3 t_l = tangents[i - 1];
+            if (c1 > T(0))
+            {
+                n_l -= (T(2) / c1) * glm::dot(v1, n_l) * v1;
+                t_l -= (T(2) / c1) * glm::dot(v1, t_l) * v1;
+            }
+            tvec3 v2 = t - t_l;
+            T c2 = glm::dot(v2, v2);
+            n = n_l;
+            if (c2 > T(0))
+            {
+                n -= (T(2) / c2) * glm::dot(v2, n_l) * v2;
+            }
+        }
+        tangents[i] = t;
+        normals[i] = n;
+        binormals[i] = glm::cross(t, n);
+        prev_pt = ders[0];
+    }
+}
+
+/**
+ * Compute the fundamental forms, curvatures and principal directions of a
+ * surface at one grid point from its partial derivatives. Where the first
+ * fundamental form is singular the curvatures and directions are zero.
+ * @param[in] der_u First derivative along u.
+ * @param[in] der_v First derivative along v.
+ * @param[in] der_uu Second derivative along u.
+ * @param[in] der_uv Mixed second derivative.
+ * @param[in] der_vv Second derivative along v.
+ * @param[in] i Row of the grid point.
+ * @param[in] j Column of the grid point.
+ * @param[inout] field Field to store the quantities in.
+ */
+template <typename T>
+void surfaceCurvatureFromDerivatives(const glm::vec<3, T> &der_u, const glm::vec<3, T> &der_v,
+                                     const glm::vec<3, T> &der_uu, const glm::vec<3, T> &der_uv,
+                                     const glm::vec<3, T> &der_vv, size_t i, size_t j,
+                                     SurfaceCurvatureField<T> &field)
+{
+    typedef glm::vec<3, T> tvec3;
+
+    // Same orientation as surfaceNormal()
+    tvec3 n = normalizeNonZero(glm::cross(der_v, der_u));
+    T E = glm::dot(der_u, der_u);
+    T F = glm::dot(der_u, der_v);
+    T G = glm::dot(der_v, der_v);
+    T L = glm::dot(der_uu, n);
+    T M = glm::dot(der_uv, n);
+    T N = glm::dot(der_vv, n);
+
+    T K = 0, H = 0, k1 = 0, k2 = 0;
+    tvec3 dir1(0.0), dir2(0.0);
+    T det = E * G - F * F;
+    if (!util::close(det, T(0)))
+    {
+        K = (L * N - M * M) / det;
+        H = (E * N - 2 * F * M + G * L) / (2 * det);
+        T disc = std::sqrt(std::max(H * H - K, T(0)));
+        k1 = H + disc;
+        k2 = H - disc;
+
+        // Parametric direction (du, dv) in the kernel of II - k1 * I, taken from
+        // the row of larger magnitude
+        T a = L - k1 * E, b = M - k1 * F, c = N - k1 * G;
+        T du = -b, dv = a;
+        if (std::abs(c) > std::abs(a))
+        {
+            du = c;
+            dv = -b;
+        }
+        dir1 = normalizeNonZero(du * der_u + dv * der_v);
+        if (util::close(glm::length(dir1), T(0)))
+        {
+            // Umbilic point, where every direction is principal
+            dir1 = normalizeNonZero(der_u);
+        }
+        dir2 = glm::cross(n, dir1);
+    }
+
+    field.E(i, j) = E;
+    field.F(i, j) = F;
+    field.G(i, j) = G;
+    field.L(i, j) = L;
+    field.M(i, j) = M;
+    field.N(i, j) = N;
+    field.gaussian(i, j) = K;
+    field.mean(i, j) = H;
+    field.k1(i, j) = k1;
+    field.k2(i, j) = k2;
+    field.dir1(i, j) = dir1;
+    field.dir2(i, j) = dir2;
+}
+
+/**
+ * Evaluate the curvature field of a non-rational surface over the
+ * tensor-product grid of the given parameters. The basis functions and their
+ * first two derivatives are computed once per u and once per v, and the control
+ * points are contracted along u once per grid row.
+ * @param[in] degree_u Degree of the given surface in u-direction.
+ * @param[in] degree_v Degree of the given surface in v-direction.
+ * @param[in] knots_u Knot vector of the surface in u-direction.
+ * @param[in] knots_v Knot vector of the surface in v-direction.
+ * @param[in] control_points Control points of the surface in a 2d array.
+ * @param[in] us Parameters along u-direction.
+ * @param[in] vs Parameters along v-direction.
+ * @param[out] field Differential quantities at the grid points.
+ */
+template <typename T>
+void surfaceCurvatureGrid(unsigned int degree_u, unsigned int degree_v,
+                          const std::vector<T> &knots_u, const std::vector<T> &knots_v,
+                          const array2<glm::vec<3, T>> &control_points, const std::vector<T> &us,
+                          const std::vector<T> &vs, SurfaceCurvatureField<T> &field)
+{
+    typedef glm::vec<3, T> tvec3;
+
+    field.resize(us.size(), vs.size());
+
+    std::vector<int> spans_u, spans_v;
+    array2<T> Nu, Nv;
+    derBasisRows(degree_u, knots_u, us, 2, spans_u, Nu);
+    derBasisRows(degree_v, knots_v, vs, 2, spans_v, Nv);
+    const unsigned int nu = degree_u + 1, nv = degree_v + 1;
+
+    // Control points contracted along u with the kth basis function derivative
+    // in temp(k, c), for the current row
+    array2<tvec3> temp(3, control_points.cols());
+
+    for (size_t i = 0; i < us.size(); ++i)
+    {
+        int row0 = spans_u[i] - degree_u;
+        for (size_t c = 0; c < control_points.cols(); ++c)
+        {
+            for (int k = 0; k <= 2; ++k)
+            {
+                tvec3 sum(0.0);
+                for (unsigned int r = 0; r < nu; r++)
+                {
+                    sum += Nu(i, k * nu + r) * control_points(row0 + r, c);
+                }
+                temp(k, c) = sum;
+            }
+        }
+
+        for (size_t j = 0; j < vs.size(); ++j)
+        {
+            int col0 = spans_v[j] - degree_v;
+            tvec3 der_u(0.0), der_v(0.0), der_uu(0.0), der_uv(0.0), der_vv(0.0);
+            for (unsigned int l = 0; l < nv; l++)
+            {
+                T m0 = Nv(j, l), m1 = Nv(j, nv + l), m2 = Nv(j, 2 * nv + l);
+                der_u += m0 * temp(1, col0 + l);
+                der_v += m1 * temp(0, col0 + l);
+                der_uu += m0 * temp(2, col0 + l);
+                der_uv += m1 * temp(1, col0 + l);
+                der_vv += m2 * temp(0, col0 + l);
+            }
+            surfaceCurvatureFromDerivatives(der_u, der_v, der_uu, der_uv, der_vv, i, j, field);
+        }
+    }
+}
+
+/**
+ * Evaluate the curvature field of a rational surface over the tensor-product
+ * grid of the given parameters. The basis functions and their first two
+ * derivatives are computed once per u and once per v, and the weighted control
+ * points are contracted along u once per grid row.
+ * @param[in] degree_u Degree of the given surface in u-direction.
+ * @param[in] degree_v Degree of the given surface in v-direction.
+ * @param[in] knots_u Knot vector of the surface in u-direction.
+ * @param[in] knots_v Knot vector of the surface in v-direction.
+ * @param[in] control_points Control points of the surface in a 2d array.
+ * @param[in] weights Weights corresponding to the control points.
+ * @param[in] us Parameters along u-direction.
+ * @param[in] vs Parameters along v-direction.
+ * @param[out] field Differential quantities at the grid points.
+ */
+template <typename T>
+void surfaceCurvatureGrid(unsigned int degree_u, unsigned int degree_v,
+                          const std::vector<T> &knots_u, const std::vector<T> &knots_v,
+                          const array2<glm::vec<3, T>> &control_points, const array2<T> &weights,
+                          const std::vector<T> &us, const std::vector<T> &vs,
+                          SurfaceCurvatureField<T> &field)
+{
+    typedef glm::vec<3, T> tvec3;
+    typedef glm::vec<4, T> tvec4;
+
+    field.resize(us.size(), vs.size());
+
+    std::vector<int> spans_u, spans_v;
+    array2<T> Nu, Nv;
+    derBasisRows(degree_u, knots_u, us, 2, spans_u, Nu);
+    derBasisRows(degree_v, knots_v, vs, 2, spans_v, Nv);
+    const unsigned int nu = degree_u + 1, nv = degree_v + 1;
+
+    // Homogenous control points contracted along u with the kth basis function
+    // derivative in temp(k, c), for the current row
+    array2<tvec4> temp(3, control_points.cols());
+
+    for (size_t i = 0; i < us.size(); ++i)
+    {
+        int row0 = spans_u[i] - degree_u;
+        for (size_t c = 0; c < control_points.cols(); ++c)
+        {
+            tvec4 sum0(0.0), sum1(0.0), sum2(0.0);
+            for (unsigned int r = 0; r < nu; r++)
+            {
+                tvec4 cpw = util::cartesianToHomogenous(control_points(row0 + r, c),
+                                                        weights(row0 + r, c));
+                sum0 += Nu(i, r) * cpw;
+                sum1 += Nu(i, nu + r) * cpw;
+                sum2 += Nu(i, 2 * nu + r) * cpw;
+            }
+            temp(0, c) = sum0;
+            temp(1, c) = sum1;
+            temp(2, c) = sum2;
+        }
+
+        for (size_t j = 0; j < vs.size(); ++j)
+        {
+            int col0 = spans_v[j] - degree_v;
+            tvec4 pw(0.0), pw_u(0.0), pw_v(0.0), pw_uu(0.0), pw_uv(0.0), pw_vv(0.0);
+            for (unsigned int l = 0; l < nv; l++)
+            {
+                T m0 = Nv(j, l), m1 = Nv(j, nv + l), m2 = Nv(j, 2 * nv + l);
+                pw += m0 * temp(0, col0 + l);
+                pw_u += m0 * temp(1, col0 + l);
+                pw_v += m1 * temp(0, col0 + l);
+                pw_uu += m0 * temp(2, col0 + l);
+                pw_uv += m1 * temp(1, col0 + l);
+                pw_vv += m2 * temp(0, col0 + l);
+            }
+
+            // Quotient rule up to second order
+            T w = pw.w;
+            tvec3 pt = util::truncateHomogenous(pw) / w;
+            tvec3 der_u = (util::truncateHomogenous(pw_u) - pw_u.w * pt) / w;
+            tvec3 der_v = (util::truncateHomogenous(pw_v) - pw_v.w * pt) / w;
+            tvec3 der_uu =
+                (util::truncateHomogenous(pw_uu) - 2 * pw_u.w * der_u - pw_uu.w * pt) / w;
+            tvec3 der_uv = (util::truncateHomogenous(pw_uv) - pw_u.w * der_v - pw_v.w * der_u -
+                            pw_uv.w * pt) /
+                           w;
+            tvec3 der_vv =
+                (util::truncateHomogenous(pw_vv) - 2 * pw_v.w * der_v - pw_vv.w * pt) / w;
+            surfaceCurvatureFromDerivatives(der_u, der_v, der_uu, der_uv, der_vv, i, j, field);
+        }
+    }
+}
+
+} // namespace internal
+
+/////////////////////////////////////////////////////////////////////
+
+/**
+ * Evaluate the curvature of a non-rational curve at many parameters. Sorted
+ * parameters are evaluated without searching the knot vector.
+ * @param[in] crv Curve object
+ * @param[in] params Parameters to evaluate the curvature at
+ * @param[out] curvatures Curvature at each parameter
+ * @param[inout] ws Workspace providing scratch buffers and the span hint
+ */
+template <typename T>
+void curveCurvatures(const Curve<T> &crv, const std::vector<T> &params,
+                     std::vector<T> &curvatures, EvalWorkspace<T> &ws)
+{
+    internal::curveCurvatures(crv, params, curvatures, ws);
+}
+
+/**
+ * Evaluate the curvature of a non-rational curve at many parameters. Sorted
+ * parameters are evaluated without searching the knot vector.
+ * @param[in] crv Curve object
+ * @param[in] params Parameters to evaluate the curvature at
+ * @param[out] curvatures Curvature at each parameter
+ */
+template <typename T>
+void curveCurvatures(const Curve<T> &crv, const std::vector<T> &params, std::vector<T> &curvatures)
+{
+    EvalWorkspace<T> ws;
+    internal::curveCurvatures(crv, params, curvatures, ws);
+}
+
+/**
+ * Evaluate the torsion of a non-rational curve at many parameters. Sorted
+ * parameters are evaluated without searching the knot vector.
+ * @param[in] crv Curve object
+ * @param[in] params Parameters to evaluate the torsion at
+ * @param[out] torsions Torsion at each parameter
+ * @param[inout] ws Workspace providing scratch buffers and the span hint
+ */
+template <typename T>
+void curveTorsions(const Curve<T> &crv, const std::vector<T> &params,
+                   std::vector<T> &torsions, EvalWorkspace<T> &ws)
+{
+    internal::curveTorsions(crv, params, torsions, ws);
+}
+
+/**
+ * Evaluate the torsion of a non-rational curve at many parameters. Sorted
+ * parameters are evaluated without searching the knot vector.
+ * @param[in] crv Curve object
+ * @param[in] params Parameters to evaluate the torsion at
+ * @param[out] torsions Torsion at each parameter
+ */
+template <typename T>
+void curveTorsions(const Curve<T> &crv, const std::vector<T> &params, std::vector<T> &torsions)
+{
+    EvalWorkspace<T> ws;
+    internal::curveTorsions(crv, params, torsions, ws);
+}
+
+/**
+ * Evaluate the Frenet frames of a non-rational curve at many parameters.
+ * Sorted parameters are evaluated without searching the knot vector.
+ * @param[in] crv Curve object
+ * @param[in] params Parameters to evaluate the frames at
+ * @param[out] tangents Unit tangent at each parameter
+ * @param[out] normals Unit normal at each parameter
+ * @param[out] binormals Unit binormal at each parameter
+ * @param[inout] ws Workspace providing scratch buffers and the span hint
+ */
+template <typename T>
+void curveFrenetFrames(const Curve<T> &crv, const std::vector<T> &params,
+                       std::vector<glm::vec<3, T>> &tangents, std::vector<glm::vec<3, T>> &normals,
+                       std::vector<glm::vec<3, T>> &binormals, EvalWorkspace<T> &ws)
+{
+    internal::curveFrenetFrames(crv, params, tangents, normals, binormals, ws);
+}
+
+/**
+ * Evaluate the Frenet frames of a non-rational curve at many parameters.
+ * Sorted parameters are evaluated without searching the knot vector.
+ * @param[in] crv Curve object
+ * @param[in] params Parameters to evaluate the frames at
+ * @param[out] tangents Unit tangent at each parameter
+ * @param[out] normals Unit normal at each parameter
+ * @param[out] binormals Unit binormal at each parameter
+ */
+template <typename T>
+void curveFrenetFrames(const Curve<T> &crv, const std::vector<T> &params,
+                       std::vector<glm::vec<3, T>> &tangents, std::vector<glm::vec<3, T>> &normals,
+                       std::vector<glm::vec<3, T>> &binormals)
+{
+    EvalWorkspace<T> ws;
+    internal::curveFrenetFrames(crv, params, tangents, normals, binormals, ws);
+}
+
+/**
+ * Evaluate rotation minimizing frames of a non-rational curve at many
+ * parameters. The frames are propagated from one parameter to the next, so the
+ * parameters must be sorted.
+ * @param[in] crv Curve object
+ * @param[in] params Parameters to evaluate the frames at
+ * @param[out] tangents Unit tangent at each parameter
+ * @param[out] normals Unit normal at each parameter
+ * @param[out] binormals Unit binormal at each parameter
+ * @param[inout] ws Workspace providing scratch buffers and the span hint
+ */
+template <typename T>
+void curveRotationMinimizingFrames(const Curve<T> &crv, const std::vector<T> &params,
+                                   std::vector<glm::vec<3, T>> &tangents,
+                                   std::vector<glm::vec<3, T>> &normals,
+                                   std::vector<glm::vec<3, T>> &binormals, EvalWorkspace<T> &ws)
+{
+    internal::curveRotationMinimizingFrames(crv, params, tangents, normals, binormals, ws);
+}
+
+/**
+ * Evaluate rotation minimizing frames of a non-rational curve at many
+ * parameters. The frames are propagated from one parameter to the next, so the
+ * parameters must be sorted.
+ * @param[in] crv Curve object
+ * @param[in] params Parameters to evaluate the frames at
+ * @param[out] tangents Unit tangent at each parameter
+ * @param[out] normals Unit normal at each parameter
+ * @param[out] binormals Unit binormal at each parameter
+ */
+template <typename T>
+void curveRotationMinimizingFrames(const Curve<T> &crv, const std::vector<T> &params,
+                                   std::vector<glm::vec<3, T>> &tangents,
+                                   std::vector<glm::vec<3, T>> &normals,
+                                   std::vector<glm::vec<3, T>> &binormals)
+{
+    EvalWorkspace<T> ws;
+    internal::curveRotationMinimizingFrames(crv, params, tangents, normals, binormals, ws);
+}
+
+/**
+ * Evaluate the curvature of a rational curve at many parameters. Sorted
+ * parameters are evaluated without searching the knot vector.
+ * @param[in] crv RationalCurve object
+ * @param[in] params Parameters to evaluate the curvature at
+ * @param[out] curvatures Curvature at each parameter
+ * @param[inout] ws Workspace providing scratch buffers and the span hint
+ */
+template <typename T>
+void curveCurvatures(const RationalCurve<T> &crv, const std::vector<T> &params,
+                     std::vector<T> &curvatures, EvalWorkspace<T> &ws)
+{
+    internal::curveCurvatures(crv, params, curvatures, ws);
+}
+
+/**
+ * Evaluate the curvature of a rational curve at many parameters. Sorted
+ * parameters are evaluated without searching the knot vector.
+ * @param[in] crv RationalCurve object
+ * @param[in] params Parameters to evaluate the curvature at
+ * @param[out] curvatures Curvature at each parameter
+ */
+template <typename T>
+void curveCurvatures(const RationalCurve<T> &crv, const std::vector<T> &params,
+                     std::vector<T> &curvatures)
+{
+    EvalWorkspace<T> ws;
+    internal::curveCurvatures(crv, params, curvatures, ws);
+}
+
+/**
+ * Evaluate the torsion of a rational curve at many parameters. Sorted
+ * parameters are evaluated without searching the knot vector.
+ * @param[in] crv RationalCurve object
+ * @param[in] params Parameters to evaluate the torsion at
+ * @param[out] torsions Torsion at each parameter
+ * @param[inout] ws Workspace providing scratch buffers and the span hint
+ */
+template <typename T>
+void curveTorsions(const RationalCurve<T> &crv, const std::vector<T> &params,
+                   std::vector<T> &torsions, EvalWorkspace<T> &ws)
+{
+    internal::curveTorsions(crv, params, torsions, ws);
+}
+
+/**
+ * Evaluate the torsion of a rational curve at many parameters. Sorted
+ * parameters are evaluated without searching the knot vector.
+ * @param[in] crv RationalCurve object
+ * @param[in] params Parameters to evaluate the torsion at
+ * @param[out] torsions Torsion at each parameter
+ */
+template <typename T>
+void curveTorsions(const RationalCurve<T> &crv, const std::vector<T> &params,
+                   std::vector<T> &torsions)
+{
+    EvalWorkspace<T> ws;
+    internal::curveTorsions(crv, params, torsions, ws);
+}
+
+/**
+ * Evaluate the Frenet frames of a rational curve at many parameters.
+ * Sorted parameters are evaluated without searching the knot vector.
+ * @param[in] crv RationalCurve object
+ * @param[in] params Parameters to evaluate the frames at
+ * @param[out] tangents Unit tangent at each parameter
+ * @param[out] normals Unit normal at each parameter
+ * @param[out] binormals Unit binormal at each parameter
+ * @param[inout] ws Workspace providing scratch buffers and the span hint
+ */
+template <typename T>
+void curveFrenetFrames(const RationalCurve<T> &crv, const std::vector<T> &params,
+                       std::vector<glm::vec<3, T>> &tangents, std::vector<glm::vec<3, T>> &normals,
+                       std::vector<glm::vec<3, T>> &binormals, EvalWorkspace<T> &ws)
+{
+    internal::curveFrenetFrames(crv, params, tangents, normals, binormals, ws);
+}
+
+/**
+ * Evaluate the Frenet frames of a rational curve at many parameters.
+ * Sorted parameters are evaluated without searching the knot vector.
+ * @param[in] crv RationalCurve object
+ * @param[in] params Parameters to evaluate the frames at
+ * @param[out] tangents Unit tangent at each parameter
+ * @param[out] normals Unit normal at each parameter
+ * @param[out] binormals Unit binormal at each parameter
+ */
+template <typename T>
+void curveFrenetFrames(const RationalCurve<T> &crv, const std::vector<T> &params,
+                       std::vector<glm::vec<3, T>> &tangents, std::vector<glm::vec<3, T>> &normals,
+                       std::vector<glm::vec<3, T>> &binormals)
+{
+    EvalWorkspace<T> ws;
+    internal::curveFrenetFrames(crv, params, tangents, normals, binormals, ws);
+}
+
+/**
+ * Evaluate rotation minimizing frames of a rational curve at many
+ * parameters. The frames are propagated from one parameter to the next, so the
+ * parameters must be sorted.
+ * @param[in] crv RationalCurve object
+ * @param[in] params Parameters to evaluate the frames at
+ * @param[out] tangents Unit tangent at each parameter
+ * @param[out] normals Unit normal at each parameter
+ * @param[out] binormals Unit binormal at each parameter
+ * @param[inout] ws Workspace providing scratch buffers and the span hint
+ */
+template <typename T>
+void curveRotationMinimizingFrames(const RationalCurve<T> &crv, const std::vector<T> &params,
+                                   std::vector<glm::vec<3, T>> &tangents,
+                                   std::vector<glm::vec<3, T>> &normals,
+                                   std::vector<glm::vec<3, T>> &binormals, EvalWorkspace<T> &ws)
+{
+    internal::curveRotationMinimizingFrames(crv, params, tangents, normals, binormals, ws);
+}
+
+/**
+ * Evaluate rotation minimizing frames of a rational curve at many
+ * parameters. The frames are propagated from one parameter to the next, so the
+ * parameters must be sorted.
+ * @param[in] crv RationalCurve object
+ * @param[in] params Parameters to evaluate the frames at
+ * @param[out] tangents Unit tangent at each parameter
+ * @param[out] normals Unit normal at each parameter
+ * @param[out] binormals Unit binormal at each parameter
+ */
+template <typename T>
+void curveRotationMinimizingFrames(const RationalCurve<T> &crv, const std::vector<T> &params,
+                                   std::vector<glm::vec<3, T>> &tangents,
+                                   std::vector<glm::vec<3, T>> &normals,
+                                   std::vector<glm::vec<3, T>> &binormals)
+{
+    EvalWorkspace<T> ws;
+    internal::curveRotationMinimizingFrames(crv, params, tangents, normals, binormals, ws);
+}
+
+/**
+ * Evaluate the fundamental forms, Gaussian and mean curvature, and principal
+ * curvatures and directions of a non-rational surface over the tensor-product
+ * grid of the given parameters
+ * @param[in] srf Surface object
+ * @param[in] us Parameters along u-direction
+ * @param[in] vs Parameters along v-direction
+ * @param[out] field Differential quantities, where entry (i, j) belongs to (us[i], vs[j])
+ */
+template <typename T>
+void surfaceCurvatureGrid(const Surface<T> &srf, const std::vector<T> &us,
+                          const std::vector<T> &vs, SurfaceCurvatureField<T> &field)
+{
+    internal::surfaceCurvatureGrid(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                                   srf.control_points, us, vs, field);
+}
+
+/**
+ * Evaluate the fundamental forms, Gaussian and mean curvature, and principal
+ * curvatures and directions of a rational surface over the tensor-product grid
+ * of the given parameters
+ * @param[in] srf RationalSurface object
+ * @param[in] us Parameters along u-direction
+ * @param[in] vs Parameters along v-direction
+ * @param[out] field Differential quantities, where entry (i, j) belongs to (us[i], vs[j])
+ */
+template <typename T>
+void surfaceCurvatureGrid(const RationalSurface<T> &srf, const std::vector<T> &us,
+                          const std::vector<T> &vs, SurfaceCurvatureField<T> &field)
+{
+    internal::surfaceCurvatureGrid(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                                   srf.control_points, srf.weights, us, vs, field);
+}
+
+} // namespace tinynurbs
+
+#endif // TINYNURBS_CURVATURE_H
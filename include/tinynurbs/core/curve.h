@@ -9,6 +9,7 @@
 #ifndef TINYNURBS_CURVE_H
 #define TINYNURBS_CURVE_H
 
+#include "../util/util.h"
 #include "glm/glm.hpp"
 #include <exception>
 #include <stdexcept>
@@ -66,11 +67,44 @@ template <typename T> struct RationalCurve
     }
 };
 
+/**
+Struct for holding a rational B-spline curve with its control points premultiplied
+by their weights, i.e., stored in homogenous coordinates. Build it once from a
+RationalCurve to evaluate the same curve repeatedly without reweighting.
+@tparam T Data type of control points and knots (float or double)
+*/
+template <typename T> struct HomogenousCurve
+{
+    unsigned int degree;
+    std::vector<T> knots;
+    std::vector<glm::vec<4, T>> control_points;
+
+    HomogenousCurve() = default;
+    HomogenousCurve(const Curve<T> &crv)
+        : HomogenousCurve(crv.degree, crv.knots, crv.control_points,
+                          std::vector<T>(crv.control_points.size(), 1.0))
+    {
+    }
+    HomogenousCurve(const RationalCurve<T> &crv)
+        : HomogenousCurve(crv.degree, crv.knots, crv.control_points, crv.weights)
+    {
+    }
+    HomogenousCurve(unsigned int degree, const std::vector<T> &knots,
+                    const std::vector<glm::vec<3, T>> &control_points,
+                    const std::vector<T> &weights)
+        : degree(degree), knots(knots),
+          control_points(util::cartesianToHomogenous(control_points, weights))
+    {
+    }
+};
+
 // Typedefs for ease of use
 typedef Curve<float> Curve3f;
 typedef Curve<double> Curve3d;
 typedef RationalCurve<float> RationalCurve3f;
 typedef RationalCurve<double> RationalCurve3d;
+typedef HomogenousCurve<float> HomogenousCurve3f;
+typedef HomogenousCurve<double> HomogenousCurve3d;
 
 } // namespace tinynurbs
 
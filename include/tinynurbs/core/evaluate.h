@@ -14,7 +14,9 @@
 #include "curve.h"
 #include "glm/glm.hpp"
 #include "surface.h"
+#include "workspace.h"
 #include "tinynurbs/util/array2.h"
+#include <array>
 #include <tuple>
 #include <vector>
 
@@ -27,79 +29,156 @@ namespace internal
 {
 
 /**
- * Evaluate point on a nonrational NURBS curve
+ * Evaluate point on a nonrational NURBS curve of a degree known at compile time
+ * @tparam Degree Degree of the given curve.
+ * @param[in] knots Knot vector of the curve.
+ * @param[in] control_points Control points of the curve.
+ * @param[in] u Parameter to evaluate the curve at.
+ * @return point Resulting point on the curve at parameter u.
+ */
+template <unsigned int Degree, int dim, typename T>
+glm::vec<dim, T> curvePoint(const std::vector<T> &knots,
+                            const std::vector<glm::vec<dim, T>> &control_points, T u)
+{
+    glm::vec<dim, T> point(T(0));
+
+    int span = findSpan(Degree, knots, u);
+    std::array<T, Degree + 1> N;
+    fixedBsplineBasis<Degree>(span, knots, u, N.data());
+
+    for (unsigned int j = 0; j <= Degree; j++)
+    {
+        point += N[j] * control_points[span - Degree + j];
+    }
+    return point;
+}
+
+/**
+ * Evaluate point on a nonrational NURBS curve using the scratch buffers of a
+ * workspace
  * @param[in] degree Degree of the given curve.
  * @param[in] knots Knot vector of the curve.
  * @param[in] control_points Control points of the curve.
  * @param[in] u Parameter to evaluate the curve at.
+ * @param[inout] ws Workspace providing scratch buffers and the span hint.
  * @return point Resulting point on the curve at parameter u.
  */
 template <int dim, typename T>
 glm::vec<dim, T> curvePoint(unsigned int degree, const std::vector<T> &knots,
-                            const std::vector<glm::vec<dim, T>> &control_points, T u)
+                            const std::vector<glm::vec<dim, T>> &control_points, T u,
+                            EvalWorkspace<T> &ws)
 {
     // Initialize result to 0s
     glm::vec<dim, T> point(T(0));
 
     // Find span and corresponding non-zero basis functions
-    int span = findSpan(degree, knots, u);
-    std::vector<T> N = bsplineBasis(degree, span, knots, u);
+    int span = ws.findSpanU(degree, knots, u);
+    bsplineBasis(degree, span, knots, u, ws.basis_u);
 
     // Compute point
     for (unsigned int j = 0; j <= degree; j++)
     {
-        point += static_cast<T>(N[j]) * control_points[span - degree + j];
+        point += ws.basis_u[j] * control_points[span - degree + j];
     }
     return point;
 }
 
 /**
- * Evaluate derivatives of a non-rational NURBS curve
+ * Evaluate point on a nonrational NURBS curve
+ * @param[in] degree Degree of the given curve.
+ * @param[in] knots Knot vector of the curve.
+ * @param[in] control_points Control points of the curve.
+ * @param[in] u Parameter to evaluate the curve at.
+ * @return point Resulting point on the curve at parameter u.
+ */
+template <int dim, typename T>
+glm::vec<dim, T> curvePoint(unsigned int degree, const std::vector<T> &knots,
+                            const std::vector<glm::vec<dim, T>> &control_points, T u)
+{
+    // Dispatch common degrees to the unrolled kernels
+    switch (degree)
+    {
+    case 1:
+        return curvePoint<1>(knots, control_points, u);
+    case 2:
+        return curvePoint<2>(knots, control_points, u);
+    case 3:
+        return curvePoint<3>(knots, control_points, u);
+    case 4:
+        return curvePoint<4>(knots, control_points, u);
+    case 5:
+        return curvePoint<5>(knots, control_points, u);
+    default:
+        break;
+    }
+
+    EvalWorkspace<T> ws;
+    return curvePoint(degree, knots, control_points, u, ws);
+}
+
+/**
+ * Evaluate derivatives of a non-rational NURBS curve using the scratch buffers
+ * of a workspace
  * @param[in] degree Degree of the curve
  * @param[in] knots Knot vector of the curve.
  * @param[in] control_points Control points of the curve.
  * @param[in] num_ders Number of times to derivate.
  * @param[in] u Parameter to evaluate the derivatives at.
- * @return curve_ders Derivatives of the curve at u.
- * E.g. curve_ders[n] is the nth derivative at u, where 0 <= n <= num_ders.
+ * @param[out] curve_ders Array of (num_ders + 1) derivatives of the curve at u.
+ * @param[inout] ws Workspace providing scratch buffers and the span hint.
  */
 template <int dim, typename T>
-std::vector<glm::vec<dim, T>> curveDerivatives(unsigned int degree, const std::vector<T> &knots,
-                                               const std::vector<glm::vec<dim, T>> &control_points,
-                                               int num_ders, T u)
+void curveDerivatives(unsigned int degree, const std::vector<T> &knots,
+                      const std::vector<glm::vec<dim, T>> &control_points, int num_ders, T u,
+                      glm::vec<dim, T> *curve_ders, EvalWorkspace<T> &ws)
 {
-
     typedef glm::vec<dim, T> tvecn;
-    using std::vector;
-
-    std::vector<glm::vec<dim, T>> curve_ders;
-    curve_ders.resize(num_ders + 1);
 
-    // Assign higher order derivatives to zero
-    for (int k = degree + 1; k <= num_ders; k++)
+    // Higher order derivatives stay zero
+    for (int k = 0; k <= num_ders; k++)
     {
         curve_ders[k] = tvecn(0.0);
     }
 
     // Find the span and corresponding non-zero basis functions & derivatives
-    int span = findSpan(degree, knots, u);
-    array2<T> ders = bsplineDerBasis<T>(degree, span, knots, u, num_ders);
+    int span = ws.findSpanU(degree, knots, u);
+    bsplineDerBasis(degree, span, knots, u, num_ders, ws.ders_u, ws.ndu, ws.a);
 
     // Compute first num_ders derivatives
     int du = num_ders < degree ? num_ders : degree;
     for (int k = 0; k <= du; k++)
     {
-        curve_ders[k] = tvecn(0.0);
         for (int j = 0; j <= degree; j++)
         {
-            curve_ders[k] += static_cast<T>(ders(k, j)) * control_points[span - degree + j];
+            curve_ders[k] += ws.ders_u(k, j) * control_points[span - degree + j];
         }
     }
+}
+
+/**
+ * Evaluate derivatives of a non-rational NURBS curve
+ * @param[in] degree Degree of the curve
+ * @param[in] knots Knot vector of the curve.
+ * @param[in] control_points Control points of the curve.
+ * @param[in] num_ders Number of times to derivate.
+ * @param[in] u Parameter to evaluate the derivatives at.
+ * @return curve_ders Derivatives of the curve at u.
+ * E.g. curve_ders[n] is the nth derivative at u, where 0 <= n <= num_ders.
+ */
+template <int dim, typename T>
+std::vector<glm::vec<dim, T>> curveDerivatives(unsigned int degree, const std::vector<T> &knots,
+                                               const std::vector<glm::vec<dim, T>> &control_points,
+                                               int num_ders, T u)
+{
+    EvalWorkspace<T> ws;
+    std::vector<glm::vec<dim, T>> curve_ders(num_ders + 1);
+    curveDerivatives(degree, knots, control_points, num_ders, u, curve_ders.data(), ws);
     return curve_ders;
 }
 
 /**
- * Evaluate point on a nonrational NURBS surface
+ * Evaluate point on a nonrational NURBS surface using the scratch buffers of a
+ * workspace
  * @param[in] degree_u Degree of the given surface in u-direction.
  * @param[in] degree_v Degree of the given surface in v-direction.
  * @param[in] knots_u Knot vector of the surface in u-direction.
@@ -107,39 +186,60 @@ std::vector<glm::vec<dim, T>> curveDerivatives(unsigned int degree, const std::v
  * @param[in] control_points Control points of the surface in a 2d array.
  * @param[in] u Parameter to evaluate the surface at.
  * @param[in] v Parameter to evaluate the surface at.
+ * @param[inout] ws Workspace providing scratch buffers and the span hints.
  * @return point Resulting point on the surface at (u, v).
  */
 template <int dim, typename T>
 glm::vec<dim, T> surfacePoint(unsigned int degree_u, unsigned int degree_v,
                               const std::vector<T> &knots_u, const std::vector<T> &knots_v,
-                              const array2<glm::vec<dim, T>> &control_points, T u, T v)
+                              const array2<glm::vec<dim, T>> &control_points, T u, T v,
+                              EvalWorkspace<T> &ws)
 {
-
     // Initialize result to 0s
     glm::vec<dim, T> point(T(0.0));
 
     // Find span and non-zero basis functions
-    int span_u = findSpan(degree_u, knots_u, u);
-    int span_v = findSpan(degree_v, knots_v, v);
-    std::vector<T> Nu = bsplineBasis(degree_u, span_u, knots_u, u);
-    std::vector<T> Nv = bsplineBasis(degree_v, span_v, knots_v, v);
+    int span_u = ws.findSpanU(degree_u, knots_u, u);
+    int span_v = ws.findSpanV(degree_v, knots_v, v);
+    bsplineBasis(degree_u, span_u, knots_u, u, ws.basis_u);
+    bsplineBasis(degree_v, span_v, knots_v, v, ws.basis_v);
 
     for (int l = 0; l <= degree_v; l++)
     {
         glm::vec<dim, T> temp(0.0);
         for (int k = 0; k <= degree_u; k++)
         {
-            temp += static_cast<T>(Nu[k]) *
-                    control_points(span_u - degree_u + k, span_v - degree_v + l);
+            temp += ws.basis_u[k] * control_points(span_u - degree_u + k, span_v - degree_v + l);
         }
 
-        point += static_cast<T>(Nv[l]) * temp;
+        point += ws.basis_v[l] * temp;
     }
     return point;
 }
 
 /**
- * Evaluate derivatives on a non-rational NURBS surface
+ * Evaluate point on a nonrational NURBS surface
+ * @param[in] degree_u Degree of the given surface in u-direction.
+ * @param[in] degree_v Degree of the given surface in v-direction.
+ * @param[in] knots_u Knot vector of the surface in u-direction.
+ * @param[in] knots_v Knot vector of the surface in v-direction.
+ * @param[in] control_points Control points of the surface in a 2d array.
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @return point Resulting point on the surface at (u, v).
+ */
+template <int dim, typename T>
+glm::vec<dim, T> surfacePoint(unsigned int degree_u, unsigned int degree_v,
+                              const std::vector<T> &knots_u, const std::vector<T> &knots_v,
+                              const array2<glm::vec<dim, T>> &control_points, T u, T v)
+{
+    EvalWorkspace<T> ws;
+    return surfacePoint(degree_u, degree_v, knots_u, knots_v, control_points, u, v, ws);
+}
+
+/**
+ * Evaluate derivatives on a non-rational NURBS surface using the scratch
+ * buffers of a workspace
  * @param[in] degree_u Degree of the given surface in u-direction.
  * @param[in] degree_v Degree of the given surface in v-direction.
  * @param[in] knots_u Knot vector of the surface in u-direction.
@@ -149,218 +249,1766 @@ glm::vec<dim, T> surfacePoint(unsigned int degree_u, unsigned int degree_v,
  * @param[in] u Parameter to evaluate the surface at.
  * @param[in] v Parameter to evaluate the surface at.
  * @param[out] surf_ders Derivatives of the surface at (u, v).
+ * @param[inout] ws Workspace providing scratch buffers and the span hints.
  */
 template <int dim, typename T>
-array2<glm::vec<dim, T>>
-surfaceDerivatives(unsigned int degree_u, unsigned int degree_v, const std::vector<T> &knots_u,
-                   const std::vector<T> &knots_v, const array2<glm::vec<dim, T>> &control_points,
-                   unsigned int num_ders, T u, T v)
+void surfaceDerivatives(unsigned int degree_u, unsigned int degree_v,
+                        const std::vector<T> &knots_u, const std::vector<T> &knots_v,
+                        const array2<glm::vec<dim, T>> &control_points, unsigned int num_ders,
+                        T u, T v, array2<glm::vec<dim, T>> &surf_ders, EvalWorkspace<T> &ws)
 {
+    typedef glm::vec<dim, T> tvecn;
 
-    array2<glm::vec<dim, T>> surf_ders(num_ders + 1, num_ders + 1, glm::vec<dim, T>(0.0));
-
-    // Set higher order derivatives to 0
-    for (int k = degree_u + 1; k <= num_ders; k++)
+    // Higher order derivatives stay zero
+    surf_ders.resize(num_ders + 1, num_ders + 1);
+    for (int k = 0; k <= num_ders; k++)
     {
-        for (int l = degree_v + 1; l <= num_ders; l++)
+        for (int l = 0; l <= num_ders; l++)
         {
-            surf_ders(k, l) = glm::vec<dim, T>(0.0);
+            surf_ders(k, l) = tvecn(0.0);
         }
     }
 
     // Find span and basis function derivatives
-    int span_u = findSpan(degree_u, knots_u, u);
-    int span_v = findSpan(degree_v, knots_v, v);
-    array2<T> ders_u = bsplineDerBasis(degree_u, span_u, knots_u, u, num_ders);
-    array2<T> ders_v = bsplineDerBasis(degree_v, span_v, knots_v, v, num_ders);
+    int span_u = ws.findSpanU(degree_u, knots_u, u);
+    int span_v = ws.findSpanV(degree_v, knots_v, v);
+    bsplineDerBasis(degree_u, span_u, knots_u, u, num_ders, ws.ders_u, ws.ndu, ws.a);
+    bsplineDerBasis(degree_v, span_v, knots_v, v, num_ders, ws.ders_v, ws.ndu, ws.a);
 
     // Number of non-zero derivatives is <= degree
     unsigned int du = std::min(num_ders, degree_u);
     unsigned int dv = std::min(num_ders, degree_v);
 
-    std::vector<glm::vec<dim, T>> temp;
-    temp.resize(degree_v + 1);
     // Compute derivatives
     for (int k = 0; k <= du; k++)
     {
+        int dd = std::min(num_ders - k, dv);
         for (int s = 0; s <= degree_v; s++)
         {
-            temp[s] = glm::vec<dim, T>(0.0);
+            tvecn temp(0.0);
             for (int r = 0; r <= degree_u; r++)
             {
-                temp[s] += static_cast<T>(ders_u(k, r)) *
-                           control_points(span_u - degree_u + r, span_v - degree_v + s);
+                temp += ws.ders_u(k, r) *
+                        control_points(span_u - degree_u + r, span_v - degree_v + s);
             }
-        }
-
-        int dd = std::min(num_ders - k, dv);
 
-        for (int l = 0; l <= dd; l++)
-        {
-            for (int s = 0; s <= degree_v; s++)
+            for (int l = 0; l <= dd; l++)
             {
-                surf_ders(k, l) += ders_v(l, s) * temp[s];
+                surf_ders(k, l) += ws.ders_v(l, s) * temp;
             }
         }
     }
-    return surf_ders;
 }
 
-} // namespace internal
-
-/////////////////////////////////////////////////////////////////////
-
 /**
-Evaluate point on a nonrational NURBS curve
-@param[in] crv Curve object
-@param[in] u Parameter to evaluate the curve at.
-@return point Resulting point on the curve at parameter u.
-*/
-template <typename T> glm::vec<3, T> curvePoint(const Curve<T> &crv, T u)
+ * Evaluate derivatives on a non-rational NURBS surface
+ * @param[in] degree_u Degree of the given surface in u-direction.
+ * @param[in] degree_v Degree of the given surface in v-direction.
+ * @param[in] knots_u Knot vector of the surface in u-direction.
+ * @param[in] knots_v Knot vector of the surface in v-direction.
+ * @param[in] control_points Control points of the surface in a 2D array.
+ * @param[in] num_ders Number of times to differentiate
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @return surf_ders Derivatives of the surface at (u, v).
+ */
+template <int dim, typename T>
+array2<glm::vec<dim, T>>
+surfaceDerivatives(unsigned int degree_u, unsigned int degree_v, const std::vector<T> &knots_u,
+                   const std::vector<T> &knots_v, const array2<glm::vec<dim, T>> &control_points,
+                   unsigned int num_ders, T u, T v)
 {
-    return internal::curvePoint(crv.degree, crv.knots, crv.control_points, u);
+    EvalWorkspace<T> ws;
+    array2<glm::vec<dim, T>> surf_ders;
+    surfaceDerivatives(degree_u, degree_v, knots_u, knots_v, control_points, num_ders, u, v,
+                       surf_ders, ws);
+    return surf_ders;
 }
 
 /**
- * Evaluate point on a rational NURBS curve
- * @param[in] crv RationalCurve object
+ * Evaluate point on a rational NURBS curve in homogenous coordinates using the
+ * scratch buffers of a workspace. Only the (degree + 1) control points in the
+ * support of u are weighted.
+ * @param[in] degree Degree of the given curve.
+ * @param[in] knots Knot vector of the curve.
+ * @param[in] control_points Control points of the curve.
+ * @param[in] weights Weights corresponding to each control point.
  * @param[in] u Parameter to evaluate the curve at.
- * @return point Resulting point on the curve.
+ * @param[inout] ws Workspace providing scratch buffers and the span hint.
+ * @return point Resulting point on the curve at parameter u in homogenous coordinates.
  */
-template <typename T> glm::vec<3, T> curvePoint(const RationalCurve<T> &crv, T u)
+template <int dim, typename T>
+glm::vec<dim + 1, T> curvePoint(unsigned int degree, const std::vector<T> &knots,
+                                const std::vector<glm::vec<dim, T>> &control_points,
+                                const std::vector<T> &weights, T u, EvalWorkspace<T> &ws)
 {
+    // Initialize result to 0s
+    glm::vec<dim + 1, T> pointw(T(0));
 
-    typedef glm::vec<4, T> tvecnp1;
+    // Find span and corresponding non-zero basis functions
+    int span = ws.findSpanU(degree, knots, u);
+    bsplineBasis(degree, span, knots, u, ws.basis_u);
 
-    // Compute homogenous coordinates of control points
-    std::vector<tvecnp1> Cw;
-    Cw.reserve(crv.control_points.size());
-    for (int i = 0; i < crv.control_points.size(); i++)
+    // Compute point
+    for (unsigned int j = 0; j <= degree; j++)
     {
-        Cw.push_back(tvecnp1(util::cartesianToHomogenous(crv.control_points[i], crv.weights[i])));
+        int i = span - degree + j;
+        pointw += ws.basis_u[j] * util::cartesianToHomogenous(control_points[i], weights[i]);
     }
-
-    // Compute point using homogenous coordinates
-    tvecnp1 pointw = internal::curvePoint(crv.degree, crv.knots, Cw, u);
-
-    // Convert back to cartesian coordinates
-    return util::homogenousToCartesian(pointw);
+    return pointw;
 }
 
 /**
- * Evaluate derivatives of a non-rational NURBS curve
- * @param[in] crv Curve object
- * @param[in] num_ders Number of times to derivate.
- * @param[in] u Parameter to evaluate the derivatives at.
- * @return curve_ders Derivatives of the curve at u.
- * E.g. curve_ders[n] is the nth derivative at u, where 0 <= n <= num_ders.
+ * Evaluate point on a rational NURBS curve in homogenous coordinates. Only the
+ * (degree + 1) control points in the support of u are weighted.
+ * @param[in] degree Degree of the given curve.
+ * @param[in] knots Knot vector of the curve.
+ * @param[in] control_points Control points of the curve.
+ * @param[in] weights Weights corresponding to each control point.
+ * @param[in] u Parameter to evaluate the curve at.
+ * @return point Resulting point on the curve at parameter u in homogenous coordinates.
  */
-template <typename T>
-std::vector<glm::vec<3, T>> curveDerivatives(const Curve<T> &crv, int num_ders, T u)
+template <int dim, typename T>
+glm::vec<dim + 1, T> curvePoint(unsigned int degree, const std::vector<T> &knots,
+                                const std::vector<glm::vec<dim, T>> &control_points,
+                                const std::vector<T> &weights, T u)
 {
-    return internal::curveDerivatives(crv.degree, crv.knots, crv.control_points, num_ders, u);
+    EvalWorkspace<T> ws;
+    return curvePoint(degree, knots, control_points, weights, u, ws);
 }
 
 /**
- * Evaluate derivatives of a rational NURBS curve
- * @param[in] u Parameter to evaluate the derivatives at.
- * @param[in] knots Knot vector of the curve.
- * @param[in] control_points Control points of the curve.
- * @param[in] weights Weights corresponding to each control point.
- * @param[in] num_ders Number of times to differentiate.
- * @param[inout] curve_ders Derivatives of the curve at u.
- * E.g. curve_ders[n] is the nth derivative at u, where n is between 0 and
- * num_ders-1.
+ * Apply the quotient rule to the derivatives of a rational curve in place
+ * @param[in] wders Derivatives of the weight function.
+ * @param[in] bin Table of binomial coefficients covering num_ders.
+ * @param[in] num_ders Number of derivatives.
+ * @param[inout] curve_ders Derivatives of the weighted curve on input, and of
+ * the rational curve in cartesian coordinates on output.
  */
-template <typename T>
-std::vector<glm::vec<3, T>> curveDerivatives(const RationalCurve<T> &crv, int num_ders, T u)
+template <int dim, typename T>
+void curveQuotientRule(const T *wders, const array2<T> &bin, int num_ders,
+                       glm::vec<dim, T> *curve_ders)
 {
-
-    typedef glm::vec<3, T> tvecn;
-    typedef glm::vec<4, T> tvecnp1;
-
-    std::vector<tvecn> curve_ders;
-    curve_ders.reserve(num_ders + 1);
-
-    // Compute homogenous coordinates of control points
-    std::vector<tvecnp1> Cw;
-    Cw.reserve(crv.control_points.size());
-    for (int i = 0; i < crv.control_points.size(); i++)
-    {
-        Cw.push_back(util::cartesianToHomogenous(crv.control_points[i], crv.weights[i]));
-    }
-
-    // Derivatives of Cw
-    std::vector<tvecnp1> Cwders =
-        internal::curveDerivatives(crv.degree, crv.knots, Cw, num_ders, u);
-
-    // Split Cwders into coordinates and weights
-    std::vector<tvecn> Aders;
-    std::vector<T> wders;
-    for (const auto &val : Cwders)
-    {
-        Aders.push_back(util::truncateHomogenous(val));
-        wders.push_back(val.w);
-    }
-
-    // Compute rational derivatives
     for (int k = 0; k <= num_ders; k++)
     {
-        tvecn v = Aders[k];
+        glm::vec<dim, T> v = curve_ders[k];
         for (int i = 1; i <= k; i++)
         {
-            v -= static_cast<T>(util::binomial(k, i)) * wders[i] * curve_ders[k - i];
+            v -= bin(k, i) * wders[i] * curve_ders[k - i];
         }
-        curve_ders.push_back(v / wders[0]);
+        curve_ders[k] = v / wders[0];
     }
-    return curve_ders;
 }
 
 /**
- * Evaluate the tangent of a B-spline curve
- * @param[in] crv Curve object
- * @return Unit tangent of the curve at u.
+ * Apply the quotient rule to the derivatives of a rational surface in place
+ * @param[in] wders Derivatives of the weight function.
+ * @param[in] bin Table of binomial coefficients covering the number of derivatives.
+ * @param[inout] surf_ders Derivatives of the weighted surface on input, and of
+ * the rational surface in cartesian coordinates on output.
  */
-template <typename T> glm::vec<3, T> curveTangent(const Curve<T> &crv, T u)
+template <int dim, typename T>
+void surfaceQuotientRule(const array2<T> &wders, const array2<T> &bin,
+                         array2<glm::vec<dim, T>> &surf_ders)
 {
-    std::vector<glm::vec<3, T>> ders = curveDerivatives(crv, 1, u);
-    glm::vec<3, T> du = ders[1];
-    T du_len = glm::length(du);
-    if (!util::close(du_len, T(0)))
+    typedef glm::vec<dim, T> tvecn;
+
+    int num_ders = static_cast<int>(surf_ders.rows()) - 1;
+    for (int k = 0; k < num_ders + 1; ++k)
     {
-        du /= du_len;
+        for (int l = 0; l < num_ders - k + 1; ++l)
+        {
+            tvecn der = surf_ders(k, l);
+
+            for (int j = 1; j < l + 1; ++j)
+            {
+                der -= bin(l, j) * wders(0, j) * surf_ders(k, l - j);
+            }
+
+            for (int i = 1; i < k + 1; ++i)
+            {
+                der -= bin(k, i) * wders(i, 0) * surf_ders(k - i, l);
+
+                tvecn tmp((T)0.0);
+                for (int j = 1; j < l + 1; ++j)
+                {
+                    tmp += bin(l, j) * wders(i, j) * surf_ders(k - i, l - j);
+                }
+
+                der -= bin(k, i) * tmp;
+            }
+
+            surf_ders(k, l) = der / wders(0, 0);
+        }
     }
-    return du;
 }
 
 /**
- * Evaluate the tangent of a rational B-spline curve
- * @param[in] crv RationalCurve object
- * @return Unit tangent of the curve at u.
+ * Evaluate derivatives of a rational NURBS curve using the scratch buffers of a
+ * workspace. Only the (degree + 1) control points in the support of u are
+ * weighted.
+ * @param[in] degree Degree of the curve
+ * @param[in] knots Knot vector of the curve.
+ * @param[in] control_points Control points of the curve.
+ * @param[in] weights Weights corresponding to each control point.
+ * @param[in] num_ders Number of times to derivate.
+ * @param[in] u Parameter to evaluate the derivatives at.
+ * @param[out] curve_ders Array of (num_ders + 1) derivatives of the curve at u in
+ * cartesian coordinates.
+ * @param[inout] ws Workspace providing scratch buffers and the span hint.
  */
-template <typename T> glm::vec<3, T> curveTangent(const RationalCurve<T> &crv, T u)
+template <int dim, typename T>
+void curveDerivatives(unsigned int degree, const std::vector<T> &knots,
+                      const std::vector<glm::vec<dim, T>> &control_points,
+                      const std::vector<T> &weights, int num_ders, T u,
+                      glm::vec<dim, T> *curve_ders, EvalWorkspace<T> &ws)
 {
-    std::vector<glm::vec<3, T>> ders = curveDerivatives(crv, 1, u);
-    glm::vec<3, T> du = ders[1];
-    T du_len = glm::length(du);
-    if (!util::close(du_len, T(0)))
+    typedef glm::vec<dim, T> tvecn;
+
+    // Higher order derivatives stay zero
+    ws.curve_wders.resize(num_ders + 1);
+    for (int k = 0; k <= num_ders; k++)
     {
-        du /= du_len;
+        curve_ders[k] = tvecn(0.0);
+        ws.curve_wders[k] = T(0);
     }
-    return du;
+
+    // Find the span and corresponding non-zero basis functions & derivatives
+    int span = ws.findSpanU(degree, knots, u);
+    bsplineDerBasis(degree, span, knots, u, num_ders, ws.ders_u, ws.ndu, ws.a);
+
+    // Derivatives of the weighted curve and of the weight function
+    int du = num_ders < degree ? num_ders : degree;
+    for (int k = 0; k <= du; k++)
+    {
+        for (int j = 0; j <= degree; j++)
+        {
+            int i = span - degree + j;
+            T Nw = ws.ders_u(k, j) * weights[i];
+            curve_ders[k] += Nw * control_points[i];
+            ws.curve_wders[k] += Nw;
+        }
+    }
+
+    curveQuotientRule(ws.curve_wders.data(), ws.binomials(num_ders), num_ders, curve_ders);
 }
 
 /**
- * Evaluate point on a nonrational NURBS surface
- * @param[in] srf Surface object
+ * Evaluate point on a rational NURBS surface in homogenous coordinates using
+ * the scratch buffers of a workspace. Only the (degree_u + 1) x (degree_v + 1)
+ * control points in the support of (u, v) are weighted.
+ * @param[in] degree_u Degree of the given surface in u-direction.
+ * @param[in] degree_v Degree of the given surface in v-direction.
+ * @param[in] knots_u Knot vector of the surface in u-direction.
+ * @param[in] knots_v Knot vector of the surface in v-direction.
+ * @param[in] control_points Control points of the surface in a 2d array.
+ * @param[in] weights Weights corresponding to the control points.
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @param[inout] ws Workspace providing scratch buffers and the span hints.
+ * @return point Resulting point on the surface at (u, v) in homogenous coordinates.
+ */
+template <int dim, typename T>
+glm::vec<dim + 1, T> surfacePoint(unsigned int degree_u, unsigned int degree_v,
+                                  const std::vector<T> &knots_u, const std::vector<T> &knots_v,
+                                  const array2<glm::vec<dim, T>> &control_points,
+                                  const array2<T> &weights, T u, T v, EvalWorkspace<T> &ws)
+{
+    typedef glm::vec<dim + 1, T> tvecnp1;
+
+    // Initialize result to 0s
+    tvecnp1 pointw(T(0.0));
+
+    // Find span and non-zero basis functions
+    int span_u = ws.findSpanU(degree_u, knots_u, u);
+    int span_v = ws.findSpanV(degree_v, knots_v, v);
+    bsplineBasis(degree_u, span_u, knots_u, u, ws.basis_u);
+    bsplineBasis(degree_v, span_v, knots_v, v, ws.basis_v);
+
+    for (int l = 0; l <= degree_v; l++)
+    {
+        int j = span_v - degree_v + l;
+        tvecnp1 temp(0.0);
+        for (int k = 0; k <= degree_u; k++)
+        {
+            int i = span_u - degree_u + k;
+            temp += ws.basis_u[k] *
+                    util::cartesianToHomogenous(control_points(i, j), weights(i, j));
+        }
+
+        pointw += ws.basis_v[l] * temp;
+    }
+    return pointw;
+}
+
+/**
+ * Evaluate point on a rational NURBS surface in homogenous coordinates. Only the
+ * (degree_u + 1) x (degree_v + 1) control points in the support of (u, v) are
+ * weighted.
+ * @param[in] degree_u Degree of the given surface in u-direction.
+ * @param[in] degree_v Degree of the given surface in v-direction.
+ * @param[in] knots_u Knot vector of the surface in u-direction.
+ * @param[in] knots_v Knot vector of the surface in v-direction.
+ * @param[in] control_points Control points of the surface in a 2d array.
+ * @param[in] weights Weights corresponding to the control points.
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @return point Resulting point on the surface at (u, v) in homogenous coordinates.
+ */
+template <int dim, typename T>
+glm::vec<dim + 1, T> surfacePoint(unsigned int degree_u, unsigned int degree_v,
+                                  const std::vector<T> &knots_u, const std::vector<T> &knots_v,
+                                  const array2<glm::vec<dim, T>> &control_points,
+                                  const array2<T> &weights, T u, T v)
+{
+    EvalWorkspace<T> ws;
+    return surfacePoint(degree_u, degree_v, knots_u, knots_v, control_points, weights, u, v, ws);
+}
+
+/**
+ * Evaluate derivatives on a rational NURBS surface using the scratch buffers of
+ * a workspace. Only the (degree_u + 1) x (degree_v + 1) control points in the
+ * support of (u, v) are weighted.
+ * @param[in] degree_u Degree of the given surface in u-direction.
+ * @param[in] degree_v Degree of the given surface in v-direction.
+ * @param[in] knots_u Knot vector of the surface in u-direction.
+ * @param[in] knots_v Knot vector of the surface in v-direction.
+ * @param[in] control_points Control points of the surface in a 2D array.
+ * @param[in] weights Weights corresponding to the control points.
+ * @param[in] num_ders Number of times to differentiate
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @param[out] surf_ders Derivatives of the surface at (u, v) in cartesian coordinates.
+ * @param[inout] ws Workspace providing scratch buffers and the span hints.
+ */
+template <int dim, typename T>
+void surfaceDerivatives(unsigned int degree_u, unsigned int degree_v,
+                        const std::vector<T> &knots_u, const std::vector<T> &knots_v,
+                        const array2<glm::vec<dim, T>> &control_points, const array2<T> &weights,
+                        unsigned int num_ders, T u, T v, array2<glm::vec<dim, T>> &surf_ders,
+                        EvalWorkspace<T> &ws)
+{
+    typedef glm::vec<dim, T> tvecn;
+
+    // Higher order derivatives stay zero
+    surf_ders.resize(num_ders + 1, num_ders + 1);
+    ws.surf_wders.resize(num_ders + 1, num_ders + 1);
+    for (int k = 0; k <= num_ders; k++)
+    {
+        for (int l = 0; l <= num_ders; l++)
+        {
+            surf_ders(k, l) = tvecn(0.0);
+            ws.surf_wders(k, l) = T(0);
+        }
+    }
+
+    // Find span and basis function derivatives
+    int span_u = ws.findSpanU(degree_u, knots_u, u);
+    int span_v = ws.findSpanV(degree_v, knots_v, v);
+    bsplineDerBasis(degree_u, span_u, knots_u, u, num_ders, ws.ders_u, ws.ndu, ws.a);
+    bsplineDerBasis(degree_v, span_v, knots_v, v, num_ders, ws.ders_v, ws.ndu, ws.a);
+
+    // Number of non-zero derivatives is <= degree
+    unsigned int du = std::min(num_ders, degree_u);
+    unsigned int dv = std::min(num_ders, degree_v);
+
+    // Derivatives of the weighted surface and of the weight function
+    for (int k = 0; k <= du; k++)
+    {
+        int dd = std::min(num_ders - k, dv);
+        for (int s = 0; s <= degree_v; s++)
+        {
+            int j = span_v - degree_v + s;
+            tvecn temp(0.0);
+            T tempw = 0;
+            for (int r = 0; r <= degree_u; r++)
+            {
+                int i = span_u - degree_u + r;
+                T Nw = ws.ders_u(k, r) * weights(i, j);
+                temp += Nw * control_points(i, j);
+                tempw += Nw;
+            }
+
+            for (int l = 0; l <= dd; l++)
+            {
+                surf_ders(k, l) += ws.ders_v(l, s) * temp;
+                ws.surf_wders(k, l) += ws.ders_v(l, s) * tempw;
+            }
+        }
+    }
+
+    surfaceQuotientRule(ws.surf_wders, ws.binomials(num_ders), surf_ders);
+}
+
+/**
+ * Compute the derivatives of a rational curve from the derivatives of its
+ * homogenous counterpart using the quotient rule
+ * @param[in] Cwders Derivatives of the curve in homogenous coordinates.
+ * @param[out] curve_ders Derivatives of the curve in cartesian coordinates.
+ * @param[inout] ws Workspace providing scratch buffers and binomial coefficients.
+ */
+template <int dim, typename T>
+void rationalCurveDerivatives(const std::vector<glm::vec<dim, T>> &Cwders,
+                              std::vector<glm::vec<dim - 1, T>> &curve_ders, EvalWorkspace<T> &ws)
+{
+    int num_ders = static_cast<int>(Cwders.size()) - 1;
+    curve_ders.resize(num_ders + 1);
+    ws.curve_wders.resize(num_ders + 1);
+    for (int k = 0; k <= num_ders; k++)
+    {
+        curve_ders[k] = util::truncateHomogenous(Cwders[k]);
+        ws.curve_wders[k] = Cwders[k][dim - 1];
+    }
+    curveQuotientRule(ws.curve_wders.data(), ws.binomials(num_ders), num_ders, curve_ders.data());
+}
+
+/**
+ * Compute the derivatives of a rational curve from the derivatives of its
+ * homogenous counterpart using the quotient rule
+ * @param[in] Cwders Derivatives of the curve in homogenous coordinates.
+ * @return curve_ders Derivatives of the curve in cartesian coordinates.
+ */
+template <int dim, typename T>
+std::vector<glm::vec<dim - 1, T>>
+rationalCurveDerivatives(const std::vector<glm::vec<dim, T>> &Cwders)
+{
+    EvalWorkspace<T> ws;
+    std::vector<glm::vec<dim - 1, T>> curve_ders;
+    rationalCurveDerivatives(Cwders, curve_ders, ws);
+    return curve_ders;
+}
+
+/**
+ * Compute the derivatives of a rational surface from the derivatives of its
+ * homogenous counterpart using the quotient rule
+ * @param[in] homo_ders Derivatives of the surface in homogenous coordinates.
+ * @param[out] surf_ders Derivatives of the surface in cartesian coordinates.
+ * @param[inout] ws Workspace providing scratch buffers and binomial coefficients.
+ */
+template <int dim, typename T>
+void rationalSurfaceDerivatives(const array2<glm::vec<dim, T>> &homo_ders,
+                                array2<glm::vec<dim - 1, T>> &surf_ders, EvalWorkspace<T> &ws)
+{
+    int num_ders = static_cast<int>(homo_ders.rows()) - 1;
+    surf_ders.resize(num_ders + 1, num_ders + 1);
+    ws.surf_wders.resize(num_ders + 1, num_ders + 1);
+    for (int k = 0; k <= num_ders; k++)
+    {
+        for (int l = 0; l <= num_ders; l++)
+        {
+            surf_ders(k, l) = util::truncateHomogenous(homo_ders(k, l));
+            ws.surf_wders(k, l) = homo_ders(k, l)[dim - 1];
+        }
+    }
+    surfaceQuotientRule(ws.surf_wders, ws.binomials(num_ders), surf_ders);
+}
+
+/**
+ * Compute the derivatives of a rational surface from the derivatives of its
+ * homogenous counterpart using the quotient rule
+ * @param[in] homo_ders Derivatives of the surface in homogenous coordinates.
+ * @return surf_ders Derivatives of the surface in cartesian coordinates.
+ */
+template <int dim, typename T>
+array2<glm::vec<dim - 1, T>> rationalSurfaceDerivatives(const array2<glm::vec<dim, T>> &homo_ders)
+{
+    EvalWorkspace<T> ws;
+    array2<glm::vec<dim - 1, T>> surf_ders;
+    rationalSurfaceDerivatives(homo_ders, surf_ders, ws);
+    return surf_ders;
+}
+
+/**
+ * Find the spans and non-zero basis functions of a block of simdLanes<T>()
+ * consecutive parameters. Lanes past the end of params repeat the last
+ * parameter.
+ * @param[in] degree Degree of the basis functions.
+ * @param[in] knots Knot vector of the basis functions.
+ * @param[in] params Parameters to evaluate the basis functions at.
+ * @param[in] first Index of the first parameter of the block.
+ * @param[out] spans Span of each lane.
+ * @param[inout] ws Workspace providing the span hint. On return ws.lane_basis
+ * holds the basis functions laid out as described in bsplineBasisLanes().
+ * @return Number of lanes holding parameters of the block.
+ */
+template <typename T>
+size_t basisBlock(unsigned int degree, const std::vector<T> &knots, const std::vector<T> &params,
+                  size_t first, int *spans, EvalWorkspace<T> &ws)
+{
+    constexpr unsigned int lanes = simdLanes<T>();
+    size_t count = std::min<size_t>(lanes, params.size() - first);
+
+    std::array<T, lanes> u;
+    for (unsigned int l = 0; l < lanes; l++)
+    {
+        u[l] = params[first + std::min<size_t>(l, count - 1)];
+        spans[l] = ws.findSpanU(degree, knots, u[l]);
+    }
+
+    ws.lane_basis.resize((degree + 1) * lanes);
+    bsplineBasisLanes<lanes>(degree, spans, knots, u.data(), ws.lane_basis.data());
+    return count;
+}
+
+/**
+ * Evaluate points on a non-rational NURBS curve at many parameters. Spans are
+ * found by walking forward from the previous parameter, so sorted parameters
+ * are evaluated in a single pass over the knot vector. Basis functions are
+ * computed for simdLanes<T>() parameters at a time.
+ * @param[in] degree Degree of the given curve.
+ * @param[in] knots Knot vector of the curve.
+ * @param[in] control_points Control points of the curve.
+ * @param[in] params Parameters to evaluate the curve at.
+ * @param[out] points Resulting points on the curve, one per parameter.
+ * @param[inout] ws Workspace providing scratch buffers and the span hint.
+ */
+template <int dim, typename T>
+void curvePoints(unsigned int degree, const std::vector<T> &knots,
+                 const std::vector<glm::vec<dim, T>> &control_points,
+                 const std::vector<T> &params, std::vector<glm::vec<dim, T>> &points,
+                 EvalWorkspace<T> &ws)
+{
+    constexpr unsigned int lanes = simdLanes<T>();
+    std::array<int, lanes> spans;
+
+    points.resize(params.size());
+    for (size_t first = 0; first < params.size(); first += lanes)
+    {
+        size_t count = basisBlock(degree, knots, params, first, spans.data(), ws);
+        for (size_t l = 0; l < count; l++)
+        {
+            glm::vec<dim, T> point(T(0));
+            for (unsigned int j = 0; j <= degree; j++)
+            {
+                point += ws.lane_basis[j * lanes + l] * control_points[spans[l] - degree + j];
+            }
+            points[first + l] = point;
+        }
+    }
+}
+
+/**
+ * Evaluate points on a rational NURBS curve at many parameters. Spans are found
+ * by walking forward from the previous parameter, so sorted parameters are
+ * evaluated in a single pass over the knot vector. Basis functions are computed
+ * for simdLanes<T>() parameters at a time.
+ * @param[in] degree Degree of the given curve.
+ * @param[in] knots Knot vector of the curve.
+ * @param[in] control_points Control points of the curve.
+ * @param[in] weights Weights corresponding to each control point.
+ * @param[in] params Parameters to evaluate the curve at.
+ * @param[out] points Resulting points on the curve in cartesian coordinates.
+ * @param[inout] ws Workspace providing scratch buffers and the span hint.
+ */
+template <int dim, typename T>
+void curvePoints(unsigned int degree, const std::vector<T> &knots,
+                 const std::vector<glm::vec<dim, T>> &control_points,
+                 const std::vector<T> &weights, const std::vector<T> &params,
+                 std::vector<glm::vec<dim, T>> &points, EvalWorkspace<T> &ws)
+{
+    constexpr unsigned int lanes = simdLanes<T>();
+    std::array<int, lanes> spans;
+
+    points.resize(params.size());
+    for (size_t first = 0; first < params.size(); first += lanes)
+    {
+        size_t count = basisBlock(degree, knots, params, first, spans.data(), ws);
+        for (size_t l = 0; l < count; l++)
+        {
+            glm::vec<dim + 1, T> pointw(T(0));
+            for (unsigned int j = 0; j <= degree; j++)
+            {
+                int i = spans[l] - degree + j;
+                pointw += ws.lane_basis[j * lanes + l] *
+                          util::cartesianToHomogenous(control_points[i], weights[i]);
+            }
+            points[first + l] = util::homogenousToCartesian(pointw);
+        }
+    }
+}
+
+/**
+ * Evaluate derivatives of a non-rational NURBS curve at many parameters. Spans
+ * are found by walking forward from the previous parameter.
+ * @param[in] degree Degree of the curve
+ * @param[in] knots Knot vector of the curve.
+ * @param[in] control_points Control points of the curve.
+ * @param[in] num_ders Number of times to derivate.
+ * @param[in] params Parameters to evaluate the derivatives at.
+ * @param[out] curve_ders Derivatives of the curve, where curve_ders(i, k) is the
+ * kth derivative at params[i].
+ * @param[inout] ws Workspace providing scratch buffers and the span hint.
+ */
+template <int dim, typename T>
+void curveDerivativesBatch(unsigned int degree, const std::vector<T> &knots,
+                           const std::vector<glm::vec<dim, T>> &control_points, int num_ders,
+                           const std::vector<T> &params, array2<glm::vec<dim, T>> &curve_ders,
+                           EvalWorkspace<T> &ws)
+{
+    curve_ders.resize(params.size(), num_ders + 1);
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        curveDerivatives(degree, knots, control_points, num_ders, params[i], &curve_ders(i, 0),
+                         ws);
+    }
+}
+
+/**
+ * Evaluate derivatives of a rational NURBS curve at many parameters. Spans are
+ * found by walking forward from the previous parameter.
+ * @param[in] degree Degree of the curve
+ * @param[in] knots Knot vector of the curve.
+ * @param[in] control_points Control points of the curve.
+ * @param[in] weights Weights corresponding to each control point.
+ * @param[in] num_ders Number of times to derivate.
+ * @param[in] params Parameters to evaluate the derivatives at.
+ * @param[out] curve_ders Derivatives of the curve in cartesian coordinates, where
+ * curve_ders(i, k) is the kth derivative at params[i].
+ * @param[inout] ws Workspace providing scratch buffers and the span hint.
+ */
+template <int dim, typename T>
+void curveDerivativesBatch(unsigned int degree, const std::vector<T> &knots,
+                           const std::vector<glm::vec<dim, T>> &control_points,
+                           const std::vector<T> &weights, int num_ders,
+                           const std::vector<T> &params, array2<glm::vec<dim, T>> &curve_ders,
+                           EvalWorkspace<T> &ws)
+{
+    curve_ders.resize(params.size(), num_ders + 1);
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        curveDerivatives(degree, knots, control_points, weights, num_ders, params[i],
+                         &curve_ders(i, 0), ws);
+    }
+}
+
+/**
+ * Compute the spans and non-zero basis functions for many parameters along one
+ * direction of a surface
+ * @param[in] degree Degree of the basis functions.
+ * @param[in] knots Knot vector of the basis functions.
+ * @param[in] params Parameters to evaluate the basis functions at.
+ * @param[out] spans Span of each parameter.
+ * @param[out] basis Non-zero basis functions, where basis(i, j) belongs to params[i].
+ */
+template <typename T>
+void basisRows(unsigned int degree, const std::vector<T> &knots, const std::vector<T> &params,
+               std::vector<int> &spans, array2<T> &basis)
+{
+    constexpr unsigned int lanes = simdLanes<T>();
+    std::array<int, lanes> block_spans;
+    EvalWorkspace<T> ws;
+
+    spans.resize(params.size());
+    basis.resize(params.size(), degree + 1);
+    for (size_t first = 0; first < params.size(); first += lanes)
+    {
+        size_t count = basisBlock(degree, knots, params, first, block_spans.data(), ws);
+        for (size_t l = 0; l < count; ++l)
+        {
+            spans[first + l] = block_spans[l];
+            for (unsigned int j = 0; j <= degree; ++j)
+            {
+                basis(first + l, j) = ws.lane_basis[j * lanes + l];
+            }
+        }
+    }
+}
+
+/**
+ * Evaluate points on a non-rational NURBS surface over the tensor-product grid
+ * of the given parameters. The basis functions are computed once per u and once
+ * per v, and the control points are contracted along u once per grid row.
+ * @param[in] degree_u Degree of the given surface in u-direction.
+ * @param[in] degree_v Degree of the given surface in v-direction.
+ * @param[in] knots_u Knot vector of the surface in u-direction.
+ * @param[in] knots_v Knot vector of the surface in v-direction.
+ * @param[in] control_points Control points of the surface in a 2d array.
+ * @param[in] us Parameters along u-direction.
+ * @param[in] vs Parameters along v-direction.
+ * @param[out] points Resulting points, where points(i, j) is the point at (us[i], vs[j]).
+ */
+template <int dim, typename T>
+void surfaceGrid(unsigned int degree_u, unsigned int degree_v, const std::vector<T> &knots_u,
+                 const std::vector<T> &knots_v, const array2<glm::vec<dim, T>> &control_points,
+                 const std::vector<T> &us, const std::vector<T> &vs,
+                 array2<glm::vec<dim, T>> &points)
+{
+    typedef glm::vec<dim, T> tvecn;
+
+    points.resize(us.size(), vs.size());
+
+    std::vector<int> spans_u, spans_v;
+    array2<T> Nu, Nv;
+    basisRows(degree_u, knots_u, us, spans_u, Nu);
+    basisRows(degree_v, knots_v, vs, spans_v, Nv);
+
+    // Control points contracted along u for the current row
+    std::vector<tvecn> temp(control_points.cols());
+
+    for (size_t i = 0; i < us.size(); ++i)
+    {
+        int row0 = spans_u[i] - degree_u;
+        for (size_t c = 0; c < control_points.cols(); ++c)
+        {
+            tvecn sum(0.0);
+            for (int k = 0; k <= degree_u; k++)
+            {
+                sum += Nu(i, k) * control_points(row0 + k, c);
+            }
+            temp[c] = sum;
+        }
+
+        for (size_t j = 0; j < vs.size(); ++j)
+        {
+            int col0 = spans_v[j] - degree_v;
+            tvecn point(0.0);
+            for (int l = 0; l <= degree_v; l++)
+            {
+                point += Nv(j, l) * temp[col0 + l];
+            }
+            points(i, j) = point;
+        }
+    }
+}
+
+/**
+ * Evaluate points on a rational NURBS surface over the tensor-product grid of
+ * the given parameters. The basis functions are computed once per u and once
+ * per v, and the weighted control points are contracted along u once per grid
+ * row.
+ * @param[in] degree_u Degree of the given surface in u-direction.
+ * @param[in] degree_v Degree of the given surface in v-direction.
+ * @param[in] knots_u Knot vector of the surface in u-direction.
+ * @param[in] knots_v Knot vector of the surface in v-direction.
+ * @param[in] control_points Control points of the surface in a 2d array.
+ * @param[in] weights Weights corresponding to the control points.
+ * @param[in] us Parameters along u-direction.
+ * @param[in] vs Parameters along v-direction.
+ * @param[out] points Resulting points in cartesian coordinates, where
+ * points(i, j) is the point at (us[i], vs[j]).
+ */
+template <int dim, typename T>
+void surfaceGrid(unsigned int degree_u, unsigned int degree_v, const std::vector<T> &knots_u,
+                 const std::vector<T> &knots_v, const array2<glm::vec<dim, T>> &control_points,
+                 const array2<T> &weights, const std::vector<T> &us, const std::vector<T> &vs,
+                 array2<glm::vec<dim, T>> &points)
+{
+    typedef glm::vec<dim + 1, T> tvecnp1;
+
+    points.resize(us.size(), vs.size());
+
+    std::vector<int> spans_u, spans_v;
+    array2<T> Nu, Nv;
+    basisRows(degree_u, knots_u, us, spans_u, Nu);
+    basisRows(degree_v, knots_v, vs, spans_v, Nv);
+
+    // Homogenous control points contracted along u for the current row
+    std::vector<tvecnp1> temp(control_points.cols());
+
+    for (size_t i = 0; i < us.size(); ++i)
+    {
+        int row0 = spans_u[i] - degree_u;
+        for (size_t c = 0; c < control_points.cols(); ++c)
+        {
+            tvecnp1 sum(0.0);
+            for (int k = 0; k <= degree_u; k++)
+            {
+                sum += Nu(i, k) * util::cartesianToHomogenous(control_points(row0 + k, c),
+                                                              weights(row0 + k, c));
+            }
+            temp[c] = sum;
+        }
+
+        for (size_t j = 0; j < vs.size(); ++j)
+        {
+            int col0 = spans_v[j] - degree_v;
+            tvecnp1 pointw(0.0);
+            for (int l = 0; l <= degree_v; l++)
+            {
+                pointw += Nv(j, l) * temp[col0 + l];
+            }
+            points(i, j) = util::homogenousToCartesian(pointw);
+        }
+    }
+}
+
+/**
+ * Compute the unit tangents and unit normal of a surface from its first
+ * derivatives. Tangents and normal of zero length are returned unnormalized.
+ * @param[in] point Point on the surface.
+ * @param[in] der_u First derivative along u.
+ * @param[in] der_v First derivative along v.
+ * @param[out] frame_point Point on the surface.
+ * @param[out] tangent_u Unit tangent along u.
+ * @param[out] tangent_v Unit tangent along v.
+ * @param[out] normal Unit normal.
+ */
+template <typename T>
+void surfaceFrameFromDerivatives(const glm::vec<3, T> &point, const glm::vec<3, T> &der_u,
+                                 const glm::vec<3, T> &der_v, glm::vec<3, T> &frame_point,
+                                 glm::vec<3, T> &tangent_u, glm::vec<3, T> &tangent_v,
+                                 glm::vec<3, T> &normal)
+{
+    frame_point = point;
+    tangent_u = der_u;
+    tangent_v = der_v;
+    normal = glm::cross(der_v, der_u);
+    T du_len = glm::length(der_u);
+    T dv_len = glm::length(der_v);
+    T n_len = glm::length(normal);
+    if (!util::close(du_len, T(0)))
+    {
+        tangent_u /= du_len;
+    }
+    if (!util::close(dv_len, T(0)))
+    {
+        tangent_v /= dv_len;
+    }
+    if (!util::close(n_len, T(0)))
+    {
+        normal /= n_len;
+    }
+}
+
+/**
+ * Compute the unit tangents and unit normal of a rational surface from the
+ * first derivatives of its homogenous counterpart
+ * @param[in] pointw Point on the surface in homogenous coordinates.
+ * @param[in] der_uw First derivative along u in homogenous coordinates.
+ * @param[in] der_vw First derivative along v in homogenous coordinates.
+ * @param[out] frame_point Point on the surface in cartesian coordinates.
+ * @param[out] tangent_u Unit tangent along u.
+ * @param[out] tangent_v Unit tangent along v.
+ * @param[out] normal Unit normal.
+ */
+template <typename T>
+void surfaceFrameFromDerivatives(const glm::vec<4, T> &pointw, const glm::vec<4, T> &der_uw,
+                                 const glm::vec<4, T> &der_vw, glm::vec<3, T> &frame_point,
+                                 glm::vec<3, T> &tangent_u, glm::vec<3, T> &tangent_v,
+                                 glm::vec<3, T> &normal)
+{
+    // Quotient rule for the first derivatives
+    T w = pointw.w;
+    glm::vec<3, T> point = util::truncateHomogenous(pointw) / w;
+    glm::vec<3, T> der_u = (util::truncateHomogenous(der_uw) - der_uw.w * point) / w;
+    glm::vec<3, T> der_v = (util::truncateHomogenous(der_vw) - der_vw.w * point) / w;
+    surfaceFrameFromDerivatives(point, der_u, der_v, frame_point, tangent_u, tangent_v, normal);
+}
+
+/**
+ * Evaluate the point, unit tangents and unit normal on a non-rational surface,
+ * or on a rational surface given in homogenous coordinates, in one pass over
+ * the basis functions and their first derivatives
+ * @param[in] degree_u Degree of the given surface in u-direction.
+ * @param[in] degree_v Degree of the given surface in v-direction.
+ * @param[in] knots_u Knot vector of the surface in u-direction.
+ * @param[in] knots_v Knot vector of the surface in v-direction.
+ * @param[in] control_points Control points of the surface in a 2D array.
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @param[out] point Point on the surface at (u, v).
+ * @param[out] tangent_u Unit tangent along u at (u, v).
+ * @param[out] tangent_v Unit tangent along v at (u, v).
+ * @param[out] normal Unit normal at (u, v).
+ * @param[inout] ws Workspace providing scratch buffers and the span hints.
+ */
+template <int dim, typename T>
+void surfaceFrame(unsigned int degree_u, unsigned int degree_v, const std::vector<T> &knots_u,
+                  const std::vector<T> &knots_v, const array2<glm::vec<dim, T>> &control_points,
+                  T u, T v, glm::vec<3, T> &point, glm::vec<3, T> &tangent_u,
+                  glm::vec<3, T> &tangent_v, glm::vec<3, T> &normal, EvalWorkspace<T> &ws)
+{
+    typedef glm::vec<dim, T> tvecn;
+
+    int span_u = ws.findSpanU(degree_u, knots_u, u);
+    int span_v = ws.findSpanV(degree_v, knots_v, v);
+    bsplineDerBasis(degree_u, span_u, knots_u, u, 1, ws.ders_u, ws.ndu, ws.a);
+    bsplineDerBasis(degree_v, span_v, knots_v, v, 1, ws.ders_v, ws.ndu, ws.a);
+
+    tvecn pt(0.0), der_u(0.0), der_v(0.0);
+    for (int s = 0; s <= degree_v; s++)
+    {
+        tvecn temp(0.0), temp_u(0.0);
+        for (int r = 0; r <= degree_u; r++)
+        {
+            const tvecn &cp = control_points(span_u - degree_u + r, span_v - degree_v + s);
+            temp += ws.ders_u(0, r) * cp;
+            temp_u += ws.ders_u(1, r) * cp;
+        }
+        pt += ws.ders_v(0, s) * temp;
+        der_u += ws.ders_v(0, s) * temp_u;
+        der_v += ws.ders_v(1, s) * temp;
+    }
+    surfaceFrameFromDerivatives(pt, der_u, der_v, point, tangent_u, tangent_v, normal);
+}
+
+/**
+ * Evaluate the point, unit tangents and unit normal on a rational surface in
+ * one pass over the basis functions and their first derivatives, weighting the
+ * control points in the support on the fly
+ * @param[in] degree_u Degree of the given surface in u-direction.
+ * @param[in] degree_v Degree of the given surface in v-direction.
+ * @param[in] knots_u Knot vector of the surface in u-direction.
+ * @param[in] knots_v Knot vector of the surface in v-direction.
+ * @param[in] control_points Control points of the surface in a 2D array.
+ * @param[in] weights Weights corresponding to the control points.
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @param[out] point Point on the surface at (u, v).
+ * @param[out] tangent_u Unit tangent along u at (u, v).
+ * @param[out] tangent_v Unit tangent along v at (u, v).
+ * @param[out] normal Unit normal at (u, v).
+ * @param[inout] ws Workspace providing scratch buffers and the span hints.
+ */
+template <typename T>
+void surfaceFrame(unsigned int degree_u, unsigned int degree_v, const std::vector<T> &knots_u,
+                  const std::vector<T> &knots_v, const array2<glm::vec<3, T>> &control_points,
+                  const array2<T> &weights, T u, T v, glm::vec<3, T> &point,
+                  glm::vec<3, T> &tangent_u, glm::vec<3, T> &tangent_v, glm::vec<3, T> &normal,
+                  EvalWorkspace<T> &ws)
+{
+    typedef glm::vec<4, T> tvec4;
+
+    int span_u = ws.findSpanU(degree_u, knots_u, u);
+    int span_v = ws.findSpanV(degree_v, knots_v, v);
+    bsplineDerBasis(degree_u, span_u, knots_u, u, 1, ws.ders_u, ws.ndu, ws.a);
+    bsplineDerBasis(degree_v, span_v, knots_v, v, 1, ws.ders_v, ws.ndu, ws.a);
+
+    tvec4 pointw(0.0), der_uw(0.0), der_vw(0.0);
+    for (int s = 0; s <= degree_v; s++)
+    {
+        int j = span_v - degree_v + s;
+        tvec4 temp(0.0), temp_u(0.0);
+        for (int r = 0; r <= degree_u; r++)
+        {
+            int i = span_u - degree_u + r;
+            tvec4 cpw = util::cartesianToHomogenous(control_points(i, j), weights(i, j));
+            temp += ws.ders_u(0, r) * cpw;
+            temp_u += ws.ders_u(1, r) * cpw;
+        }
+        pointw += ws.ders_v(0, s) * temp;
+        der_uw += ws.ders_v(0, s) * temp_u;
+        der_vw += ws.ders_v(1, s) * temp;
+    }
+    surfaceFrameFromDerivatives(pointw, der_uw, der_vw, point, tangent_u, tangent_v, normal);
+}
+
+/**
+ * Compute the spans, non-zero basis functions and their derivatives for many
+ * parameters along one direction of a surface
+ * @param[in] degree Degree of the basis functions.
+ * @param[in] knots Knot vector of the basis functions.
+ * @param[in] params Parameters to evaluate the basis functions at.
+ * @param[in] num_ders Number of times to differentiate.
+ * @param[out] spans Span of each parameter.
+ * @param[out] ders Derivatives of the basis functions, where the kth derivative
+ * of the jth non-zero basis function at params[i] is ders(i, k * (degree + 1) + j).
+ */
+template <typename T>
+void derBasisRows(unsigned int degree, const std::vector<T> &knots, const std::vector<T> &params,
+                  int num_ders, std::vector<int> &spans, array2<T> &ders)
+{
+    EvalWorkspace<T> ws;
+
+    spans.resize(params.size());
+    ders.resize(params.size(), (num_ders + 1) * (degree + 1));
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        spans[i] = ws.findSpanU(degree, knots, params[i]);
+        bsplineDerBasis(degree, spans[i], knots, params[i], num_ders, ws.ders_u, ws.ndu, ws.a);
+        for (int k = 0; k <= num_ders; ++k)
+        {
+            for (unsigned int j = 0; j <= degree; ++j)
+            {
+                ders(i, k * (degree + 1) + j) = ws.ders_u(k, j);
+            }
+        }
+    }
+}
+
+/**
+ * Evaluate points, unit tangents and unit normals on a non-rational surface, or
+ * on a rational surface given in homogenous coordinates, over the
+ * tensor-product grid of the given parameters. The basis functions and their
+ * derivatives are computed once per u and once per v, and the control points
+ * are contracted along u once per grid row.
+ * @param[in] degree_u Degree of the given surface in u-direction.
+ * @param[in] degree_v Degree of the given surface in v-direction.
+ * @param[in] knots_u Knot vector of the surface in u-direction.
+ * @param[in] knots_v Knot vector of the surface in v-direction.
+ * @param[in] control_points Control points of the surface in a 2d array.
+ * @param[in] us Parameters along u-direction.
+ * @param[in] vs Parameters along v-direction.
+ * @param[out] points Points, where points(i, j) is the point at (us[i], vs[j]).
+ * @param[out] tangents_u Unit tangents along u at the grid points.
+ * @param[out] tangents_v Unit tangents along v at the grid points.
+ * @param[out] normals Unit normals at the grid points.
+ */
+template <int dim, typename T>
+void surfaceFrameGrid(unsigned int degree_u, unsigned int degree_v,
+                      const std::vector<T> &knots_u, const std::vector<T> &knots_v,
+                      const array2<glm::vec<dim, T>> &control_points, const std::vector<T> &us,
+                      const std::vector<T> &vs, array2<glm::vec<3, T>> &points,
+                      array2<glm::vec<3, T>> &tangents_u, array2<glm::vec<3, T>> &tangents_v,
+                      array2<glm::vec<3, T>> &normals)
+{
+    typedef glm::vec<dim, T> tvecn;
+
+    points.resize(us.size(), vs.size());
+    tangents_u.resize(us.size(), vs.size());
+    tangents_v.resize(us.size(), vs.size());
+    normals.resize(us.size(), vs.size());
+
+    std::vector<int> spans_u, spans_v;
+    array2<T> Nu, Nv;
+    derBasisRows(degree_u, knots_u, us, 1, spans_u, Nu);
+    derBasisRows(degree_v, knots_v, vs, 1, spans_v, Nv);
+
+    // Control points contracted along u, and along the u-derivative, for the
+    // current row
+    std::vector<tvecn> temp(control_points.cols()), temp_u(control_points.cols());
+
+    for (size_t i = 0; i < us.size(); ++i)
+    {
+        int row0 = spans_u[i] - degree_u;
+        for (size_t c = 0; c < control_points.cols(); ++c)
+        {
+            tvecn sum(0.0), sum_u(0.0);
+            for (int k = 0; k <= degree_u; k++)
+            {
+                const tvecn &cp = control_points(row0 + k, c);
+                sum += Nu(i, k) * cp;
+                sum_u += Nu(i, degree_u + 1 + k) * cp;
+            }
+            temp[c] = sum;
+            temp_u[c] = sum_u;
+        }
+
+        for (size_t j = 0; j < vs.size(); ++j)
+        {
+            int col0 = spans_v[j] - degree_v;
+            tvecn pt(0.0), der_u(0.0), der_v(0.0);
+            for (int l = 0; l <= degree_v; l++)
+            {
+                pt += Nv(j, l) * temp[col0 + l];
+                der_u += Nv(j, l) * temp_u[col0 + l];
+                der_v += Nv(j, degree_v + 1 + l) * temp[col0 + l];
+            }
+            surfaceFrameFromDerivatives(pt, der_u, der_v, points(i, j), tangents_u(i, j),
+                                        tangents_v(i, j), normals(i, j));
+        }
+    }
+}
+
+/**
+ * Evaluate points, unit tangents and unit normals on a rational surface over
+ * the tensor-product grid of the given parameters. The basis functions and their
+ * derivatives are computed once per u and once per v, and the weighted control
+ * points are contracted along u once per grid row.
+ * @param[in] degree_u Degree of the given surface in u-direction.
+ * @param[in] degree_v Degree of the given surface in v-direction.
+ * @param[in] knots_u Knot vector of the surface in u-direction.
+ * @param[in] knots_v Knot vector of the surface in v-direction.
+ * @param[in] control_points Control points of the surface in a 2d array.
+ * @param[in] weights Weights corresponding to the control points.
+ * @param[in] us Parameters along u-direction.
+ * @param[in] vs Parameters along v-direction.
+ * @param[out] points Points, where points(i, j) is the point at (us[i], vs[j]).
+ * @param[out] tangents_u Unit tangents along u at the grid points.
+ * @param[out] tangents_v Unit tangents along v at the grid points.
+ * @param[out] normals Unit normals at the grid points.
+ */
+template <typename T>
+void surfaceFrameGrid(unsigned int degree_u, unsigned int degree_v,
+                      const std::vector<T> &knots_u, const std::vector<T> &knots_v,
+                      const array2<glm::vec<3, T>> &control_points, const array2<T> &weights,
+                      const std::vector<T> &us, const std::vector<T> &vs,
+                      array2<glm::vec<3, T>> &points, array2<glm::vec<3, T>> &tangents_u,
+                      array2<glm::vec<3, T>> &tangents_v, array2<glm::vec<3, T>> &normals)
+{
+    typedef glm::vec<4, T> tvec4;
+
+    points.resize(us.size(), vs.size());
+    tangents_u.resize(us.size(), vs.size());
+    tangents_v.resize(us.size(), vs.size());
+    normals.resize(us.size(), vs.size());
+
+    std::vector<int> spans_u, spans_v;
+    array2<T> Nu, Nv;
+    derBasisRows(degree_u, knots_u, us, 1, spans_u, Nu);
+    derBasisRows(degree_v, knots_v, vs, 1, spans_v, Nv);
+
+    // Homogenous control points contracted along u, and along the u-derivative,
+    // for the current row
+    std::vector<tvec4> temp(control_points.cols()), temp_u(control_points.cols());
+
+    for (size_t i = 0; i < us.size(); ++i)
+    {
+        int row0 = spans_u[i] - degree_u;
+        for (size_t c = 0; c < control_points.cols(); ++c)
+        {
+            tvec4 sum(0.0), sum_u(0.0);
+            for (int k = 0; k <= degree_u; k++)
+            {
+                tvec4 cpw = util::cartesianToHomogenous(control_points(row0 + k, c),
+                                                        weights(row0 + k, c));
+                sum += Nu(i, k) * cpw;
+                sum_u += Nu(i, degree_u + 1 + k) * cpw;
+            }
+            temp[c] = sum;
+            temp_u[c] = sum_u;
+        }
+
+        for (size_t j = 0; j < vs.size(); ++j)
+        {
+            int col0 = spans_v[j] - degree_v;
+            tvec4 pointw(0.0), der_uw(0.0), der_vw(0.0);
+            for (int l = 0; l <= degree_v; l++)
+            {
+                pointw += Nv(j, l) * temp[col0 + l];
+                der_uw += Nv(j, l) * temp_u[col0 + l];
+                der_vw += Nv(j, degree_v + 1 + l) * temp[col0 + l];
+            }
+            surfaceFrameFromDerivatives(pointw, der_uw, der_vw, points(i, j), tangents_u(i, j),
+                                        tangents_v(i, j), normals(i, j));
+        }
+    }
+}
+
+/**
+ * Evaluate one coordinate plane of a SoaSurface at a point
+ * @param[in] plane Coordinate plane with rows of the given stride.
+ * @param[in] stride Padded length of each row of the plane.
+ * @param[in] row0 First row in the support of the point.
+ * @param[in] col0 First column in the support of the point.
+ * @param[in] Nu Non-zero basis functions along u.
+ * @param[in] Nv Non-zero basis functions along v.
+ * @return Value of the coordinate at the point.
+ */
+template <typename T>
+T planePoint(const T *plane, size_t stride, int row0, int col0, const std::vector<T> &Nu,
+             const std::vector<T> &Nv)
+{
+    T point = 0;
+    for (size_t r = 0; r < Nu.size(); r++)
+    {
+        const T *row = plane + (row0 + r) * stride + col0;
+        T temp = 0;
+        for (size_t s = 0; s < Nv.size(); s++)
+        {
+            temp += Nv[s] * row[s];
+        }
+        point += Nu[r] * temp;
+    }
+    return point;
+}
+
+/**
+ * Evaluate the derivatives of one coordinate plane of a SoaSurface
+ * @param[in] plane Coordinate plane with rows of the given stride.
+ * @param[in] stride Padded length of each row of the plane.
+ * @param[in] row0 First row in the support of the point.
+ * @param[in] col0 First column in the support of the point.
+ * @param[in] ders_u Non-zero basis function derivatives along u.
+ * @param[in] ders_v Non-zero basis function derivatives along v.
+ * @param[in] num_ders Number of times to differentiate.
+ * @param[out] plane_ders Derivatives of the coordinate, where plane_ders(k, l) is
+ * differentiated k times along u and l times along v.
+ * @param[inout] temp Scratch buffer for partial sums over a row.
+ */
+template <typename T>
+void planeDerivatives(const T *plane, size_t stride, int row0, int col0, const array2<T> &ders_u,
+                      const array2<T> &ders_v, unsigned int num_ders, array2<T> &plane_ders,
+                      std::vector<T> &temp)
+{
+    unsigned int degree_u = static_cast<unsigned int>(ders_u.cols()) - 1;
+    unsigned int degree_v = static_cast<unsigned int>(ders_v.cols()) - 1;
+    unsigned int du = std::min(num_ders, degree_u);
+    unsigned int dv = std::min(num_ders, degree_v);
+
+    plane_ders.resize(num_ders + 1, num_ders + 1);
+    for (int k = 0; k <= num_ders; k++)
+    {
+        for (int l = 0; l <= num_ders; l++)
+        {
+            plane_ders(k, l) = T(0);
+        }
+    }
+
+    temp.resize(degree_v + 1);
+    for (int k = 0; k <= du; k++)
+    {
+        std::fill(temp.begin(), temp.end(), T(0));
+        for (int r = 0; r <= degree_u; r++)
+        {
+            const T *row = plane + (row0 + r) * stride + col0;
+            T d = ders_u(k, r);
+            for (int s = 0; s <= degree_v; s++)
+            {
+                temp[s] += d * row[s];
+            }
+        }
+
+        int dd = std::min(num_ders - k, dv);
+        for (int l = 0; l <= dd; l++)
+        {
+            T der = 0;
+            for (int s = 0; s <= degree_v; s++)
+            {
+                der += ders_v(l, s) * temp[s];
+            }
+            plane_ders(k, l) = der;
+        }
+    }
+}
+
+/**
+ * Evaluate point on a NURBS surface stored as coordinate planes
+ * @param[in] srf SoaSurface object
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @param[inout] ws Workspace providing scratch buffers and the span hints.
+ * @return Resulting point on the surface at (u, v).
+ */
+template <typename T> glm::vec<3, T> surfacePoint(const SoaSurface<T> &srf, T u, T v,
+                                                  EvalWorkspace<T> &ws)
+{
+    int span_u = ws.findSpanU(srf.degree_u, srf.knots_u, u);
+    int span_v = ws.findSpanV(srf.degree_v, srf.knots_v, v);
+    bsplineBasis(srf.degree_u, span_u, srf.knots_u, u, ws.basis_u);
+    bsplineBasis(srf.degree_v, span_v, srf.knots_v, v, ws.basis_v);
+
+    int row0 = span_u - srf.degree_u, col0 = span_v - srf.degree_v;
+    glm::vec<3, T> point(planePoint(srf.x.data(), srf.stride, row0, col0, ws.basis_u, ws.basis_v),
+                         planePoint(srf.y.data(), srf.stride, row0, col0, ws.basis_u, ws.basis_v),
+                         planePoint(srf.z.data(), srf.stride, row0, col0, ws.basis_u, ws.basis_v));
+    if (!srf.w.empty())
+    {
+        point /= planePoint(srf.w.data(), srf.stride, row0, col0, ws.basis_u, ws.basis_v);
+    }
+    return point;
+}
+
+/**
+ * Evaluate derivatives on a NURBS surface stored as coordinate planes
+ * @param[in] srf SoaSurface object
+ * @param[in] num_ders Number of times to differentiate
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @param[out] surf_ders Derivatives of the surface at (u, v) in cartesian coordinates.
+ * @param[inout] ws Workspace providing scratch buffers and the span hints.
+ */
+template <typename T>
+void surfaceDerivatives(const SoaSurface<T> &srf, unsigned int num_ders, T u, T v,
+                        array2<glm::vec<3, T>> &surf_ders, EvalWorkspace<T> &ws)
+{
+    int span_u = ws.findSpanU(srf.degree_u, srf.knots_u, u);
+    int span_v = ws.findSpanV(srf.degree_v, srf.knots_v, v);
+    bsplineDerBasis(srf.degree_u, span_u, srf.knots_u, u, num_ders, ws.ders_u, ws.ndu, ws.a);
+    bsplineDerBasis(srf.degree_v, span_v, srf.knots_v, v, num_ders, ws.ders_v, ws.ndu, ws.a);
+
+    int row0 = span_u - srf.degree_u, col0 = span_v - srf.degree_v;
+    const T *planes[3] = {srf.x.data(), srf.y.data(), srf.z.data()};
+    for (int c = 0; c < 3; c++)
+    {
+        planeDerivatives(planes[c], srf.stride, row0, col0, ws.ders_u, ws.ders_v, num_ders,
+                         ws.plane_ders[c], ws.plane_temp);
+    }
+
+    surf_ders.resize(num_ders + 1, num_ders + 1);
+    for (int k = 0; k <= num_ders; k++)
+    {
+        for (int l = 0; l <= num_ders; l++)
+        {
+            surf_ders(k, l) = glm::vec<3, T>(ws.plane_ders[0](k, l), ws.plane_ders[1](k, l),
+                                             ws.plane_ders[2](k, l));
+        }
+    }
+
+    if (!srf.w.empty())
+    {
+        planeDerivatives(srf.w.data(), srf.stride, row0, col0, ws.ders_u, ws.ders_v, num_ders,
+                         ws.surf_wders, ws.plane_temp);
+        surfaceQuotientRule(ws.surf_wders, ws.binomials(num_ders), surf_ders);
+    }
+}
+
+/**
+ * Evaluate points on a NURBS surface stored as coordinate planes over the
+ * tensor-product grid of the given parameters. For each grid row, every plane is
+ * contracted along u over whole padded rows of contiguous memory.
+ * @param[in] srf SoaSurface object
+ * @param[in] us Parameters along u-direction.
+ * @param[in] vs Parameters along v-direction.
+ * @param[out] points Resulting points, where points(i, j) is the point at (us[i], vs[j]).
+ */
+template <typename T>
+void surfaceGrid(const SoaSurface<T> &srf, const std::vector<T> &us, const std::vector<T> &vs,
+                 array2<glm::vec<3, T>> &points)
+{
+    typedef typename SoaSurface<T>::plane_type plane_type;
+
+    points.resize(us.size(), vs.size());
+
+    std::vector<int> spans_u, spans_v;
+    array2<T> Nu, Nv;
+    basisRows(srf.degree_u, srf.knots_u, us, spans_u, Nu);
+    basisRows(srf.degree_v, srf.knots_v, vs, spans_v, Nv);
+
+    bool rational = !srf.w.empty();
+    int num_planes = rational ? 4 : 3;
+    const T *planes[4] = {srf.x.data(), srf.y.data(), srf.z.data(),
+                          rational ? srf.w.data() : nullptr};
+
+    // Planes contracted along u for the current row
+    plane_type temp[4];
+    for (int c = 0; c < num_planes; c++)
+    {
+        temp[c].resize(srf.stride);
+    }
+
+    for (size_t i = 0; i < us.size(); ++i)
+    {
+        int row0 = spans_u[i] - srf.degree_u;
+        for (int c = 0; c < num_planes; c++)
+        {
+            T *t = temp[c].data();
+            const T *row = planes[c] + row0 * srf.stride;
+            T n0 = Nu(i, 0);
+            for (size_t j = 0; j < srf.stride; ++j)
+            {
+                t[j] = n0 * row[j];
+            }
+            for (int k = 1; k <= srf.degree_u; k++)
+            {
+                row += srf.stride;
+                T nk = Nu(i, k);
+                for (size_t j = 0; j < srf.stride; ++j)
+                {
+                    t[j] += nk * row[j];
+                }
+            }
+        }
+
+        for (size_t j = 0; j < vs.size(); ++j)
+        {
+            int col0 = spans_v[j] - srf.degree_v;
+            T p[4] = {0, 0, 0, 1};
+            for (int c = 0; c < num_planes; c++)
+            {
+                T sum = 0;
+                for (int l = 0; l <= srf.degree_v; l++)
+                {
+                    sum += Nv(j, l) * temp[c][col0 + l];
+                }
+                p[c] = sum;
+            }
+            points(i, j) = glm::vec<3, T>(p[0], p[1], p[2]) / p[3];
+        }
+    }
+}
+
+} // namespace internal
+
+/////////////////////////////////////////////////////////////////////
+
+/**
+Evaluate point on a nonrational NURBS curve
+@param[in] crv Curve object
+@param[in] u Parameter to evaluate the curve at.
+@return point Resulting point on the curve at parameter u.
+*/
+template <typename T> glm::vec<3, T> curvePoint(const Curve<T> &crv, T u)
+{
+    return internal::curvePoint(crv.degree, crv.knots, crv.control_points, u);
+}
+
+/**
+Evaluate point on a nonrational NURBS curve without allocating
+@param[in] crv Curve object
+@param[in] u Parameter to evaluate the curve at.
+@param[inout] ws Workspace reused across evaluations.
+@return point Resulting point on the curve at parameter u.
+*/
+template <typename T> glm::vec<3, T> curvePoint(const Curve<T> &crv, T u, EvalWorkspace<T> &ws)
+{
+    return internal::curvePoint(crv.degree, crv.knots, crv.control_points, u, ws);
+}
+
+/**
+ * Evaluate point on a rational NURBS curve
+ * @param[in] crv RationalCurve object
+ * @param[in] u Parameter to evaluate the curve at.
+ * @return point Resulting point on the curve.
+ */
+template <typename T> glm::vec<3, T> curvePoint(const RationalCurve<T> &crv, T u)
+{
+    EvalWorkspace<T> ws;
+    return curvePoint(crv, u, ws);
+}
+
+/**
+ * Evaluate point on a rational NURBS curve without allocating
+ * @param[in] crv RationalCurve object
+ * @param[in] u Parameter to evaluate the curve at.
+ * @param[inout] ws Workspace reused across evaluations.
+ * @return point Resulting point on the curve.
+ */
+template <typename T>
+glm::vec<3, T> curvePoint(const RationalCurve<T> &crv, T u, EvalWorkspace<T> &ws)
+{
+    // Compute point using homogenous coordinates
+    glm::vec<4, T> pointw =
+        internal::curvePoint(crv.degree, crv.knots, crv.control_points, crv.weights, u, ws);
+
+    // Convert back to cartesian coordinates
+    return util::homogenousToCartesian(pointw);
+}
+
+/**
+ * Evaluate point on a rational NURBS curve stored in homogenous coordinates
+ * @param[in] crv HomogenousCurve object
+ * @param[in] u Parameter to evaluate the curve at.
+ * @return point Resulting point on the curve.
+ */
+template <typename T> glm::vec<3, T> curvePoint(const HomogenousCurve<T> &crv, T u)
+{
+    glm::vec<4, T> pointw = internal::curvePoint(crv.degree, crv.knots, crv.control_points, u);
+    return util::homogenousToCartesian(pointw);
+}
+
+/**
+ * Evaluate point on a rational NURBS curve stored in homogenous coordinates
+ * without allocating
+ * @param[in] crv HomogenousCurve object
+ * @param[in] u Parameter to evaluate the curve at.
+ * @param[inout] ws Workspace reused across evaluations.
+ * @return point Resulting point on the curve.
+ */
+template <typename T>
+glm::vec<3, T> curvePoint(const HomogenousCurve<T> &crv, T u, EvalWorkspace<T> &ws)
+{
+    glm::vec<4, T> pointw =
+        internal::curvePoint(crv.degree, crv.knots, crv.control_points, u, ws);
+    return util::homogenousToCartesian(pointw);
+}
+
+/**
+ * Evaluate derivatives of a non-rational NURBS curve
+ * @param[in] crv Curve object
+ * @param[in] num_ders Number of times to derivate.
+ * @param[in] u Parameter to evaluate the derivatives at.
+ * @return curve_ders Derivatives of the curve at u.
+ * E.g. curve_ders[n] is the nth derivative at u, where 0 <= n <= num_ders.
+ */
+template <typename T>
+std::vector<glm::vec<3, T>> curveDerivatives(const Curve<T> &crv, int num_ders, T u)
+{
+    return internal::curveDerivatives(crv.degree, crv.knots, crv.control_points, num_ders, u);
+}
+
+/**
+ * Evaluate derivatives of a non-rational NURBS curve without allocating
+ * @param[in] crv Curve object
+ * @param[in] num_ders Number of times to derivate.
+ * @param[in] u Parameter to evaluate the derivatives at.
+ * @param[out] curve_ders Derivatives of the curve at u, where curve_ders[n] is
+ * the nth derivative at u.
+ * @param[inout] ws Workspace reused across evaluations.
+ */
+template <typename T>
+void curveDerivatives(const Curve<T> &crv, int num_ders, T u,
+                      std::vector<glm::vec<3, T>> &curve_ders, EvalWorkspace<T> &ws)
+{
+    curve_ders.resize(num_ders + 1);
+    internal::curveDerivatives(crv.degree, crv.knots, crv.control_points, num_ders, u,
+                               curve_ders.data(), ws);
+}
+
+/**
+ * Evaluate derivatives of a rational NURBS curve
+ * @param[in] u Parameter to evaluate the derivatives at.
+ * @param[in] knots Knot vector of the curve.
+ * @param[in] control_points Control points of the curve.
+ * @param[in] weights Weights corresponding to each control point.
+ * @param[in] num_ders Number of times to differentiate.
+ * @param[inout] curve_ders Derivatives of the curve at u.
+ * E.g. curve_ders[n] is the nth derivative at u, where n is between 0 and
+ * num_ders-1.
+ */
+template <typename T>
+std::vector<glm::vec<3, T>> curveDerivatives(const RationalCurve<T> &crv, int num_ders, T u)
+{
+    EvalWorkspace<T> ws;
+    std::vector<glm::vec<3, T>> curve_ders;
+    curveDerivatives(crv, num_ders, u, curve_ders, ws);
+    return curve_ders;
+}
+
+/**
+ * Evaluate derivatives of a rational NURBS curve without allocating
+ * @param[in] crv RationalCurve object
+ * @param[in] num_ders Number of times to differentiate.
+ * @param[in] u Parameter to evaluate the derivatives at.
+ * @param[out] curve_ders Derivatives of the curve at u, where curve_ders[n] is
+ * the nth derivative at u.
+ * @param[inout] ws Workspace reused across evaluations.
+ */
+template <typename T>
+void curveDerivatives(const RationalCurve<T> &crv, int num_ders, T u,
+                      std::vector<glm::vec<3, T>> &curve_ders, EvalWorkspace<T> &ws)
+{
+    curve_ders.resize(num_ders + 1);
+    internal::curveDerivatives(crv.degree, crv.knots, crv.control_points, crv.weights, num_ders,
+                               u, curve_ders.data(), ws);
+}
+
+/**
+ * Evaluate derivatives of a rational NURBS curve stored in homogenous coordinates
+ * @param[in] crv HomogenousCurve object
+ * @param[in] num_ders Number of times to differentiate.
+ * @param[in] u Parameter to evaluate the derivatives at.
+ * @return curve_ders Derivatives of the curve at u.
+ * E.g. curve_ders[n] is the nth derivative at u, where 0 <= n <= num_ders.
+ */
+template <typename T>
+std::vector<glm::vec<3, T>> curveDerivatives(const HomogenousCurve<T> &crv, int num_ders, T u)
+{
+    EvalWorkspace<T> ws;
+    std::vector<glm::vec<3, T>> curve_ders;
+    curveDerivatives(crv, num_ders, u, curve_ders, ws);
+    return curve_ders;
+}
+
+/**
+ * Evaluate derivatives of a rational NURBS curve stored in homogenous
+ * coordinates without allocating
+ * @param[in] crv HomogenousCurve object
+ * @param[in] num_ders Number of times to differentiate.
+ * @param[in] u Parameter to evaluate the derivatives at.
+ * @param[out] curve_ders Derivatives of the curve at u, where curve_ders[n] is
+ * the nth derivative at u.
+ * @param[inout] ws Workspace reused across evaluations.
+ */
+template <typename T>
+void curveDerivatives(const HomogenousCurve<T> &crv, int num_ders, T u,
+                      std::vector<glm::vec<3, T>> &curve_ders, EvalWorkspace<T> &ws)
+{
+    ws.curve_dersw.resize(num_ders + 1);
+    internal::curveDerivatives(crv.degree, crv.knots, crv.control_points, num_ders, u,
+                               ws.curve_dersw.data(), ws);
+    internal::rationalCurveDerivatives(ws.curve_dersw, curve_ders, ws);
+}
+
+/**
+ * Evaluate the tangent of a B-spline curve
+ * @param[in] crv Curve object
+ * @return Unit tangent of the curve at u.
+ */
+template <typename T> glm::vec<3, T> curveTangent(const Curve<T> &crv, T u)
+{
+    std::vector<glm::vec<3, T>> ders = curveDerivatives(crv, 1, u);
+    glm::vec<3, T> du = ders[1];
+    T du_len = glm::length(du);
+    if (!util::close(du_len, T(0)))
+    {
+        du /= du_len;
+    }
+    return du;
+}
+
+/**
+ * Evaluate the tangent of a rational B-spline curve
+ * @param[in] crv RationalCurve object
+ * @return Unit tangent of the curve at u.
+ */
+template <typename T> glm::vec<3, T> curveTangent(const RationalCurve<T> &crv, T u)
+{
+    std::vector<glm::vec<3, T>> ders = curveDerivatives(crv, 1, u);
+    glm::vec<3, T> du = ders[1];
+    T du_len = glm::length(du);
+    if (!util::close(du_len, T(0)))
+    {
+        du /= du_len;
+    }
+    return du;
+}
+
+/**
+ * Evaluate points on a non-rational NURBS curve at many parameters. Sorted
+ * parameters are evaluated in one pass without searching the knot vector.
+ * @param[in] crv Curve object
+ * @param[in] params Parameters to evaluate the curve at.
+ * @param[out] points Resulting points on the curve, one per parameter.
+ */
+template <typename T>
+void curvePoints(const Curve<T> &crv, const std::vector<T> &params,
+                 std::vector<glm::vec<3, T>> &points)
+{
+    EvalWorkspace<T> ws;
+    curvePoints(crv, params, points, ws);
+}
+
+/**
+ * Evaluate points on a non-rational NURBS curve at many parameters without
+ * allocating scratch memory
+ * @param[in] crv Curve object
+ * @param[in] params Parameters to evaluate the curve at.
+ * @param[out] points Resulting points on the curve, one per parameter.
+ * @param[inout] ws Workspace reused across evaluations.
+ */
+template <typename T>
+void curvePoints(const Curve<T> &crv, const std::vector<T> &params,
+                 std::vector<glm::vec<3, T>> &points, EvalWorkspace<T> &ws)
+{
+    internal::curvePoints(crv.degree, crv.knots, crv.control_points, params, points, ws);
+}
+
+/**
+ * Evaluate points on a rational NURBS curve at many parameters. Sorted
+ * parameters are evaluated in one pass without searching the knot vector.
+ * @param[in] crv RationalCurve object
+ * @param[in] params Parameters to evaluate the curve at.
+ * @param[out] points Resulting points on the curve, one per parameter.
+ */
+template <typename T>
+void curvePoints(const RationalCurve<T> &crv, const std::vector<T> &params,
+                 std::vector<glm::vec<3, T>> &points)
+{
+    EvalWorkspace<T> ws;
+    curvePoints(crv, params, points, ws);
+}
+
+/**
+ * Evaluate points on a rational NURBS curve at many parameters without
+ * allocating scratch memory
+ * @param[in] crv RationalCurve object
+ * @param[in] params Parameters to evaluate the curve at.
+ * @param[out] points Resulting points on the curve, one per parameter.
+ * @param[inout] ws Workspace reused across evaluations.
+ */
+template <typename T>
+void curvePoints(const RationalCurve<T> &crv, const std::vector<T> &params,
+                 std::vector<glm::vec<3, T>> &points, EvalWorkspace<T> &ws)
+{
+    internal::curvePoints(crv.degree, crv.knots, crv.control_points, crv.weights, params,
+                          points, ws);
+}
+
+/**
+ * Evaluate derivatives of a non-rational NURBS curve at many parameters.
+ * Sorted parameters are evaluated in one pass without searching the knot vector.
+ * @param[in] crv Curve object
+ * @param[in] num_ders Number of times to derivate.
+ * @param[in] params Parameters to evaluate the derivatives at.
+ * @param[out] curve_ders Derivatives of the curve, where curve_ders(i, k) is the
+ * kth derivative at params[i].
+ */
+template <typename T>
+void curveDerivativesBatch(const Curve<T> &crv, int num_ders, const std::vector<T> &params,
+                           array2<glm::vec<3, T>> &curve_ders)
+{
+    EvalWorkspace<T> ws;
+    curveDerivativesBatch(crv, num_ders, params, curve_ders, ws);
+}
+
+/**
+ * Evaluate derivatives of a non-rational NURBS curve at many parameters without
+ * allocating scratch memory
+ * @param[in] crv Curve object
+ * @param[in] num_ders Number of times to derivate.
+ * @param[in] params Parameters to evaluate the derivatives at.
+ * @param[out] curve_ders Derivatives of the curve, where curve_ders(i, k) is the
+ * kth derivative at params[i].
+ * @param[inout] ws Workspace reused across evaluations.
+ */
+template <typename T>
+void curveDerivativesBatch(const Curve<T> &crv, int num_ders, const std::vector<T> &params,
+                           array2<glm::vec<3, T>> &curve_ders, EvalWorkspace<T> &ws)
+{
+    internal::curveDerivativesBatch(crv.degree, crv.knots, crv.control_points, num_ders, params,
+                                    curve_ders, ws);
+}
+
+/**
+ * Evaluate derivatives of a rational NURBS curve at many parameters. Sorted
+ * parameters are evaluated in one pass without searching the knot vector.
+ * @param[in] crv RationalCurve object
+ * @param[in] num_ders Number of times to derivate.
+ * @param[in] params Parameters to evaluate the derivatives at.
+ * @param[out] curve_ders Derivatives of the curve, where curve_ders(i, k) is the
+ * kth derivative at params[i].
+ */
+template <typename T>
+void curveDerivativesBatch(const RationalCurve<T> &crv, int num_ders,
+                           const std::vector<T> &params, array2<glm::vec<3, T>> &curve_ders)
+{
+    EvalWorkspace<T> ws;
+    curveDerivativesBatch(crv, num_ders, params, curve_ders, ws);
+}
+
+/**
+ * Evaluate derivatives of a rational NURBS curve at many parameters without
+ * allocating scratch memory
+ * @param[in] crv RationalCurve object
+ * @param[in] num_ders Number of times to derivate.
+ * @param[in] params Parameters to evaluate the derivatives at.
+ * @param[out] curve_ders Derivatives of the curve, where curve_ders(i, k) is the
+ * kth derivative at params[i].
+ * @param[inout] ws Workspace reused across evaluations.
+ */
+template <typename T>
+void curveDerivativesBatch(const RationalCurve<T> &crv, int num_ders,
+                           const std::vector<T> &params, array2<glm::vec<3, T>> &curve_ders,
+                           EvalWorkspace<T> &ws)
+{
+    internal::curveDerivativesBatch(crv.degree, crv.knots, crv.control_points, crv.weights,
+                                    num_ders, params, curve_ders, ws);
+}
+
+/**
+ * Evaluate the tangent of a rational B-spline curve stored in homogenous coordinates
+ * @param[in] crv HomogenousCurve object
+ * @return Unit tangent of the curve at u.
+ */
+template <typename T> glm::vec<3, T> curveTangent(const HomogenousCurve<T> &crv, T u)
+{
+    std::vector<glm::vec<3, T>> ders = curveDerivatives(crv, 1, u);
+    glm::vec<3, T> du = ders[1];
+    T du_len = glm::length(du);
+    if (!util::close(du_len, T(0)))
+    {
+        du /= du_len;
+    }
+    return du;
+}
+
+/**
+ * Evaluate point on a nonrational NURBS surface
+ * @param[in] srf Surface object
  * @param[in] u Parameter to evaluate the surface at.
  * @param[in] v Parameter to evaluate the surface at.
  * @return Resulting point on the surface at (u, v).
  */
 template <typename T> glm::vec<3, T> surfacePoint(const Surface<T> &srf, T u, T v)
+{
+    EvalWorkspace<T> ws;
+    return surfacePoint(srf, u, v, ws);
+}
+
+/**
+ * Evaluate point on a nonrational NURBS surface without allocating
+ * @param[in] srf Surface object
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @param[inout] ws Workspace reused across evaluations.
+ * @return Resulting point on the surface at (u, v).
+ */
+template <typename T>
+glm::vec<3, T> surfacePoint(const Surface<T> &srf, T u, T v, EvalWorkspace<T> &ws)
 {
     return internal::surfacePoint(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
-                                  srf.control_points, u, v);
+                                  srf.control_points, u, v, ws);
 }
 
 /**
@@ -372,29 +2020,134 @@ template <typename T> glm::vec<3, T> surfacePoint(const Surface<T> &srf, T u, T
  */
 template <typename T> glm::vec<3, T> surfacePoint(const RationalSurface<T> &srf, T u, T v)
 {
+    EvalWorkspace<T> ws;
+    return surfacePoint(srf, u, v, ws);
+}
 
-    typedef glm::vec<4, T> tvecnp1;
-
-    // Compute homogenous coordinates of control points
-    array2<tvecnp1> Cw;
-    Cw.resize(srf.control_points.rows(), srf.control_points.cols());
-    for (int i = 0; i < srf.control_points.rows(); i++)
-    {
-        for (int j = 0; j < srf.control_points.cols(); j++)
-        {
-            Cw(i, j) =
-                tvecnp1(util::cartesianToHomogenous(srf.control_points(i, j), srf.weights(i, j)));
-        }
-    }
-
+/**
+ * Evaluate point on a rational NURBS surface without allocating
+ * @param[in] srf RationalSurface object
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @param[inout] ws Workspace reused across evaluations.
+ * @return Resulting point on the surface at (u, v).
+ */
+template <typename T>
+glm::vec<3, T> surfacePoint(const RationalSurface<T> &srf, T u, T v, EvalWorkspace<T> &ws)
+{
     // Compute point using homogenous coordinates
-    tvecnp1 pointw =
-        internal::surfacePoint(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v, Cw, u, v);
+    glm::vec<4, T> pointw = internal::surfacePoint(srf.degree_u, srf.degree_v, srf.knots_u,
+                                                   srf.knots_v, srf.control_points, srf.weights,
+                                                   u, v, ws);
 
     // Convert back to cartesian coordinates
     return util::homogenousToCartesian(pointw);
 }
 
+/**
+ * Evaluate point on a rational NURBS surface stored in homogenous coordinates
+ * @param[in] srf HomogenousSurface object
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @return Resulting point on the surface at (u, v).
+ */
+template <typename T> glm::vec<3, T> surfacePoint(const HomogenousSurface<T> &srf, T u, T v)
+{
+    EvalWorkspace<T> ws;
+    return surfacePoint(srf, u, v, ws);
+}
+
+/**
+ * Evaluate point on a rational NURBS surface stored in homogenous coordinates
+ * without allocating
+ * @param[in] srf HomogenousSurface object
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @param[inout] ws Workspace reused across evaluations.
+ * @return Resulting point on the surface at (u, v).
+ */
+template <typename T>
+glm::vec<3, T> surfacePoint(const HomogenousSurface<T> &srf, T u, T v, EvalWorkspace<T> &ws)
+{
+    glm::vec<4, T> pointw = internal::surfacePoint(srf.degree_u, srf.degree_v, srf.knots_u,
+                                                   srf.knots_v, srf.control_points, u, v, ws);
+    return util::homogenousToCartesian(pointw);
+}
+
+/**
+ * Evaluate points on a non-rational NURBS surface over a tensor-product grid of
+ * parameters, sharing basis functions across rows and columns of the grid
+ * @param[in] srf Surface object
+ * @param[in] us Parameters along u-direction.
+ * @param[in] vs Parameters along v-direction.
+ * @param[out] points Resulting points, where points(i, j) is the point at (us[i], vs[j]).
+ */
+template <typename T>
+void surfaceGrid(const Surface<T> &srf, const std::vector<T> &us, const std::vector<T> &vs,
+                 array2<glm::vec<3, T>> &points)
+{
+    internal::surfaceGrid(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                          srf.control_points, us, vs, points);
+}
+
+/**
+ * Evaluate points on a rational NURBS surface over a tensor-product grid of
+ * parameters, sharing basis functions across rows and columns of the grid
+ * @param[in] srf RationalSurface object
+ * @param[in] us Parameters along u-direction.
+ * @param[in] vs Parameters along v-direction.
+ * @param[out] points Resulting points, where points(i, j) is the point at (us[i], vs[j]).
+ */
+template <typename T>
+void surfaceGrid(const RationalSurface<T> &srf, const std::vector<T> &us,
+                 const std::vector<T> &vs, array2<glm::vec<3, T>> &points)
+{
+    internal::surfaceGrid(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                          srf.control_points, srf.weights, us, vs, points);
+}
+
+/**
+ * Evaluate point on a NURBS surface stored as coordinate planes
+ * @param[in] srf SoaSurface object
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @return Resulting point on the surface at (u, v).
+ */
+template <typename T> glm::vec<3, T> surfacePoint(const SoaSurface<T> &srf, T u, T v)
+{
+    EvalWorkspace<T> ws;
+    return internal::surfacePoint(srf, u, v, ws);
+}
+
+/**
+ * Evaluate point on a NURBS surface stored as coordinate planes without allocating
+ * @param[in] srf SoaSurface object
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @param[inout] ws Workspace reused across evaluations.
+ * @return Resulting point on the surface at (u, v).
+ */
+template <typename T>
+glm::vec<3, T> surfacePoint(const SoaSurface<T> &srf, T u, T v, EvalWorkspace<T> &ws)
+{
+    return internal::surfacePoint(srf, u, v, ws);
+}
+
+/**
+ * Evaluate points on a NURBS surface stored as coordinate planes over a
+ * tensor-product grid of parameters
+ * @param[in] srf SoaSurface object
+ * @param[in] us Parameters along u-direction.
+ * @param[in] vs Parameters along v-direction.
+ * @param[out] points Resulting points, where points(i, j) is the point at (us[i], vs[j]).
+ */
+template <typename T>
+void surfaceGrid(const SoaSurface<T> &srf, const std::vector<T> &us, const std::vector<T> &vs,
+                 array2<glm::vec<3, T>> &points)
+{
+    internal::surfaceGrid(srf, us, vs, points);
+}
+
 /**
  * Evaluate derivatives on a non-rational NURBS surface
  * @param[in] degree_u Degree of the given surface in u-direction.
@@ -414,6 +2167,23 @@ array2<glm::vec<3, T>> surfaceDerivatives(const Surface<T> &srf, int num_ders, T
                                         srf.control_points, num_ders, u, v);
 }
 
+/**
+ * Evaluate derivatives on a non-rational NURBS surface without allocating
+ * @param[in] srf Surface object
+ * @param[in] num_ders Number of times to differentiate
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @param[out] surf_ders Derivatives on the surface at parameter (u, v).
+ * @param[inout] ws Workspace reused across evaluations.
+ */
+template <typename T>
+void surfaceDerivatives(const Surface<T> &srf, int num_ders, T u, T v,
+                        array2<glm::vec<3, T>> &surf_ders, EvalWorkspace<T> &ws)
+{
+    internal::surfaceDerivatives(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                                 srf.control_points, num_ders, u, v, surf_ders, ws);
+}
+
 /**
  * Evaluate derivatives on a rational NURBS surface
  * @param[in] srf RationalSurface object
@@ -425,67 +2195,268 @@ array2<glm::vec<3, T>> surfaceDerivatives(const Surface<T> &srf, int num_ders, T
 template <typename T>
 array2<glm::vec<3, T>> surfaceDerivatives(const RationalSurface<T> &srf, int num_ders, T u, T v)
 {
+    EvalWorkspace<T> ws;
+    array2<glm::vec<3, T>> surf_ders;
+    surfaceDerivatives(srf, num_ders, u, v, surf_ders, ws);
+    return surf_ders;
+}
+
+/**
+ * Evaluate derivatives on a rational NURBS surface without allocating
+ * @param[in] srf RationalSurface object
+ * @param[in] num_ders Number of times to differentiate
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @param[out] surf_ders Derivatives on the surface at parameter (u, v).
+ * @param[inout] ws Workspace reused across evaluations.
+ */
+template <typename T>
+void surfaceDerivatives(const RationalSurface<T> &srf, int num_ders, T u, T v,
+                        array2<glm::vec<3, T>> &surf_ders, EvalWorkspace<T> &ws)
+{
+    internal::surfaceDerivatives(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                                 srf.control_points, srf.weights, num_ders, u, v, surf_ders, ws);
+}
 
-    using namespace std;
-    using namespace glm;
+/**
+ * Evaluate derivatives on a rational NURBS surface stored in homogenous coordinates
+ * @param[in] srf HomogenousSurface object
+ * @param[in] num_ders Number of times to differentiate
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @return Derivatives on the surface at parameter (u, v).
+ */
+template <typename T>
+array2<glm::vec<3, T>> surfaceDerivatives(const HomogenousSurface<T> &srf, int num_ders, T u, T v)
+{
+    EvalWorkspace<T> ws;
+    array2<glm::vec<3, T>> surf_ders;
+    surfaceDerivatives(srf, num_ders, u, v, surf_ders, ws);
+    return surf_ders;
+}
 
-    typedef vec<3, T> tvecn;
-    typedef vec<4, T> tvecnp1;
+/**
+ * Evaluate derivatives on a rational NURBS surface stored in homogenous
+ * coordinates without allocating
+ * @param[in] srf HomogenousSurface object
+ * @param[in] num_ders Number of times to differentiate
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @param[out] surf_ders Derivatives on the surface at parameter (u, v).
+ * @param[inout] ws Workspace reused across evaluations.
+ */
+template <typename T>
+void surfaceDerivatives(const HomogenousSurface<T> &srf, int num_ders, T u, T v,
+                        array2<glm::vec<3, T>> &surf_ders, EvalWorkspace<T> &ws)
+{
+    internal::surfaceDerivatives(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                                 srf.control_points, num_ders, u, v, ws.surf_dersw, ws);
+    internal::rationalSurfaceDerivatives(ws.surf_dersw, surf_ders, ws);
+}
 
-    array2<tvecnp1> homo_cp;
-    homo_cp.resize(srf.control_points.rows(), srf.control_points.cols());
-    for (int i = 0; i < srf.control_points.rows(); ++i)
-    {
-        for (int j = 0; j < srf.control_points.cols(); ++j)
-        {
-            homo_cp(i, j) =
-                util::cartesianToHomogenous(srf.control_points(i, j), srf.weights(i, j));
-        }
-    }
+/**
+ * Evaluate derivatives on a NURBS surface stored as coordinate planes
+ * @param[in] srf SoaSurface object
+ * @param[in] num_ders Number of times to differentiate
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @return Derivatives on the surface at parameter (u, v).
+ */
+template <typename T>
+array2<glm::vec<3, T>> surfaceDerivatives(const SoaSurface<T> &srf, int num_ders, T u, T v)
+{
+    EvalWorkspace<T> ws;
+    array2<glm::vec<3, T>> surf_ders;
+    internal::surfaceDerivatives(srf, num_ders, u, v, surf_ders, ws);
+    return surf_ders;
+}
 
-    array2<tvecnp1> homo_ders = internal::surfaceDerivatives(
-        srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v, homo_cp, num_ders, u, v);
+/**
+ * Evaluate derivatives on a NURBS surface stored as coordinate planes without
+ * allocating
+ * @param[in] srf SoaSurface object
+ * @param[in] num_ders Number of times to differentiate
+ * @param[in] u Parameter to evaluate the surface at.
+ * @param[in] v Parameter to evaluate the surface at.
+ * @param[out] surf_ders Derivatives on the surface at parameter (u, v).
+ * @param[inout] ws Workspace reused across evaluations.
+ */
+template <typename T>
+void surfaceDerivatives(const SoaSurface<T> &srf, int num_ders, T u, T v,
+                        array2<glm::vec<3, T>> &surf_ders, EvalWorkspace<T> &ws)
+{
+    internal::surfaceDerivatives(srf, num_ders, u, v, surf_ders, ws);
+}
 
-    array2<tvecn> Aders;
-    Aders.resize(num_ders + 1, num_ders + 1);
-    for (int i = 0; i < homo_ders.rows(); ++i)
-    {
-        for (int j = 0; j < homo_ders.cols(); ++j)
-        {
-            Aders(i, j) = util::truncateHomogenous(homo_ders(i, j));
-        }
-    }
+/**
+ * Evaluate the point, unit tangents and unit normal of a non-rational surface at the
+ * given parameters in one pass over the basis functions
+ * @param[in] srf Surface object
+ * @param[in] u Parameter in the u-direction
+ * @param[in] v Parameter in the v-direction
+ * @param[inout] ws Workspace providing scratch buffers and the span hints
+ * @return Tuple with the point, unit tangents along u- and v-directions, and unit normal
+ */
+template <typename T>
+std::tuple<glm::vec<3, T>, glm::vec<3, T>, glm::vec<3, T>, glm::vec<3, T>>
+surfaceFrame(const Surface<T> &srf, T u, T v, EvalWorkspace<T> &ws)
+{
+    glm::vec<3, T> point, tangent_u, tangent_v, normal;
+    internal::surfaceFrame(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                           srf.control_points, u, v, point, tangent_u, tangent_v, normal, ws);
+    return std::make_tuple(point, tangent_u, tangent_v, normal);
+}
 
-    array2<tvecn> surf_ders(num_ders + 1, num_ders + 1);
-    for (int k = 0; k < num_ders + 1; ++k)
-    {
-        for (int l = 0; l < num_ders - k + 1; ++l)
-        {
-            auto der = Aders(k, l);
+/**
+ * Evaluate the point, unit tangents and unit normal of a non-rational surface at the
+ * given parameters in one pass over the basis functions
+ * @param[in] srf Surface object
+ * @param[in] u Parameter in the u-direction
+ * @param[in] v Parameter in the v-direction
+ * @return Tuple with the point, unit tangents along u- and v-directions, and unit normal
+ */
+template <typename T>
+std::tuple<glm::vec<3, T>, glm::vec<3, T>, glm::vec<3, T>, glm::vec<3, T>>
+surfaceFrame(const Surface<T> &srf, T u, T v)
+{
+    EvalWorkspace<T> ws;
+    return surfaceFrame(srf, u, v, ws);
+}
 
-            for (int j = 1; j < l + 1; ++j)
-            {
-                der -= (T)util::binomial(l, j) * homo_ders(0, j).w * surf_ders(k, l - j);
-            }
+/**
+ * Evaluate points, unit tangents and unit normals of a non-rational surface over the
+ * tensor-product grid of the given parameters
+ * @param[in] srf Surface object
+ * @param[in] us Parameters along u-direction
+ * @param[in] vs Parameters along v-direction
+ * @param[out] points Points, where points(i, j) is the point at (us[i], vs[j])
+ * @param[out] tangents_u Unit tangents along u at the grid points
+ * @param[out] tangents_v Unit tangents along v at the grid points
+ * @param[out] normals Unit normals at the grid points
+ */
+template <typename T>
+void surfaceFrameGrid(const Surface<T> &srf, const std::vector<T> &us, const std::vector<T> &vs,
+                      array2<glm::vec<3, T>> &points, array2<glm::vec<3, T>> &tangents_u,
+                      array2<glm::vec<3, T>> &tangents_v, array2<glm::vec<3, T>> &normals)
+{
+    internal::surfaceFrameGrid(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                               srf.control_points, us, vs, points, tangents_u, tangents_v,
+                               normals);
+}
 
-            for (int i = 1; i < k + 1; ++i)
-            {
-                der -= (T)util::binomial(k, i) * homo_ders(i, 0).w * surf_ders(k - i, l);
+/**
+ * Evaluate the point, unit tangents and unit normal of a rational surface at the
+ * given parameters in one pass over the basis functions
+ * @param[in] srf RationalSurface object
+ * @param[in] u Parameter in the u-direction
+ * @param[in] v Parameter in the v-direction
+ * @param[inout] ws Workspace providing scratch buffers and the span hints
+ * @return Tuple with the point, unit tangents along u- and v-directions, and unit normal
+ */
+template <typename T>
+std::tuple<glm::vec<3, T>, glm::vec<3, T>, glm::vec<3, T>, glm::vec<3, T>>
+surfaceFrame(const RationalSurface<T> &srf, T u, T v, EvalWorkspace<T> &ws)
+{
+    glm::vec<3, T> point, tangent_u, tangent_v, normal;
+    internal::surfaceFrame(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                           srf.control_points, srf.weights, u, v, point, tangent_u, tangent_v,
+                           normal, ws);
+    return std::make_tuple(point, tangent_u, tangent_v, normal);
+}
 
-                tvecn tmp((T)0.0);
-                for (int j = 1; j < l + 1; ++j)
-                {
-                    tmp -= (T)util::binomial(l, j) * homo_ders(i, j).w * surf_ders(k - 1, l - j);
-                }
+/**
+ * Evaluate the point, unit tangents and unit normal of a rational surface at the
+ * given parameters in one pass over the basis functions
+ * @param[in] srf RationalSurface object
+ * @param[in] u Parameter in the u-direction
+ * @param[in] v Parameter in the v-direction
+ * @return Tuple with the point, unit tangents along u- and v-directions, and unit normal
+ */
+template <typename T>
+std::tuple<glm::vec<3, T>, glm::vec<3, T>, glm::vec<3, T>, glm::vec<3, T>>
+surfaceFrame(const RationalSurface<T> &srf, T u, T v)
+{
+    EvalWorkspace<T> ws;
+    return surfaceFrame(srf, u, v, ws);
+}
 
-                der -= (T)util::binomial(k, i) * tmp;
-            }
+/**
+ * Evaluate points, unit tangents and unit normals of a rational surface over the
+ * tensor-product grid of the given parameters
+ * @param[in] srf RationalSurface object
+ * @param[in] us Parameters along u-direction
+ * @param[in] vs Parameters along v-direction
+ * @param[out] points Points, where points(i, j) is the point at (us[i], vs[j])
+ * @param[out] tangents_u Unit tangents along u at the grid points
+ * @param[out] tangents_v Unit tangents along v at the grid points
+ * @param[out] normals Unit normals at the grid points
+ */
+template <typename T>
+void surfaceFrameGrid(const RationalSurface<T> &srf, const std::vector<T> &us,
+                      const std::vector<T> &vs, array2<glm::vec<3, T>> &points,
+                      array2<glm::vec<3, T>> &tangents_u, array2<glm::vec<3, T>> &tangents_v,
+                      array2<glm::vec<3, T>> &normals)
+{
+    internal::surfaceFrameGrid(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                               srf.control_points, srf.weights, us, vs, points, tangents_u,
+                               tangents_v, normals);
+}
 
-            der *= 1 / homo_ders(0, 0).w;
-            surf_ders(k, l) = der;
-        }
-    }
-    return surf_ders;
+/**
+ * Evaluate the point, unit tangents and unit normal of a rational surface stored in homogenous
+ * coordinates at the given parameters in one pass over the basis functions
+ * @param[in] srf HomogenousSurface object
+ * @param[in] u Parameter in the u-direction
+ * @param[in] v Parameter in the v-direction
+ * @param[inout] ws Workspace providing scratch buffers and the span hints
+ * @return Tuple with the point, unit tangents along u- and v-directions, and unit normal
+ */
+template <typename T>
+std::tuple<glm::vec<3, T>, glm::vec<3, T>, glm::vec<3, T>, glm::vec<3, T>>
+surfaceFrame(const HomogenousSurface<T> &srf, T u, T v, EvalWorkspace<T> &ws)
+{
+    glm::vec<3, T> point, tangent_u, tangent_v, normal;
+    internal::surfaceFrame(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                           srf.control_points, u, v, point, tangent_u, tangent_v, normal, ws);
+    return std::make_tuple(point, tangent_u, tangent_v, normal);
+}
+
+/**
+ * Evaluate the point, unit tangents and unit normal of a rational surface stored in homogenous
+ * coordinates at the given parameters in one pass over the basis functions
+ * @param[in] srf HomogenousSurface object
+ * @param[in] u Parameter in the u-direction
+ * @param[in] v Parameter in the v-direction
+ * @return Tuple with the point, unit tangents along u- and v-directions, and unit normal
+ */
+template <typename T>
+std::tuple<glm::vec<3, T>, glm::vec<3, T>, glm::vec<3, T>, glm::vec<3, T>>
+surfaceFrame(const HomogenousSurface<T> &srf, T u, T v)
+{
+    EvalWorkspace<T> ws;
+    return surfaceFrame(srf, u, v, ws);
+}
+
+/**
+ * Evaluate points, unit tangents and unit normals of a rational surface stored in homogenous
+ * coordinates over the tensor-product grid of the given parameters
+ * @param[in] srf HomogenousSurface object
+ * @param[in] us Parameters along u-direction
+ * @param[in] vs Parameters along v-direction
+ * @param[out] points Points, where points(i, j) is the point at (us[i], vs[j])
+ * @param[out] tangents_u Unit tangents along u at the grid points
+ * @param[out] tangents_v Unit tangents along v at the grid points
+ * @param[out] normals Unit normals at the grid points
+ */
+template <typename T>
+void surfaceFrameGrid(const HomogenousSurface<T> &srf, const std::vector<T> &us,
+                      const std::vector<T> &vs, array2<glm::vec<3, T>> &points,
+                      array2<glm::vec<3, T>> &tangents_u, array2<glm::vec<3, T>> &tangents_v,
+                      array2<glm::vec<3, T>> &normals)
+{
+    internal::surfaceFrameGrid(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                               srf.control_points, us, vs, points, tangents_u, tangents_v,
+                               normals);
 }
 
 /**
@@ -499,19 +2470,8 @@ array2<glm::vec<3, T>> surfaceDerivatives(const RationalSurface<T> &srf, int num
 template <typename T>
 std::tuple<glm::vec<3, T>, glm::vec<3, T>> surfaceTangent(const Surface<T> &srf, T u, T v)
 {
-    array2<glm::vec<3, T>> ptder = surfaceDerivatives(srf, 1, u, v);
-    glm::vec<3, T> du = ptder(1, 0);
-    glm::vec<3, T> dv = ptder(0, 1);
-    T du_len = glm::length(ptder(1, 0));
-    T dv_len = glm::length(ptder(0, 1));
-    if (!util::close(du_len, T(0)))
-    {
-        du /= du_len;
-    }
-    if (!util::close(dv_len, T(0)))
-    {
-        dv /= dv_len;
-    }
+    glm::vec<3, T> point, du, dv, n;
+    std::tie(point, du, dv, n) = surfaceFrame(srf, u, v);
     return std::make_tuple(std::move(du), std::move(dv));
 }
 
@@ -526,19 +2486,25 @@ std::tuple<glm::vec<3, T>, glm::vec<3, T>> surfaceTangent(const Surface<T> &srf,
 template <typename T>
 std::tuple<glm::vec<3, T>, glm::vec<3, T>> surfaceTangent(const RationalSurface<T> &srf, T u, T v)
 {
-    array2<glm::vec<3, T>> ptder = surfaceDerivatives(srf, 1, u, v);
-    glm::vec<3, T> du = ptder(1, 0);
-    glm::vec<3, T> dv = ptder(0, 1);
-    T du_len = glm::length(ptder(1, 0));
-    T dv_len = glm::length(ptder(0, 1));
-    if (!util::close(du_len, T(0)))
-    {
-        du /= du_len;
-    }
-    if (!util::close(dv_len, T(0)))
-    {
-        dv /= dv_len;
-    }
+    glm::vec<3, T> point, du, dv, n;
+    std::tie(point, du, dv, n) = surfaceFrame(srf, u, v);
+    return std::make_tuple(std::move(du), std::move(dv));
+}
+
+/**
+ * Evaluate the two orthogonal tangents of a rational surface stored in
+ * homogenous coordinates at the given parameters
+ * @param[in] srf HomogenousSurface object
+ * @param u Parameter in the u-direction
+ * @param v Parameter in the v-direction
+ * @return Tuple with unit tangents along u- and v-directions
+ */
+template <typename T>
+std::tuple<glm::vec<3, T>, glm::vec<3, T>> surfaceTangent(const HomogenousSurface<T> &srf, T u,
+                                                          T v)
+{
+    glm::vec<3, T> point, du, dv, n;
+    std::tie(point, du, dv, n) = surfaceFrame(srf, u, v);
     return std::make_tuple(std::move(du), std::move(dv));
 }
 
@@ -551,13 +2517,8 @@ std::tuple<glm::vec<3, T>, glm::vec<3, T>> surfaceTangent(const RationalSurface<
  */
 template <typename T> glm::vec<3, T> surfaceNormal(const Surface<T> &srf, T u, T v)
 {
-    array2<glm::vec<3, T>> ptder = surfaceDerivatives(srf, 1, u, v);
-    glm::vec<3, T> n = glm::cross(ptder(0, 1), ptder(1, 0));
-    T n_len = glm::length(n);
-    if (!util::close(n_len, T(0)))
-    {
-        n /= n_len;
-    }
+    glm::vec<3, T> point, du, dv, n;
+    std::tie(point, du, dv, n) = surfaceFrame(srf, u, v);
     return n;
 }
 
@@ -570,13 +2531,23 @@ template <typename T> glm::vec<3, T> surfaceNormal(const Surface<T> &srf, T u, T
  */
 template <typename T> glm::vec<3, T> surfaceNormal(const RationalSurface<T> &srf, T u, T v)
 {
-    array2<glm::vec<3, T>> ptder = surfaceDerivatives(srf, 1, u, v);
-    glm::vec<3, T> n = glm::cross(ptder(0, 1), ptder(1, 0));
-    T n_len = glm::length(n);
-    if (!util::close(n_len, T(0)))
-    {
-        n /= n_len;
-    }
+    glm::vec<3, T> point, du, dv, n;
+    std::tie(point, du, dv, n) = surfaceFrame(srf, u, v);
+    return n;
+}
+
+/**
+ * Evaluate the normal of a rational surface stored in homogenous coordinates at
+ * the given parameters
+ * @param[in] srf HomogenousSurface object
+ * @param u Parameter in the u-direction
+ * @param v Parameter in the v-direction
+ * @return Unit normal at of the surface at (u, v)
+ */
+template <typename T> glm::vec<3, T> surfaceNormal(const HomogenousSurface<T> &srf, T u, T v)
+{
+    glm::vec<3, T> point, du, dv, n;
+    std::tie(point, du, dv, n) = surfaceFrame(srf, u, v);
     return n;
 }
 
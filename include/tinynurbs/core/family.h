@@ -0,0 +1,330 @@
+/**
+ * Families of curves sharing one degree and knot vector, evaluated together
+ * with a single set of basis functions.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found in
+ * the LICENSE file.
+ */
+
+#ifndef TINYNURBS_FAMILY_H
+#define TINYNURBS_FAMILY_H
+
+#include "../util/array2.h"
+#include "../util/util.h"
+#include "basis.h"
+#include "curve.h"
+#include "evaluate.h"
+#include "glm/glm.hpp"
+#include "workspace.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace tinynurbs
+{
+
+/**
+Struct for representing many curves with the same degree and knot vector. The
+control points are stored in homogenous coordinates, with control point i of
+curve c at control_points(i, c), so that the points of all curves with the same
+index are contiguous. Weights of non-rational families are all 1.
+\tparam T Data type of control points and knots (float or double)
+*/
+template <typename T> struct CurveFamily
+{
+    unsigned int degree = 0;
+    std::vector<T> knots;
+    array2<glm::vec<4, T>> control_points;
+    // Whether to divide by the weights when evaluating
+    bool rational = false;
+
+    CurveFamily() = default;
+    CurveFamily(unsigned int degree, const std::vector<T> &knots, size_t num_curves,
+                bool rational = false)
+        : degree(degree), knots(knots),
+          control_points(knots.size() - degree - 1, num_curves, glm::vec<4, T>(0, 0, 0, 1)),
+          rational(rational)
+    {
+    }
+    CurveFamily(const std::vector<Curve<T>> &curves)
+    {
+        init(curves, false);
+    }
+    CurveFamily(const std::vector<RationalCurve<T>> &curves)
+    {
+        init(curves, true);
+    }
+
+    /**
+     * Number of curves in the family
+     */
+    size_t size() const
+    {
+        return control_points.cols();
+    }
+
+    /**
+     * Replace the control points of one curve of the family
+     * @param[in] c Index of the curve.
+     * @param[in] crv Curve with the degree and knots of the family.
+     */
+    void setCurve(size_t c, const Curve<T> &crv)
+    {
+        check(crv.degree, crv.knots);
+        for (size_t i = 0; i < crv.control_points.size(); ++i)
+        {
+            control_points(i, c) = glm::vec<4, T>(crv.control_points[i], 1);
+        }
+    }
+
+    /**
+     * Replace the control points and weights of one curve of the family
+     * @param[in] c Index of the curve.
+     * @param[in] crv RationalCurve with the degree and knots of the family.
+     */
+    void setCurve(size_t c, const RationalCurve<T> &crv)
+    {
+        if (!rational)
+        {
+            throw std::runtime_error("Rational curves can only join a rational family");
+        }
+        check(crv.degree, crv.knots);
+        for (size_t i = 0; i < crv.control_points.size(); ++i)
+        {
+            control_points(i, c) =
+                util::cartesianToHomogenous(crv.control_points[i], crv.weights[i]);
+        }
+    }
+
+  private:
+    template <typename CurveType> void init(const std::vector<CurveType> &curves, bool rational)
+    {
+        if (curves.empty())
+        {
+            throw std::runtime_error("Curve family needs at least one curve");
+        }
+        degree = curves[0].degree;
+        knots = curves[0].knots;
+        this->rational = rational;
+        control_points.resize(knots.size() - degree - 1, curves.size());
+        for (size_t c = 0; c < curves.size(); ++c)
+        {
+            setCurve(c, curves[c]);
+        }
+    }
+
+    void check(unsigned int crv_degree, const std::vector<T> &crv_knots) const
+    {
+        if (crv_degree != degree || crv_knots != knots)
+        {
+            throw std::runtime_error("Curves of a family must have the same degree and knots");
+        }
+    }
+};
+
+namespace internal
+{
+
+/**
+ * Weighted sum of degree + 1 consecutive rows of control points of a family,
+ * computed as one multiply-add over contiguous memory per basis function
+ * @param[in] basis Non-zero basis functions, or one row of their derivatives.
+ * @param[in] degree Degree of the family.
+ * @param[in] control_points Control points of the family.
+ * @param[in] first Index of the first row of control points.
+ * @param[out] out Weighted sum for each curve of the family.
+ */
+template <typename T>
+void familyCombine(const T *basis, unsigned int degree,
+                   const array2<glm::vec<4, T>> &control_points, int first, glm::vec<4, T> *out)
+{
+    const size_t n = 4 * control_points.cols();
+    T *acc = &out->x;
+    std::fill(acc, acc + n, T(0));
+    for (unsigned int j = 0; j <= degree; ++j)
+    {
+        const T *row = &control_points.data()[(first + j) * control_points.cols()].x;
+        const T b = basis[j];
+        for (size_t k = 0; k < n; ++k)
+        {
+            acc[k] += b * row[k];
+        }
+    }
+}
+
+} // namespace internal
+
+/////////////////////////////////////////////////////////////////////
+
+/**
+ * Evaluate all curves of a family at one parameter
+ * @param[in] family CurveFamily object
+ * @param[in] u Parameter to evaluate the curves at.
+ * @param[out] points Point of each curve at u.
+ * @param[inout] ws Workspace reused across evaluations.
+ */
+template <typename T>
+void curveFamilyPoints(const CurveFamily<T> &family, T u, std::vector<glm::vec<3, T>> &points,
+                       EvalWorkspace<T> &ws)
+{
+    const size_t num_curves = family.size();
+    points.resize(num_curves);
+    if (num_curves == 0)
+    {
+        return;
+    }
+
+    int span = ws.findSpanU(family.degree, family.knots, u);
+    bsplineBasis(family.degree, span, family.knots, u, ws.basis_u);
+    ws.family_dersw.resize(1, num_curves);
+    internal::familyCombine(ws.basis_u.data(), family.degree, family.control_points,
+                            span - family.degree, &ws.family_dersw(0, 0));
+
+    for (size_t c = 0; c < num_curves; ++c)
+    {
+        const glm::vec<4, T> &ptw = ws.family_dersw(0, c);
+        points[c] = family.rational ? util::homogenousToCartesian(ptw)
+                                    : util::truncateHomogenous(ptw);
+    }
+}
+
+/**
+ * Evaluate all curves of a family at one parameter
+ * @param[in] family CurveFamily object
+ * @param[in] u Parameter to evaluate the curves at.
+ * @return Point of each curve at u.
+ */
+template <typename T>
+std::vector<glm::vec<3, T>> curveFamilyPoints(const CurveFamily<T> &family, T u)
+{
+    EvalWorkspace<T> ws;
+    std::vector<glm::vec<3, T>> points;
+    curveFamilyPoints(family, u, points, ws);
+    return points;
+}
+
+/**
+ * Evaluate all curves of a family at many parameters
+ * @param[in] family CurveFamily object
+ * @param[in] params Parameters to evaluate the curves at.
+ * @param[out] points Point of curve c at params[i] in points(i, c).
+ * @param[inout] ws Workspace reused across evaluations.
+ */
+template <typename T>
+void curveFamilyPoints(const CurveFamily<T> &family, const std::vector<T> &params,
+                       array2<glm::vec<3, T>> &points, EvalWorkspace<T> &ws)
+{
+    const size_t num_curves = family.size();
+    points.resize(params.size(), num_curves);
+    if (num_curves == 0)
+    {
+        return;
+    }
+
+    ws.family_dersw.resize(1, num_curves);
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        int span = ws.findSpanU(family.degree, family.knots, params[i]);
+        bsplineBasis(family.degree, span, family.knots, params[i], ws.basis_u);
+        internal::familyCombine(ws.basis_u.data(), family.degree, family.control_points,
+                                span - family.degree, &ws.family_dersw(0, 0));
+        for (size_t c = 0; c < num_curves; ++c)
+        {
+            const glm::vec<4, T> &ptw = ws.family_dersw(0, c);
+            points(i, c) = family.rational ? util::homogenousToCartesian(ptw)
+                                           : util::truncateHomogenous(ptw);
+        }
+    }
+}
+
+/**
+ * Evaluate all curves of a family at many parameters
+ * @param[in] family CurveFamily object
+ * @param[in] params Parameters to evaluate the curves at.
+ * @param[out] points Point of curve c at params[i] in points(i, c).
+ */
+template <typename T>
+void curveFamilyPoints(const CurveFamily<T> &family, const std::vector<T> &params,
+                       array2<glm::vec<3, T>> &points)
+{
+    EvalWorkspace<T> ws;
+    curveFamilyPoints(family, params, points, ws);
+}
+
+/**
+ * Evaluate derivatives of all curves of a family at one parameter
+ * @param[in] family CurveFamily object
+ * @param[in] num_ders Number of times to differentiate.
+ * @param[in] u Parameter to evaluate the derivatives at.
+ * @param[out] curve_ders The kth derivative of curve c at u in curve_ders(c, k).
+ * @param[inout] ws Workspace reused across evaluations.
+ */
+template <typename T>
+void curveFamilyDerivatives(const CurveFamily<T> &family, int num_ders, T u,
+                            array2<glm::vec<3, T>> &curve_ders, EvalWorkspace<T> &ws)
+{
+    const size_t num_curves = family.size();
+    curve_ders.resize(num_curves, num_ders + 1);
+    if (num_curves == 0)
+    {
+        return;
+    }
+
+    int span = ws.findSpanU(family.degree, family.knots, u);
+    bsplineDerBasis(family.degree, span, family.knots, u, num_ders, ws.ders_u, ws.ndu, ws.a);
+
+    // Derivatives above the degree are zero
+    const int du = std::min(num_ders, static_cast<int>(family.degree));
+    ws.family_dersw.resize(num_ders + 1, num_curves);
+    for (int k = 0; k <= num_ders; ++k)
+    {
+        if (k <= du)
+        {
+            internal::familyCombine(&ws.ders_u(k, 0), family.degree, family.control_points,
+                                    span - family.degree, &ws.family_dersw(k, 0));
+        }
+        else
+        {
+            std::fill(&ws.family_dersw(k, 0), &ws.family_dersw(k, 0) + num_curves,
+                      glm::vec<4, T>(0.0));
+        }
+    }
+
+    ws.curve_wders.resize(num_ders + 1);
+    for (size_t c = 0; c < num_curves; ++c)
+    {
+        for (int k = 0; k <= num_ders; ++k)
+        {
+            curve_ders(c, k) = util::truncateHomogenous(ws.family_dersw(k, c));
+            ws.curve_wders[k] = ws.family_dersw(k, c).w;
+        }
+        if (family.rational)
+        {
+            internal::curveQuotientRule(ws.curve_wders.data(), ws.binomials(num_ders), num_ders,
+                                        &curve_ders(c, 0));
+        }
+    }
+}
+
+/**
+ * Evaluate derivatives of all curves of a family at one parameter
+ * @param[in] family CurveFamily object
+ * @param[in] num_ders Number of times to differentiate.
+ * @param[in] u Parameter to evaluate the derivatives at.
+ * @param[out] curve_ders The kth derivative of curve c at u in curve_ders(c, k).
+ */
+template <typename T>
+void curveFamilyDerivatives(const CurveFamily<T> &family, int num_ders, T u,
+                            array2<glm::vec<3, T>> &curve_ders)
+{
+    EvalWorkspace<T> ws;
+    curveFamilyDerivatives(family, num_ders, u, curve_ders, ws);
+}
+
+// Typedefs for ease of use
+typedef CurveFamily<float> CurveFamily3f;
+typedef CurveFamily<double> CurveFamily3d;
+
+} // namespace tinynurbs
+
+#endif // TINYNURBS_FAMILY_H
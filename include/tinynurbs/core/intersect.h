@@ -0,0 +1,623 @@
+/**
+ * Intersection of rays with surfaces, for ray tracing models without meshing
+ * them first.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found in
+ * the LICENSE file.
+ */
+
+#ifndef TINYNURBS_INTERSECT_H
+#define TINYNURBS_INTERSECT_H
+
+#include "../util/array2.h"
+#include "../util/parallel.h"
+#include "../util/util.h"
+#include "bvh.h"
+#include "evaluate.h"
+#include "glm/glm.hpp"
+#include "surface.h"
+#include "workspace.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace tinynurbs
+{
+
+/**
+Struct for representing a ray, the points origin + t * direction for t in
+[t_min, t_max]. The direction does not need to be normalized.
+\tparam T Data type of the ray (float or double)
+*/
+template <typename T> struct Ray
+{
+    glm::vec<3, T> origin, direction;
+    T t_min = 0;
+    T t_max = std::numeric_limits<T>::infinity();
+
+    Ray() = default;
+    Ray(const glm::vec<3, T> &origin, const glm::vec<3, T> &direction, T t_min = 0,
+        T t_max = std::numeric_limits<T>::infinity())
+        : origin(origin), direction(direction), t_min(t_min), t_max(t_max)
+    {
+    }
+};
+
+/**
+Struct for representing the first intersection of a ray with a surface
+\tparam T Data type of the hit (float or double)
+*/
+template <typename T> struct RayHit
+{
+    bool hit = false;
+    // Ray parameter of the hit point
+    T t = std::numeric_limits<T>::infinity();
+    // Surface parameters of the hit point
+    glm::vec<2, T> uv = glm::vec<2, T>(0);
+    // Unit normal along the cross product of the u and v tangents, which is not
+    // flipped to face the ray
+    glm::vec<3, T> normal = glm::vec<3, T>(0);
+};
+
+namespace internal
+{
+
+template <typename T> glm::vec<4, T> rayHomogenous(const glm::vec<3, T> &pt)
+{
+    return util::cartesianToHomogenous(pt, T(1));
+}
+
+template <typename T> glm::vec<4, T> rayHomogenous(const glm::vec<4, T> &pt)
+{
+    return pt;
+}
+
+/**
+ * Compute the Bezier control points of every leaf of a surface BVH in
+ * homogenous coordinates
+ * @param[in] degree_u Degree of the surface along u.
+ * @param[in] degree_v Degree of the surface along v.
+ * @param[in] knots_u Knot vector of the surface along u.
+ * @param[in] knots_v Knot vector of the surface along v.
+ * @param[in] cps Control points of the surface.
+ * @param[in] bvh BVH of the surface.
+ * @param[out] patches The (degree_u + 1) x (degree_v + 1) control points of
+ * each leaf in turn, stored row by row.
+ */
+template <int dim, typename T>
+void surfaceRayPatches(unsigned int degree_u, unsigned int degree_v,
+                       const std::vector<T> &knots_u, const std::vector<T> &knots_v,
+                       const array2<glm::vec<dim, T>> &cps, const Bvh<T> &bvh,
+                       std::vector<glm::vec<4, T>> &patches)
+{
+    const size_t size = (degree_u + 1) * (degree_v + 1);
+    std::vector<glm::vec<dim, T>> bezier, work;
+    patches.resize(bvh.leaves.size() * size);
+    for (size_t k = 0; k < bvh.leaves.size(); ++k)
+    {
+        surfaceBvhBezier(degree_u, degree_v, knots_u, knots_v, cps, bvh.leaves[k], bezier, work);
+        for (size_t i = 0; i < size; ++i)
+        {
+            patches[k * size + i] = rayHomogenous(bezier[i]);
+        }
+    }
+}
+
+template <typename T>
+void surfaceRayPatches(const Surface<T> &srf, const Bvh<T> &bvh,
+                       std::vector<glm::vec<4, T>> &patches)
+{
+    surfaceRayPatches(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v, srf.control_points,
+                      bvh, patches);
+}
+
+template <typename T>
+void surfaceRayPatches(const RationalSurface<T> &srf, const Bvh<T> &bvh,
+                       std::vector<glm::vec<4, T>> &patches)
+{
+    surfaceRayPatches(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                      util::cartesianToHomogenous(srf.control_points, srf.weights), bvh,
+                      patches);
+}
+
+/**
+Intersects rays with a surface. The knot spans are split into a BVH whose boxes
+are tested against the ray front to back. In a leaf, the Bezier patch is
+projected onto two planes containing the ray, where the ray becomes the origin
+and, since weights are positive, the rational patch can be replaced by the
+polynomial patch of its homogenous coordinates. Patches whose control points
+do not surround the origin, or lie beyond the closest hit, are discarded, and
+the others are halved with de Casteljau's algorithm until Newton iteration on
+the surface converges in a patch that cannot hold more than one hit. This
+keeps the closest hit on surfaces that fold back onto themselves, such as thin
+closed tubes. Safe to share between threads with one Scratch each.
+\tparam T Data type of control points and knots (float or double)
+\tparam SurfaceType Surface or RationalSurface
+*/
+template <typename T, typename SurfaceType> class SurfaceRayCaster
+{
+  public:
+    /**
+    Rectangle of parameters of a sub-patch, whose projected control points are
+    stored at an offset in Scratch::points
+    */
+    struct Patch
+    {
+        glm::vec<2, T> lo, hi;
+        size_t offset;
+        unsigned int depth;
+    };
+
+    /**
+    Buffers of one thread
+    */
+    struct Scratch
+    {
+        EvalWorkspace<T> ws;
+        array2<glm::vec<3, T>> ders;
+        std::vector<unsigned int> nodes;
+        std::vector<Patch> patches;
+        std::vector<glm::vec<4, T>> points;
+    };
+
+    explicit SurfaceRayCaster(const SurfaceType &srf)
+        : srf(srf), bvh(surfaceBvh(srf, 2)), rows(srf.degree_u + 1), cols(srf.degree_v + 1)
+    {
+        surfaceRayPatches(srf, bvh, beziers);
+        domain_lo = glm::vec<2, T>(std::numeric_limits<T>::infinity());
+        domain_hi = -domain_lo;
+        for (const BvhLeaf<T> &leaf : bvh.leaves)
+        {
+            domain_lo = glm::min(domain_lo, leaf.lo);
+            domain_hi = glm::max(domain_hi, leaf.hi);
+        }
+    }
+
+    /**
+     * Find the first intersection of a ray with the surface
+     * @param[in] ray Ray to intersect.
+     * @param[inout] scratch Buffers of the calling thread.
+     * @return Closest hit in the range of the ray, if any
+     */
+    RayHit<T> intersect(const Ray<T> &ray, Scratch &scratch) const
+    {
+        RayHit<T> hit;
+        hit.t = ray.t_max;
+        const T dir_len = glm::length(ray.direction);
+        if (bvh.empty() || !(dir_len > 0))
+        {
+            return hit;
+        }
+        // Frame with the first axis along the ray, whose other axes span the
+        // planes the patches are projected onto
+        glm::vec<3, T> axes[3];
+        orthonormalFrame(ray.direction, glm::vec<3, T>(0), axes);
+
+        std::vector<unsigned int> &stack = scratch.nodes;
+        stack.clear();
+        T enter;
+        if (boxHit(bvh.nodes[0], ray, hit.t, enter))
+        {
+            stack.push_back(0);
+        }
+        while (!stack.empty())
+        {
+            const unsigned int index = stack.back();
+            const BvhNode<T> &node = bvh.nodes[index];
+            stack.pop_back();
+            if (node.isLeaf())
+            {
+                leafIntersect(ray, axes, dir_len, node.leaf, hit, scratch);
+                continue;
+            }
+            // Visit the child the ray enters first next
+            const unsigned int first = index + 1;
+            T enter_first, enter_second;
+            const bool hit_first = boxHit(bvh.nodes[first], ray, hit.t, enter_first);
+            const bool hit_second = boxHit(bvh.nodes[node.right], ray, hit.t, enter_second);
+            if (hit_first && hit_second)
+            {
+                const bool first_nearer = enter_first <= enter_second;
+                stack.push_back(first_nearer ? node.right : first);
+                stack.push_back(first_nearer ? first : node.right);
+            }
+            else if (hit_first || hit_second)
+            {
+                stack.push_back(hit_first ? first : node.right);
+            }
+        }
+        if (!hit.hit)
+        {
+            hit.t = std::numeric_limits<T>::infinity();
+        }
+        return hit;
+    }
+
+  private:
+    const SurfaceType &srf;
+    Bvh<T> bvh;
+    // Bezier control points of each leaf in homogenous coordinates
+    std::vector<glm::vec<4, T>> beziers;
+    size_t rows, cols;
+    glm::vec<2, T> domain_lo, domain_hi;
+
+    /**
+     * Clip a ray against the box of a node with the slab test
+     * @param[in] node Node of the BVH.
+     * @param[in] ray Ray to clip.
+     * @param[in] t_max End of the range of the ray to clip.
+     * @param[out] enter Ray parameter where the ray enters the box.
+     * @return Whether the ray overlaps the box within its range
+     */
+    static bool boxHit(const BvhNode<T> &node, const Ray<T> &ray, T t_max, T &enter)
+    {
+        enter = ray.t_min;
+        T t0 = ray.t_min, t1 = t_max;
+        for (int a = 0; a < 3; ++a)
+        {
+            const T o = ray.origin[a], d = ray.direction[a];
+            if (d == 0)
+            {
+                if (o < node.box_min[a] || o > node.box_max[a])
+                {
+                    return false;
+                }
+                continue;
+            }
+            T near = (node.box_min[a] - o) / d, far = (node.box_max[a] - o) / d;
+            if (near > far)
+            {
+                std::swap(near, far);
+            }
+            t0 = std::max(t0, near);
+            t1 = std::min(t1, far);
+        }
+        enter = t0;
+        return t0 <= t1;
+    }
+
+    /**
+     * Whether the projection of a patch takes each value at most once. This
+     * holds if the cross product of every difference of control points along
+     * u with every difference along v has the same sign.
+     */
+    bool injective(const glm::vec<4, T> *pts) const
+    {
+        int sign = 0;
+        for (size_t i = 0; i + 1 < rows; ++i)
+        {
+            for (size_t j = 0; j < cols; ++j)
+            {
+                const glm::vec<4, T> du = pts[(i + 1) * cols + j] - pts[i * cols + j];
+                for (size_t k = 0; k < rows; ++k)
+                {
+                    for (size_t l = 0; l + 1 < cols; ++l)
+                    {
+                        const glm::vec<4, T> dv = pts[k * cols + l + 1] - pts[k * cols + l];
+                        const T cross = du.x * dv.y - du.y * dv.x;
+                        const int s = cross > 0 ? 1 : (cross < 0 ? -1 : 0);
+                        if (s == 0 || s == -sign)
+                        {
+                            return false;
+                        }
+                        sign = s;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Split a patch in half along u or v with de Casteljau's algorithm
+     * @param[in] offset Offset of the control points of the patch in points.
+     * @param[in] along_u Whether to split along u.
+     * @param[inout] points Buffer the control points of the two halves are
+     * appended to, first half first.
+     */
+    void split(size_t offset, bool along_u, std::vector<glm::vec<4, T>> &points) const
+    {
+        const size_t size = rows * cols;
+        const size_t first = points.size();
+        points.resize(first + 2 * size);
+        glm::vec<4, T> *src = &points[offset];
+        glm::vec<4, T> *left = &points[first];
+        glm::vec<4, T> *right = left + size;
+        std::copy(src, src + size, right);
+        const size_t n = along_u ? rows : cols;
+        const size_t stride = along_u ? cols : 1;
+        for (size_t line = 0; line < (along_u ? cols : rows); ++line)
+        {
+            glm::vec<4, T> *r = right + line * (along_u ? 1 : cols);
+            glm::vec<4, T> *l = left + line * (along_u ? 1 : cols);
+            l[0] = r[0];
+            for (size_t level = 1; level < n; ++level)
+            {
+                for (size_t i = 0; i + level < n; ++i)
+                {
+                    r[i * stride] = (r[i * stride] + r[(i + 1) * stride]) / T(2);
+                }
+                l[level * stride] = r[0];
+            }
+        }
+    }
+
+    /**
+     * Solve for the parameters where the surface meets the ray with Newton
+     * iteration, starting from the center of a patch
+     * @param[in] ray Ray to intersect.
+     * @param[in] axes Frame of the ray.
+     * @param[in] patch Patch to start from.
+     * @param[out] uv Parameters of the intersection.
+     * @param[inout] scratch Buffers of the calling thread.
+     * @return Whether the iteration converged
+     */
+    bool newton(const Ray<T> &ray, const glm::vec<3, T> axes[3], const Patch &patch,
+                glm::vec<2, T> &uv, Scratch &scratch) const
+    {
+        const T eps = std::numeric_limits<T>::epsilon();
+        const int max_iters = 16;
+        const glm::vec<2, T> size = patch.hi - patch.lo;
+        uv = (patch.lo + patch.hi) / T(2);
+        for (int iter = 0; iter < max_iters; ++iter)
+        {
+            surfaceDerivatives(srf, 1, uv.x, uv.y, scratch.ders, scratch.ws);
+            const array2<glm::vec<3, T>> &ders = scratch.ders;
+            const glm::vec<3, T> q = ders(0, 0) - ray.origin;
+            const glm::vec<2, T> f(glm::dot(axes[1], q), glm::dot(axes[2], q));
+            const T tol = 32 * eps * (glm::length(ders(0, 0)) + glm::length(ray.origin));
+            if (glm::dot(f, f) <= tol * tol)
+            {
+                return true;
+            }
+            const glm::vec<2, T> ju(glm::dot(axes[1], ders(1, 0)), glm::dot(axes[2], ders(1, 0)));
+            const glm::vec<2, T> jv(glm::dot(axes[1], ders(0, 1)), glm::dot(axes[2], ders(0, 1)));
+            const T det = ju.x * jv.y - ju.y * jv.x;
+            if (det == 0)
+            {
+                return false;
+            }
+            glm::vec<2, T> next = uv - glm::vec<2, T>(f.x * jv.y - f.y * jv.x,
+                                                      ju.x * f.y - ju.y * f.x) / det;
+            next = glm::min(glm::max(next, domain_lo), domain_hi);
+            // Iterates far outside the patch belong to other patches
+            if (next == uv || next.x < patch.lo.x - size.x || next.x > patch.hi.x + size.x ||
+                next.y < patch.lo.y - size.y || next.y > patch.hi.y + size.y)
+            {
+                return false;
+            }
+            uv = next;
+        }
+        return false;
+    }
+
+    /**
+     * Record an intersection if it is the closest so far
+     * @param[in] ray Ray to intersect.
+     * @param[in] uv Parameters of the intersection.
+     * @param[in] patch Patch the intersection was found from.
+     * @param[inout] hit Closest hit so far.
+     * @param[inout] scratch Buffers of the calling thread, whose derivatives
+     * are those at uv.
+     */
+    void record(const Ray<T> &ray, const glm::vec<2, T> &uv, const Patch &patch, RayHit<T> &hit,
+                Scratch &scratch) const
+    {
+        const array2<glm::vec<3, T>> &ders = scratch.ders;
+        const T t = glm::dot(ders(0, 0) - ray.origin, ray.direction) /
+                    glm::dot(ray.direction, ray.direction);
+        if (!(t >= ray.t_min && t <= hit.t))
+        {
+            return;
+        }
+        hit.hit = true;
+        hit.t = t;
+        hit.uv = uv;
+        glm::vec<3, T> n = glm::cross(ders(1, 0), ders(0, 1));
+        if (!(glm::length(n) > 0))
+        {
+            // Degenerate edge such as a pole, take the normal slightly inside
+            const glm::vec<2, T> inner = uv + ((patch.lo + patch.hi) / T(2) - uv) / T(1024);
+            surfaceDerivatives(srf, 1, inner.x, inner.y, scratch.ders, scratch.ws);
+            n = glm::cross(ders(1, 0), ders(0, 1));
+        }
+        const T len = glm::length(n);
+        hit.normal = len > 0 ? n / len : glm::vec<3, T>(0);
+    }
+
+    /**
+     * Intersect a ray with the patch of a leaf, subdividing it until the
+     * projected patches hold at most one hit
+     */
+    void leafIntersect(const Ray<T> &ray, const glm::vec<3, T> axes[3], T dir_len,
+                       unsigned int leaf, RayHit<T> &hit, Scratch &scratch) const
+    {
+        const unsigned int max_depth = 16;
+        const size_t size = rows * cols;
+        std::vector<glm::vec<4, T>> &points = scratch.points;
+        std::vector<Patch> &patches = scratch.patches;
+
+        // Project onto the frame of the ray, the first two coordinates are the
+        // distances to the planes and the third gives the ray parameter
+        points.resize(size);
+        const glm::vec<4, T> *bezier = &beziers[leaf * size];
+        for (size_t i = 0; i < size; ++i)
+        {
+            const glm::vec<3, T> q = util::truncateHomogenous(bezier[i]) - ray.origin * bezier[i].w;
+            points[i] = glm::vec<4, T>(glm::dot(axes[1], q), glm::dot(axes[2], q),
+                                       glm::dot(axes[0], q) / dir_len, bezier[i].w);
+        }
+        patches.clear();
+        patches.push_back(Patch{bvh.leaves[leaf].lo, bvh.leaves[leaf].hi, 0, 0});
+
+        while (!patches.empty())
+        {
+            const Patch patch = patches.back();
+            patches.pop_back();
+            const glm::vec<4, T> *pts = &points[patch.offset];
+            glm::vec<4, T> lo(std::numeric_limits<T>::infinity()), hi(-lo);
+            for (size_t i = 0; i < size; ++i)
+            {
+                const glm::vec<4, T> pt(pts[i].x, pts[i].y, pts[i].z / pts[i].w, 0);
+                lo = glm::min(lo, pt);
+                hi = glm::max(hi, pt);
+            }
+            if (lo.x > 0 || hi.x < 0 || lo.y > 0 || hi.y < 0 || hi.z < ray.t_min || lo.z > hit.t)
+            {
+                continue;
+            }
+
+            const bool single = injective(pts);
+            if (single || patch.depth == max_depth)
+            {
+                glm::vec<2, T> uv;
+                if (newton(ray, axes, patch, uv, scratch))
+                {
+                    record(ray, uv, patch, hit, scratch);
+                    if (uv.x >= patch.lo.x && uv.x <= patch.hi.x && uv.y >= patch.lo.y &&
+                        uv.y <= patch.hi.y)
+                    {
+                        continue;
+                    }
+                }
+                if (patch.depth == max_depth)
+                {
+                    continue;
+                }
+            }
+
+            // Split along the direction in which the projected patch spreads most
+            T spread_u = 0, spread_v = 0;
+            for (size_t i = 0; i + 1 < rows; ++i)
+            {
+                const glm::vec<4, T> d = pts[(i + 1) * cols] - pts[i * cols] +
+                                         pts[(i + 1) * cols + cols - 1] - pts[i * cols + cols - 1];
+                spread_u += std::abs(d.x) + std::abs(d.y);
+            }
+            for (size_t j = 0; j + 1 < cols; ++j)
+            {
+                const glm::vec<4, T> d = pts[j + 1] - pts[j] + pts[size - cols + j + 1] -
+                                         pts[size - cols + j];
+                spread_v += std::abs(d.x) + std::abs(d.y);
+            }
+            const bool along_u = spread_u >= spread_v;
+            const size_t offset = points.size();
+            split(patch.offset, along_u, points);
+            const glm::vec<2, T> mid = (patch.lo + patch.hi) / T(2);
+            Patch first = patch, second = patch;
+            first.offset = offset;
+            second.offset = offset + size;
+            first.depth = second.depth = patch.depth + 1;
+            if (along_u)
+            {
+                first.hi.x = second.lo.x = mid.x;
+            }
+            else
+            {
+                first.hi.y = second.lo.y = mid.y;
+            }
+            patches.push_back(second);
+            patches.push_back(first);
+        }
+    }
+};
+
+/**
+ * Intersect many rays with a surface on several threads
+ * @param[in] srf Surface or RationalSurface object
+ * @param[in] rays Rays to intersect.
+ * @param[out] hits First intersection of each ray.
+ * @param[in] num_threads Number of threads, 0 for one per hardware thread.
+ */
+template <typename T, typename SurfaceType>
+void surfaceRayIntersect(const SurfaceType &srf, const std::vector<Ray<T>> &rays,
+                         std::vector<RayHit<T>> &hits, unsigned int num_threads)
+{
+    typedef SurfaceRayCaster<T, SurfaceType> Caster;
+    const Caster caster(srf);
+    hits.resize(rays.size());
+
+    const size_t chunk = 64;
+    const unsigned int threads = util::threadCount(num_threads, (rays.size() + chunk - 1) / chunk);
+    std::vector<typename Caster::Scratch> scratch(threads);
+    util::parallelFor(
+        rays.size(), threads,
+        [&](size_t i, unsigned int thread) {
+            hits[i] = caster.intersect(rays[i], scratch[thread]);
+        },
+        chunk);
+}
+
+} // namespace internal
+
+/////////////////////////////////////////////////////////////////////
+
+/**
+ * Find the first intersection of a ray with a surface
+ * @param[in] srf Surface object
+ * @param[in] ray Ray to intersect.
+ * @return Closest hit in the range of the ray, with hit set to false if the
+ * ray misses the surface
+ */
+template <typename T> RayHit<T> surfaceRayIntersect(const Surface<T> &srf, const Ray<T> &ray)
+{
+    internal::SurfaceRayCaster<T, Surface<T>> caster(srf);
+    typename internal::SurfaceRayCaster<T, Surface<T>>::Scratch scratch;
+    return caster.intersect(ray, scratch);
+}
+
+/**
+ * Find the first intersection of a ray with a rational surface
+ * @param[in] srf RationalSurface object
+ * @param[in] ray Ray to intersect.
+ * @return Closest hit in the range of the ray, with hit set to false if the
+ * ray misses the surface
+ */
+template <typename T>
+RayHit<T> surfaceRayIntersect(const RationalSurface<T> &srf, const Ray<T> &ray)
+{
+    internal::SurfaceRayCaster<T, RationalSurface<T>> caster(srf);
+    typename internal::SurfaceRayCaster<T, RationalSurface<T>>::Scratch scratch;
+    return caster.intersect(ray, scratch);
+}
+
+/**
+ * Find the first intersection of many rays with a surface on several threads,
+ * e.g. the primary rays of an image. The BVH is built once and shared.
+ * @param[in] srf Surface object
+ * @param[in] rays Rays to intersect.
+ * @param[out] hits Closest hit of each ray.
+ * @param[in] num_threads Number of threads, 0 for one per hardware thread.
+ */
+template <typename T>
+void surfaceRayIntersect(const Surface<T> &srf, const std::vector<Ray<T>> &rays,
+                         std::vector<RayHit<T>> &hits, unsigned int num_threads = 0)
+{
+    internal::surfaceRayIntersect(srf, rays, hits, num_threads);
+}
+
+/**
+ * Find the first intersection of many rays with a rational surface on several
+ * threads, e.g. the primary rays of an image. The BVH is built once and shared.
+ * @param[in] srf RationalSurface object
+ * @param[in] rays Rays to intersect.
+ * @param[out] hits Closest hit of each ray.
+ * @param[in] num_threads Number of threads, 0 for one per hardware thread.
+ */
+template <typename T>
+void surfaceRayIntersect(const RationalSurface<T> &srf, const std::vector<Ray<T>> &rays,
+                         std::vector<RayHit<T>> &hits, unsigned int num_threads = 0)
+{
+    internal::surfaceRayIntersect(srf, rays, hits, num_threads);
+}
+
+// Typedefs for ease of use
+typedef Ray<float> Ray3f;
+typedef Ray<double> Ray3d;
+typedef RayHit<float> RayHit3f;
+typedef RayHit<double> RayHit3d;
+
+} // namespace tinynurbs
+
+#endif // TINYNURBS_INTERSECT_H
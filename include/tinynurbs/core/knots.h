@@ -0,0 +1,302 @@
+/**
+ * Knot vectors with cached properties, and precomputed search structures over
+ * knot vectors
+ *
+ * Use of this source code is governed by a BSD-style license that can be found in
+ * the LICENSE file.
+ */
+
+#ifndef TINYNURBS_KNOTS_H
+#define TINYNURBS_KNOTS_H
+
+#include "basis.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace tinynurbs
+{
+
+/**
+Struct for finding spans in a fixed knot vector faster than findSpan(). The
+lookup strategy is chosen at construction:
+- Uniform: the knots of the domain are equally spaced and the span is computed
+  arithmetically.
+- Buckets: the domain is split into equal buckets that each overlap only a few
+  spans, and a table gives the first span of every bucket.
+- Search: a branchless binary search over the knots of the domain.
+The locator keeps a pointer to the knots it was built from, which must outlive
+it and must not be modified.
+\tparam T Data type of knots (float or double)
+*/
+template <typename T> struct SpanLocator
+{
+    enum class Strategy
+    {
+        Uniform,
+        Buckets,
+        Search
+    };
+
+    // Largest number of spans that one bucket may overlap before falling back
+    // to binary search
+    static constexpr int max_bucket_spans = 4;
+
+    Strategy strategy = Strategy::Search;
+    unsigned int degree = 0;
+    // Knots the locator was built from, not owned
+    const T *knots = nullptr;
+    // Index of the last span
+    int last = 0;
+    // Domain [lo, hi] and number of buckets, or spans, per unit parameter
+    T lo = 0, hi = 0, scale = 0;
+    // First span overlapping each bucket
+    std::vector<int> buckets;
+
+    SpanLocator() = default;
+    SpanLocator(unsigned int degree, const std::vector<T> &knots)
+        : degree(degree), knots(knots.data())
+    {
+        last = static_cast<int>(knots.size()) - degree - 2;
+        assert(last >= static_cast<int>(degree));
+        lo = knots[degree];
+        hi = knots[last + 1];
+        int num_spans = last - degree + 1;
+        scale = num_spans / (hi - lo);
+
+        // Equally spaced knots within a tolerance relative to the domain
+        T tol = 64 * std::numeric_limits<T>::epsilon() * (hi - lo);
+        bool uniform = true;
+        for (int i = degree; i <= last && uniform; ++i)
+        {
+            T expected = lo + (i - static_cast<int>(degree)) / scale;
+            uniform = std::abs(knots[i] - expected) <= tol;
+        }
+        if (uniform)
+        {
+            strategy = Strategy::Uniform;
+            return;
+        }
+
+        // One bucket per span, each starting at the span of its lower bound
+        buckets.resize(num_spans + 1);
+        int span = degree;
+        int max_spans = 0;
+        for (int b = 0; b <= num_spans; ++b)
+        {
+            T u = lo + b / scale;
+            while (span < last && u >= knots[span + 1])
+            {
+                ++span;
+            }
+            buckets[b] = span;
+            if (b > 0)
+            {
+                max_spans = std::max(max_spans, buckets[b] - buckets[b - 1] + 1);
+            }
+        }
+        strategy = (max_spans <= max_bucket_spans) ? Strategy::Buckets : Strategy::Search;
+        if (strategy == Strategy::Search)
+        {
+            buckets.clear();
+        }
+    }
+};
+
+/**
+ * Find the span of the given parameter using a precomputed locator. Returns the
+ * same span as findSpan() on the knot vector of the locator.
+ * @param[in] locator SpanLocator built from the knot vector.
+ * @param[in] u Parameter value.
+ * @return Span index into the knot vector such that knots[span] <= u < knots[span + 1]
+ */
+template <typename T> int findSpan(const SpanLocator<T> &locator, T u)
+{
+    const int degree = static_cast<int>(locator.degree);
+    const T *knots = locator.knots;
+
+    // Same treatment of the domain boundaries as findSpan()
+    if (u >= (locator.hi - std::numeric_limits<T>::epsilon()))
+    {
+        return locator.last;
+    }
+    if (u < (locator.lo + std::numeric_limits<T>::epsilon()))
+    {
+        return degree;
+    }
+
+    int span;
+    switch (locator.strategy)
+    {
+    case SpanLocator<T>::Strategy::Uniform:
+        span = degree + static_cast<int>((u - locator.lo) * locator.scale);
+        span = std::min(std::max(span, degree), locator.last);
+        break;
+    case SpanLocator<T>::Strategy::Buckets:
+    {
+        int b = static_cast<int>((u - locator.lo) * locator.scale);
+        b = std::min(std::max(b, 0), static_cast<int>(locator.buckets.size()) - 1);
+        span = locator.buckets[b];
+        break;
+    }
+    default:
+    {
+        // Branchless upper bound over knots[degree + 1] ... knots[last]
+        const T *first = knots + degree + 1;
+        const T *base = first;
+        size_t len = locator.last - degree;
+        if (len == 0)
+        {
+            return degree;
+        }
+        while (len > 1)
+        {
+            size_t half = len / 2;
+            base = (base[half] <= u) ? base + half : base;
+            len -= half;
+        }
+        return degree + static_cast<int>(base - first) + (*base <= u ? 1 : 0);
+    }
+    }
+
+    // Correct rounding in the arithmetic guess and walk through the bucket
+    while (span > degree && u < knots[span])
+    {
+        --span;
+    }
+    while (span < locator.last && u >= knots[span + 1])
+    {
+        ++span;
+    }
+    return span;
+}
+
+/**
+Struct for representing a knot vector together with properties that are
+otherwise recomputed from the knots on every query: the unique breakpoints and
+their multiplicities, the domain [knots[degree], knots[n + 1]], a span locator,
+and whether the knots are monotonic, uniform, clamped and closed. The knots must
+not be modified without calling update() afterwards.
+\tparam T Data type of knots (float or double)
+*/
+template <typename T> struct KnotVector
+{
+    unsigned int degree = 0;
+    std::vector<T> knots;
+    // Unique knot values in ascending order and their multiplicities
+    std::vector<T> breakpoints;
+    std::vector<unsigned int> multiplicities;
+    // Span lookup over the knots
+    SpanLocator<T> locator;
+    // Domain [lo, hi]
+    T lo = 0, hi = 0;
+    // Whether the knots are in ascending order, equally spaced over the domain,
+    // repeated degree + 1 times at both ends, and periodic near both ends
+    bool monotonic = true, uniform = false, clamped = false, closed = false;
+
+    KnotVector() = default;
+    KnotVector(unsigned int degree, std::vector<T> knots) : degree(degree), knots(std::move(knots))
+    {
+        update();
+    }
+
+    // The locator points into the knots, so copies rebind it to their own knots
+    KnotVector(const KnotVector &other)
+    {
+        *this = other;
+    }
+
+    KnotVector(KnotVector &&other) = default;
+
+    KnotVector &operator=(const KnotVector &other)
+    {
+        degree = other.degree;
+        knots = other.knots;
+        breakpoints = other.breakpoints;
+        multiplicities = other.multiplicities;
+        locator = other.locator;
+        locator.knots = knots.data();
+        lo = other.lo;
+        hi = other.hi;
+        monotonic = other.monotonic;
+        uniform = other.uniform;
+        clamped = other.clamped;
+        closed = other.closed;
+        return *this;
+    }
+
+    KnotVector &operator=(KnotVector &&other) = default;
+
+    operator const std::vector<T> &() const
+    {
+        return knots;
+    }
+
+    size_t size() const
+    {
+        return knots.size();
+    }
+
+    T operator[](size_t i) const
+    {
+        return knots[i];
+    }
+
+    /**
+     * Recompute the cached properties from the degree and knots
+     */
+    void update()
+    {
+        const T eps = std::numeric_limits<T>::epsilon();
+        monotonic = std::is_sorted(knots.begin(), knots.end());
+
+        breakpoints.clear();
+        multiplicities.clear();
+        for (size_t i = 0; i < knots.size(); ++i)
+        {
+            if (breakpoints.empty() || knots[i] != breakpoints.back())
+            {
+                breakpoints.push_back(knots[i]);
+                multiplicities.push_back(0);
+            }
+            ++multiplicities.back();
+        }
+
+        locator = SpanLocator<T>(degree, knots);
+        lo = locator.lo;
+        hi = locator.hi;
+        uniform = monotonic && locator.strategy == SpanLocator<T>::Strategy::Uniform;
+
+        clamped = true;
+        for (unsigned int i = 0; i < degree && clamped; ++i)
+        {
+            clamped = knots[i] == lo && knots[knots.size() - 1 - i] == hi;
+        }
+
+        // Same test as isKnotVectorClosed()
+        closed = true;
+        for (int i = 0; i < static_cast<int>(degree) - 1 && closed; ++i)
+        {
+            size_t j = knots.size() - degree + i;
+            closed = std::abs((knots[i + 1] - knots[i]) - (knots[j + 1] - knots[j])) <= eps;
+        }
+    }
+};
+
+/**
+ * Find the span of the given parameter in a cached knot vector, using its span
+ * locator. Returns the same span as findSpan() on the knots of the knot vector.
+ * @param[in] knots Knot vector with cached properties.
+ * @param[in] u Parameter value.
+ * @return Span index into the knot vector such that knots[span] <= u < knots[span + 1]
+ */
+template <typename T> int findSpan(const KnotVector<T> &knots, T u)
+{
+    return findSpan(knots.locator, u);
+}
+
+} // namespace tinynurbs
+
+#endif // TINYNURBS_KNOTS_H
@@ -11,6 +11,7 @@
 #include <glm/glm.hpp>
 #include <tinynurbs/core/check.h>
 #include <tinynurbs/core/curve.h>
+#include <tinynurbs/core/knots.h>
 #include <tinynurbs/core/surface.h>
 #include <tinynurbs/util/util.h>
 #include <tuple>
@@ -25,22 +26,23 @@ namespace internal
 {
 
 /**
- * Insert knots in the curve
+ * Insert knots in the curve, given the span and multiplicity of the parameter
  * @param[in] deg Degree of the curve
  * @param[in] knots Knot vector of the curve
  * @param[in] cp Control points of the curve
  * @param[in] u Parameter to insert knot(s) at
  * @param[in] r Number of times to insert knot
+ * @param[in] k Span of u in the knot vector
+ * @param[in] s Multiplicity of u in the knot vector
  * @param[out] new_knots Updated knot vector
  * @param[out] new_cp Updated control points
  */
 template <int dim, typename T>
 void curveKnotInsert(unsigned int deg, const std::vector<T> &knots,
-                     const std::vector<glm::vec<dim, T>> &cp, T u, unsigned int r,
-                     std::vector<T> &new_knots, std::vector<glm::vec<dim, T>> &new_cp)
+                     const std::vector<glm::vec<dim, T>> &cp, T u, unsigned int r, int k,
+                     unsigned int s, std::vector<T> &new_knots,
+                     std::vector<glm::vec<dim, T>> &new_cp)
 {
-    int k = findSpan(deg, knots, u);
-    unsigned int s = knotMultiplicity(knots, u);
     assert(s <= deg); // Multiplicity cannot be greater than degree
     if (s == deg)
     {
@@ -104,23 +106,63 @@ void curveKnotInsert(unsigned int deg, const std::vector<T> &knots,
 }
 
 /**
- * Insert knots in the surface along one direction
+ * Insert knots in the curve, looking up the span and multiplicity of the
+ * parameter in the cached knot vector
+ * @param[in] knots Knot vector of the curve, with the degree of the curve
+ * @param[in] cp Control points of the curve
+ * @param[in] u Parameter to insert knot(s) at
+ * @param[in] r Number of times to insert knot
+ * @param[out] new_knots Updated knot vector
+ * @param[out] new_cp Updated control points
+ */
+template <int dim, typename T>
+void curveKnotInsert(const KnotVector<T> &knots, const std::vector<glm::vec<dim, T>> &cp, T u,
+                     unsigned int r, std::vector<T> &new_knots,
+                     std::vector<glm::vec<dim, T>> &new_cp)
+{
+    curveKnotInsert(knots.degree, knots.knots, cp, u, r, findSpan(knots, u),
+                    knotMultiplicity(knots, u), new_knots, new_cp);
+}
+
+/**
+ * Insert knots in the curve
+ * @param[in] deg Degree of the curve
+ * @param[in] knots Knot vector of the curve
+ * @param[in] cp Control points of the curve
+ * @param[in] u Parameter to insert knot(s) at
+ * @param[in] r Number of times to insert knot
+ * @param[out] new_knots Updated knot vector
+ * @param[out] new_cp Updated control points
+ */
+template <int dim, typename T>
+void curveKnotInsert(unsigned int deg, const std::vector<T> &knots,
+                     const std::vector<glm::vec<dim, T>> &cp, T u, unsigned int r,
+                     std::vector<T> &new_knots, std::vector<glm::vec<dim, T>> &new_cp)
+{
+    curveKnotInsert(deg, knots, cp, u, r, findSpan(deg, knots, u), knotMultiplicity(knots, u),
+                    new_knots, new_cp);
+}
+
+/**
+ * Insert knots in the surface along one direction, given the span and
+ * multiplicity of the knot
  * @param[in] degree Degree of the surface along which to insert knot
  * @param[in] knots Knot vector
  * @param[in] cp 2D array of control points
  * @param[in] knot Knot value to insert
  * @param[in] r Number of times to insert
  * @param[in] along_u Whether inserting along u-direction
+ * @param[in] span Span of the knot in the knot vector
+ * @param[in] s Multiplicity of the knot in the knot vector
  * @param[out] new_knots Updated knot vector
  * @param[out] new_cp Updated control points
  */
 template <int dim, typename T>
 void surfaceKnotInsert(unsigned int degree, const std::vector<T> &knots,
                        const array2<glm::vec<dim, T>> &cp, T knot, unsigned int r, bool along_u,
-                       std::vector<T> &new_knots, array2<glm::vec<dim, T>> &new_cp)
+                       int span, unsigned int s, std::vector<T> &new_knots,
+                       array2<glm::vec<dim, T>> &new_cp)
 {
-    int span = findSpan(degree, knots, knot);
-    unsigned int s = knotMultiplicity(knots, knot);
     assert(s <= degree);  // Knot multiplicity cannot be greater than degree
     if (s == degree)
     {
@@ -247,6 +289,46 @@ void surfaceKnotInsert(unsigned int degree, const std::vector<T> &knots,
     }
 }
 
+/**
+ * Insert knots in the surface along one direction, looking up the span and
+ * multiplicity of the knot in the cached knot vector
+ * @param[in] knots Knot vector along the direction, with the degree along it
+ * @param[in] cp 2D array of control points
+ * @param[in] knot Knot value to insert
+ * @param[in] r Number of times to insert
+ * @param[in] along_u Whether inserting along u-direction
+ * @param[out] new_knots Updated knot vector
+ * @param[out] new_cp Updated control points
+ */
+template <int dim, typename T>
+void surfaceKnotInsert(const KnotVector<T> &knots, const array2<glm::vec<dim, T>> &cp, T knot,
+                       unsigned int r, bool along_u, std::vector<T> &new_knots,
+                       array2<glm::vec<dim, T>> &new_cp)
+{
+    surfaceKnotInsert(knots.degree, knots.knots, cp, knot, r, along_u, findSpan(knots, knot),
+                      knotMultiplicity(knots, knot), new_knots, new_cp);
+}
+
+/**
+ * Insert knots in the surface along one direction
+ * @param[in] degree Degree of the surface along which to insert knot
+ * @param[in] knots Knot vector
+ * @param[in] cp 2D array of control points
+ * @param[in] knot Knot value to insert
+ * @param[in] r Number of times to insert
+ * @param[in] along_u Whether inserting along u-direction
+ * @param[out] new_knots Updated knot vector
+ * @param[out] new_cp Updated control points
+ */
+template <int dim, typename T>
+void surfaceKnotInsert(unsigned int degree, const std::vector<T> &knots,
+                       const array2<glm::vec<dim, T>> &cp, T knot, unsigned int r, bool along_u,
+                       std::vector<T> &new_knots, array2<glm::vec<dim, T>> &new_cp)
+{
+    surfaceKnotInsert(degree, knots, cp, knot, r, along_u, findSpan(degree, knots, knot),
+                      knotMultiplicity(knots, knot), new_knots, new_cp);
+}
+
 /**
  * Split the curve into two
  * @param[in] degree Degree of curve
@@ -268,9 +350,10 @@ void curveSplit(unsigned int degree, const std::vector<T> &knots,
     std::vector<glm::vec<dim, T>> tmp_cp;
 
     int span = findSpan(degree, knots, u);
-    int r = degree - knotMultiplicity(knots, u);
+    unsigned int s = knotMultiplicity(knots, u);
+    int r = degree - s;
 
-    internal::curveKnotInsert(degree, knots, control_points, u, r, tmp_knots, tmp_cp);
+    internal::curveKnotInsert(degree, knots, control_points, u, r, span, s, tmp_knots, tmp_cp);
 
     left_knots.clear();
     right_knots.clear();
@@ -326,9 +409,10 @@ void surfaceSplit(unsigned int degree, const std::vector<T> &knots,
     array2<glm::vec<dim, T>> tmp_cp;
 
     int span = findSpan(degree, knots, param);
-    unsigned int r = degree - knotMultiplicity(knots, param);
-    internal::surfaceKnotInsert(degree, knots, control_points, param, r, along_u, tmp_knots,
-                                tmp_cp);
+    unsigned int s = knotMultiplicity(knots, param);
+    unsigned int r = degree - s;
+    internal::surfaceKnotInsert(degree, knots, control_points, param, r, along_u, span, s,
+                                tmp_knots, tmp_cp);
 
     left_knots.clear();
     right_knots.clear();
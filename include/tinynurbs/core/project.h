@@ -0,0 +1,847 @@
+/**
+ * Closest point projection of points onto curves and surfaces, pruning knot
+ * spans with the bounding boxes of their control points and refining with
+ * Newton iteration.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found in
+ * the LICENSE file.
+ */
+
+#ifndef TINYNURBS_PROJECT_H
+#define TINYNURBS_PROJECT_H
+
+#include "../util/array2.h"
+#include "../util/parallel.h"
+#include "../util/util.h"
+#include "basis.h"
+#include "compiled.h"
+#include "curve.h"
+#include "evaluate.h"
+#include "glm/glm.hpp"
+#include "stepper.h"
+#include "surface.h"
+#include "workspace.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace tinynurbs
+{
+
+namespace internal
+{
+
+/**
+ * Squared distance from a point to an axis-aligned box, zero inside the box
+ * @param[in] pt Point.
+ * @param[in] box_min Minimum corner of the box.
+ * @param[in] box_max Maximum corner of the box.
+ * @return Squared distance
+ */
+template <typename T>
+T boxDistance2(const glm::vec<3, T> &pt, const glm::vec<3, T> &box_min,
+               const glm::vec<3, T> &box_max)
+{
+    glm::vec<3, T> d = glm::max(box_min - pt, glm::max(pt - box_max, glm::vec<3, T>(0)));
+    return glm::dot(d, d);
+}
+
+/**
+ * End of a non-empty span, moved inside the span unless it ends the domain.
+ * Evaluation at a knot uses the span on its right, whose derivatives differ
+ * across a crease.
+ * @param[in] breaks Bounds of the non-empty spans, followed by the end of the last span.
+ * @param[in] s Index of the span.
+ * @return Largest parameter evaluated within span s
+ */
+template <typename T> T spanEnd(const std::vector<T> &breaks, size_t s)
+{
+    const T a = breaks[s], b = breaks[s + 1];
+    if (s + 2 == breaks.size())
+    {
+        return b;
+    }
+    return b - 4 * std::numeric_limits<T>::epsilon() * std::max(std::abs(b), b - a);
+}
+
+/**
+Projects points onto a curve. Each non-empty knot span is bounded by the box of
+the degree + 1 control points it depends on, which contains the span by the
+convex hull property (weights must be positive). A query visits the spans in
+order of the distance to their box, and stops once no box is closer than the
+closest point found so far. Not safe to share between threads.
+\tparam T Data type of control points and knots (float or double)
+*/
+template <typename T> class CurveProjector
+{
+  public:
+    CurveProjector(const Curve<T> &crv) : crv(crv), rational(false)
+    {
+        init();
+    }
+    CurveProjector(const RationalCurve<T> &crv) : crv(crv), rational(true)
+    {
+        init();
+    }
+
+    /**
+     * Find the parameter of the point of the curve closest to a point
+     * @param[in] pt Point to project.
+     * @param[in] hint Parameter to start Newton iteration from before searching
+     * the spans, usually the result of a nearby query. Ignored if NaN.
+     * @return Parameter of the closest point
+     */
+    T project(const glm::vec<3, T> &pt, T hint = std::numeric_limits<T>::quiet_NaN())
+    {
+        return project(pt, hint, breaks.front(), breaks.back());
+    }
+
+    /**
+     * Find the parameter of the point of the curve closest to a point among the
+     * parameters of an interval
+     * @param[in] pt Point to project.
+     * @param[in] hint Parameter to start Newton iteration from before searching
+     * the spans, usually the result of a nearby query. Ignored if NaN.
+     * @param[in] lo Start of the interval, within the domain of the curve.
+     * @param[in] hi End of the interval, within the domain of the curve.
+     * @return Parameter of the closest point in [lo, hi]
+     */
+    T project(const glm::vec<3, T> &pt, T hint, T lo, T hi)
+    {
+        T best_u = lo;
+        T best_d2 = std::numeric_limits<T>::infinity();
+        if (!std::isnan(hint))
+        {
+            best_u = newton(pt, std::min(std::max(hint, lo), hi), lo, hi, best_d2);
+        }
+
+        // Spans whose box may contain a closer point, nearest box first
+        candidates.clear();
+        for (size_t s = 0; s < spans.size(); ++s)
+        {
+            if (breaks[s + 1] <= lo || breaks[s] >= hi)
+            {
+                continue;
+            }
+            T lower = boxDistance2(pt, box_min[s], box_max[s]);
+            if (lower < best_d2)
+            {
+                candidates.push_back(std::make_pair(lower, s));
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        for (const auto &candidate : candidates)
+        {
+            if (candidate.first >= best_d2)
+            {
+                break;
+            }
+            const size_t s = candidate.second;
+            const T a = std::max(breaks[s], lo);
+            const T b = std::max(a, std::min(spanEnd(breaks, s), hi));
+
+            // Sample the span, evaluating within it so that Newton starts with
+            // the derivatives of the span, and refine each sample closer than
+            // its neighbours. The squared distance to a polynomial span has at
+            // most 2 * degree - 1 extrema, so the samples bracket its minima.
+            const unsigned int num_samples = 2 * crv.degree + 3;
+            samples.resize(num_samples);
+            for (unsigned int i = 0; i < num_samples; ++i)
+            {
+                T u = (i + 1 == num_samples) ? b : a + (b - a) * i / (num_samples - 1);
+                glm::vec<3, T> diff = point(u) - pt;
+                samples[i] = std::make_pair(u, glm::dot(diff, diff));
+            }
+            for (unsigned int i = 0; i < num_samples; ++i)
+            {
+                if ((i > 0 && samples[i - 1].second < samples[i].second) ||
+                    (i + 1 < num_samples && samples[i + 1].second < samples[i].second))
+                {
+                    continue;
+                }
+                T d2 = samples[i].second;
+                T u = newton(pt, samples[i].first, a, b, d2);
+                if (d2 < best_d2)
+                {
+                    best_u = u;
+                    best_d2 = d2;
+                }
+            }
+        }
+        return best_u;
+    }
+
+  private:
+    HomogenousCurve<T> crv;
+    bool rational;
+    // Bounds of each non-empty span, followed by the end of the last span
+    std::vector<T> breaks;
+    std::vector<int> spans;
+    std::vector<glm::vec<3, T>> box_min, box_max;
+    std::vector<std::pair<T, size_t>> candidates;
+    // Parameter and squared distance of the samples of a span
+    std::vector<std::pair<T, T>> samples;
+    std::vector<glm::vec<4, T>> dersw;
+    glm::vec<3, T> ders[3];
+    EvalWorkspace<T> ws;
+
+    void init()
+    {
+        compiledBreaks(crv.degree, crv.knots, breaks, spans);
+        box_min.resize(spans.size());
+        box_max.resize(spans.size());
+        for (size_t s = 0; s < spans.size(); ++s)
+        {
+            const int first = spans[s] - static_cast<int>(crv.degree);
+            box_min[s] = box_max[s] = util::homogenousToCartesian(crv.control_points[first]);
+            for (unsigned int j = 1; j <= crv.degree; ++j)
+            {
+                glm::vec<3, T> cp = util::homogenousToCartesian(crv.control_points[first + j]);
+                box_min[s] = glm::min(box_min[s], cp);
+                box_max[s] = glm::max(box_max[s], cp);
+            }
+        }
+        dersw.resize(3);
+    }
+
+    glm::vec<3, T> point(T u)
+    {
+        return util::homogenousToCartesian(
+            curvePoint(crv.degree, crv.knots, crv.control_points, u, ws));
+    }
+
+    void derivatives(T u)
+    {
+        curveDerivatives(crv.degree, crv.knots, crv.control_points, 2, u, dersw.data(), ws);
+        T wders[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            ders[k] = util::truncateHomogenous(dersw[k]);
+            wders[k] = dersw[k].w;
+        }
+        if (rational)
+        {
+            curveQuotientRule(wders, ws.binomials(2), 2, ders);
+        }
+    }
+
+    /**
+     * Minimize the distance to a point with Newton iteration on the derivative
+     * of the squared distance, clamped to an interval. Steps that increase the
+     * distance are halved until they do not. Where the squared distance is not
+     * convex, the step uses the Gauss-Newton approximation of its second
+     * derivative instead.
+     * @param[in] pt Point to project.
+     * @param[in] u Starting parameter.
+     * @param[in] a Start of the interval.
+     * @param[in] b End of the interval.
+     * @param[inout] best_d2 Squared distance of the starting point if known,
+     * and of the returned point on output.
+     * @return Parameter of the closest point found
+     */
+    T newton(const glm::vec<3, T> &pt, T u, T a, T b, T &best_d2)
+    {
+        const T eps = std::numeric_limits<T>::epsilon();
+        // Cosine between the tangent and the difference, close to the rounding
+        // error of the dot product so that float converges as well as double
+        const T cos_tol = 8 * eps;
+        const T step_tol = 4 * eps * std::max(std::max(std::abs(a), std::abs(b)), b - a);
+        const int max_iters = 32;
+        T best_u = u;
+        T prev_u = u;
+        T prev_d2 = std::numeric_limits<T>::infinity();
+        for (int iter = 0; iter < max_iters; ++iter)
+        {
+            derivatives(u);
+            const glm::vec<3, T> diff = ders[0] - pt;
+            const T d2 = glm::dot(diff, diff);
+            if (d2 > prev_d2 * (1 + 16 * eps))
+            {
+                // Overshot, backtrack halfway to the previous iterate
+                if (std::abs(u - prev_u) <= step_tol)
+                {
+                    break;
+                }
+                u = (prev_u + u) / 2;
+                continue;
+            }
+            prev_u = u;
+            prev_d2 = d2;
+            // The distance is flat near the minimum, so accept iterates that
+            // are as close as the best one up to rounding
+            if (d2 <= best_d2 * (1 + 16 * eps))
+            {
+                best_u = u;
+                best_d2 = std::min(best_d2, d2);
+            }
+
+            // Converged when the point lies on the curve or the difference is
+            // orthogonal to the tangent
+            const T f = glm::dot(ders[1], diff);
+            const T speed2 = glm::dot(ders[1], ders[1]);
+            if (d2 <= eps * eps || f * f <= cos_tol * cos_tol * speed2 * d2)
+            {
+                break;
+            }
+            T df = glm::dot(ders[2], diff) + speed2;
+            if (!(df > 0))
+            {
+                // Not convex here, still descend
+                df = speed2;
+            }
+            if (!(df > 0))
+            {
+                break;
+            }
+            T next = std::min(std::max(u - f / df, a), b);
+            if (std::abs(next - u) <= step_tol)
+            {
+                // Stalled, typically against an end of the interval
+                break;
+            }
+            u = next;
+        }
+        return best_u;
+    }
+};
+
+/**
+Projects points onto a surface. Each pair of non-empty knot spans is a patch
+bounded by the box of the (degree_u + 1) x (degree_v + 1) control points it
+depends on, and patches are grouped into a binary hierarchy by halving the
+longer range of spans. A query descends the hierarchy nearest box first, and
+stops once no box is closer than the closest point found so far. The hierarchy
+is read-only after construction, so threads can share a projector as long as
+each uses its own Scratch.
+\tparam T Data type of control points and knots (float or double)
+\tparam SurfaceType Surface or RationalSurface
+*/
+template <typename T, typename SurfaceType> class SurfaceProjector
+{
+  public:
+    // Per-thread buffers of a query
+    struct Scratch
+    {
+        EvalWorkspace<T> ws;
+        array2<glm::vec<3, T>> ders;
+        std::vector<std::pair<T, unsigned int>> heap;
+        // Projectors onto the isocurves along the breaks in u and v, built on
+        // first use by the projector that owns them
+        const void *owner = nullptr;
+        std::vector<std::unique_ptr<CurveProjector<T>>> iso_u, iso_v;
+    };
+
+    explicit SurfaceProjector(const SurfaceType &srf) : srf(srf)
+    {
+        std::vector<int> spans_u, spans_v;
+        compiledBreaks(srf.degree_u, srf.knots_u, breaks_u, spans_u);
+        compiledBreaks(srf.degree_v, srf.knots_v, breaks_v, spans_v);
+        nodes.reserve(2 * spans_u.size() * spans_v.size());
+        build(spans_u, spans_v, 0, static_cast<unsigned int>(spans_u.size()), 0,
+              static_cast<unsigned int>(spans_v.size()));
+    }
+
+    /**
+     * Find the parameters of the point of the surface closest to a point
+     * @param[in] pt Point to project.
+     * @param[in] hint Parameters to start Newton iteration from before
+     * searching the hierarchy, usually the result of a nearby query. Ignored if
+     * NaN.
+     * @param[inout] scratch Buffers of the calling thread.
+     * @return Parameters (u, v) of the closest point
+     */
+    glm::vec<2, T> project(const glm::vec<3, T> &pt, const glm::vec<2, T> &hint,
+                           Scratch &scratch) const
+    {
+        const glm::vec<2, T> lo(breaks_u.front(), breaks_v.front());
+        const glm::vec<2, T> hi(breaks_u.back(), breaks_v.back());
+        glm::vec<2, T> best = lo;
+        T best_d2 = std::numeric_limits<T>::infinity();
+        if (!std::isnan(hint.x) && !std::isnan(hint.y))
+        {
+            best = newton(pt, glm::min(glm::max(hint, lo), hi), lo, hi, best_d2, scratch);
+        }
+
+        // Best-first branch and bound over the hierarchy
+        typedef std::pair<T, unsigned int> Entry;
+        std::vector<Entry> &heap = scratch.heap;
+        heap.clear();
+        heap.push_back(Entry(boxDistance2(pt, nodes[0].box_min, nodes[0].box_max), 0));
+        while (!heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+            const Entry entry = heap.back();
+            heap.pop_back();
+            if (entry.first >= best_d2)
+            {
+                break;
+            }
+
+            const Node &node = nodes[entry.second];
+            if (node.left != 0)
+            {
+                for (unsigned int child : {node.left, node.right})
+                {
+                    T lower = boxDistance2(pt, nodes[child].box_min, nodes[child].box_max);
+                    if (lower < best_d2)
+                    {
+                        heap.push_back(Entry(lower, child));
+                        std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+                    }
+                }
+                continue;
+            }
+
+            // Seed from the closest of a grid of (degree_u + 2) x (degree_v + 2)
+            // samples of the patch. If Newton ends on the boundary of the patch,
+            // where it can get stuck against a clamp or a degenerate edge such
+            // as a pole, also start from the closest interior sample.
+            const glm::vec<2, T> a(breaks_u[node.first_u], breaks_v[node.first_v]);
+            const glm::vec<2, T> b(spanEnd(breaks_u, node.first_u),
+                                   spanEnd(breaks_v, node.first_v));
+            const unsigned int nu = srf.degree_u + 1, nv = srf.degree_v + 1;
+            glm::vec<2, T> seeds[2] = {a, a};
+            T seed_d2[2] = {std::numeric_limits<T>::infinity(), std::numeric_limits<T>::infinity()};
+            for (unsigned int i = 0; i <= nu; ++i)
+            {
+                for (unsigned int j = 0; j <= nv; ++j)
+                {
+                    glm::vec<2, T> uv(i == nu ? b.x : a.x + (b.x - a.x) * i / nu,
+                                      j == nv ? b.y : a.y + (b.y - a.y) * j / nv);
+                    glm::vec<3, T> diff = surfacePoint(srf, uv.x, uv.y, scratch.ws) - pt;
+                    const T d2 = glm::dot(diff, diff);
+                    const bool interior = i > 0 && i < nu && j > 0 && j < nv;
+                    for (int k = 0; k < (interior ? 2 : 1); ++k)
+                    {
+                        if (d2 < seed_d2[k])
+                        {
+                            seeds[k] = uv;
+                            seed_d2[k] = d2;
+                        }
+                    }
+                }
+            }
+
+            for (int k = 0; k < 2; ++k)
+            {
+                T d2 = seed_d2[k];
+                glm::vec<2, T> uv = newton(pt, seeds[k], a, b, d2, scratch);
+                if (d2 < best_d2)
+                {
+                    best = uv;
+                    best_d2 = d2;
+                }
+                if (seeds[1] == seeds[0] || (uv.x > a.x && uv.x < b.x && uv.y > a.y && uv.y < b.y))
+                {
+                    break;
+                }
+            }
+        }
+        return best;
+    }
+
+  private:
+    struct Node
+    {
+        glm::vec<3, T> box_min, box_max;
+        // First non-empty span along u and v of a leaf
+        unsigned int first_u, first_v;
+        // Children of an inner node, 0 for leaves
+        unsigned int left, right;
+    };
+
+    const SurfaceType &srf;
+    // Bounds of the non-empty spans along u and v
+    std::vector<T> breaks_u, breaks_v;
+    std::vector<Node> nodes;
+
+    unsigned int build(const std::vector<int> &spans_u, const std::vector<int> &spans_v,
+                       unsigned int u0, unsigned int u1, unsigned int v0, unsigned int v1)
+    {
+        const unsigned int index = static_cast<unsigned int>(nodes.size());
+        nodes.push_back(Node());
+        Node node;
+        node.first_u = u0;
+        node.first_v = v0;
+        node.left = node.right = 0;
+        if (u1 - u0 == 1 && v1 - v0 == 1)
+        {
+            const int row = spans_u[u0] - static_cast<int>(srf.degree_u);
+            const int col = spans_v[v0] - static_cast<int>(srf.degree_v);
+            node.box_min = node.box_max = srf.control_points(row, col);
+            for (unsigned int i = 0; i <= srf.degree_u; ++i)
+            {
+                for (unsigned int j = 0; j <= srf.degree_v; ++j)
+                {
+                    node.box_min = glm::min(node.box_min, srf.control_points(row + i, col + j));
+                    node.box_max = glm::max(node.box_max, srf.control_points(row + i, col + j));
+                }
+            }
+        }
+        else if (u1 - u0 >= v1 - v0)
+        {
+            unsigned int mid = (u0 + u1) / 2;
+            node.left = build(spans_u, spans_v, u0, mid, v0, v1);
+            node.right = build(spans_u, spans_v, mid, u1, v0, v1);
+        }
+        else
+        {
+            unsigned int mid = (v0 + v1) / 2;
+            node.left = build(spans_u, spans_v, u0, u1, v0, mid);
+            node.right = build(spans_u, spans_v, u0, u1, mid, v1);
+        }
+        if (node.left != 0)
+        {
+            node.box_min = glm::min(nodes[node.left].box_min, nodes[node.right].box_min);
+            node.box_max = glm::max(nodes[node.left].box_max, nodes[node.right].box_max);
+        }
+        nodes[index] = node;
+        return index;
+    }
+
+    /**
+     * Minimize the distance to a point with Newton iteration on the gradient of
+     * the squared distance, clamped to a rectangle of parameters. Steps that
+     * increase the distance are halved until they do not. A step that leaves the
+     * rectangle continues from the projection of the point onto the isocurve of
+     * the surface along the edge it crosses, within the rectangle.
+     * @param[in] pt Point to project.
+     * @param[in] uv Starting parameters.
+     * @param[in] lo Lower corner of the rectangle.
+     * @param[in] hi Upper corner of the rectangle.
+     * @param[inout] best_d2 Squared distance of the starting point if known,
+     * and of the returned point on output.
+     * @param[inout] scratch Buffers of the calling thread.
+     * @return Parameters of the closest point found
+     */
+    glm::vec<2, T> newton(const glm::vec<3, T> &pt, glm::vec<2, T> uv, const glm::vec<2, T> &lo,
+                          const glm::vec<2, T> &hi, T &best_d2, Scratch &scratch) const
+    {
+        const T eps = std::numeric_limits<T>::epsilon();
+        const T cos_tol = 8 * eps;
+        const int max_iters = 32;
+        glm::vec<2, T> best_uv = uv;
+        glm::vec<2, T> prev_uv = uv;
+        T prev_d2 = std::numeric_limits<T>::infinity();
+        bool prev_edge_u = false, prev_edge_v = false;
+        for (int iter = 0; iter < max_iters; ++iter)
+        {
+            surfaceDerivatives(srf, 2, uv.x, uv.y, scratch.ders, scratch.ws);
+            const array2<glm::vec<3, T>> &ders = scratch.ders;
+            const glm::vec<3, T> diff = ders(0, 0) - pt;
+            const T d2 = glm::dot(diff, diff);
+            if (d2 > prev_d2 * (1 + 16 * eps))
+            {
+                // Overshot, backtrack halfway to the previous iterate
+                uv = (prev_uv + uv) / T(2);
+                continue;
+            }
+            prev_uv = uv;
+            prev_d2 = d2;
+            if (d2 <= best_d2 * (1 + 16 * eps))
+            {
+                best_uv = uv;
+                best_d2 = std::min(best_d2, d2);
+            }
+
+            // Converged when the point lies on the surface or the difference is
+            // orthogonal to both tangents
+            const T gu = glm::dot(ders(1, 0), diff), gv = glm::dot(ders(0, 1), diff);
+            const T su2 = glm::dot(ders(1, 0), ders(1, 0)), sv2 = glm::dot(ders(0, 1), ders(0, 1));
+            if (d2 <= eps * eps || (gu * gu <= cos_tol * cos_tol * su2 * d2 &&
+                                    gv * gv <= cos_tol * cos_tol * sv2 * d2))
+            {
+                break;
+            }
+
+            const T huu = glm::dot(ders(2, 0), diff) + su2;
+            const T huv = glm::dot(ders(1, 1), diff) + glm::dot(ders(1, 0), ders(0, 1));
+            const T hvv = glm::dot(ders(0, 2), diff) + sv2;
+            // Shift the Hessian to be positive definite where the squared
+            // distance is not convex, e.g. near poles or far from the surface
+            T shift = 0;
+            const T min_eigen =
+                (huu + hvv) / 2 - std::sqrt((huu - hvv) * (huu - hvv) / 4 + huv * huv);
+            if (!(min_eigen > cos_tol * (su2 + sv2)))
+            {
+                shift = (su2 + sv2) / 16 - min_eigen;
+            }
+            const T det = (huu + shift) * (hvv + shift) - huv * huv;
+            if (!(det > 0))
+            {
+                break;
+            }
+            glm::vec<2, T> dir(huv * gv - (hvv + shift) * gu, huv * gu - (huu + shift) * gv);
+            glm::vec<2, T> next = uv + dir / det;
+
+            // Newton cannot follow an edge once a step leaves the rectangle
+            // across it, so continue from the projection onto the isocurve along
+            // the edge, and stop when the step leaves across the same edges again
+            const glm::vec<2, T> clamped = glm::min(glm::max(next, lo), hi);
+            if (next != clamped)
+            {
+                const bool edge_u = next.x != clamped.x, edge_v = next.y != clamped.y;
+                if (edge_u == prev_edge_u && edge_v == prev_edge_v)
+                {
+                    break;
+                }
+                prev_edge_u = edge_u;
+                prev_edge_v = edge_v;
+                // Evaluate the isocurves at their breaks, but keep iterating
+                // inside the span, from the closer one at a corner
+                T edge_d2 = std::numeric_limits<T>::infinity();
+                if (edge_u)
+                {
+                    glm::vec<2, T> edge = clamped;
+                    CurveProjector<T> &projector = isoProjector(true, clamped.x, edge.x, scratch);
+                    edge.y = projector.project(pt, clamped.y, lo.y, hi.y);
+                    edge_d2 = edgeCandidate(pt, edge, best_uv, best_d2, scratch);
+                    next = glm::vec<2, T>(clamped.x, edge.y);
+                }
+                if (edge_v)
+                {
+                    glm::vec<2, T> edge = clamped;
+                    CurveProjector<T> &projector = isoProjector(false, clamped.y, edge.y, scratch);
+                    edge.x = projector.project(pt, clamped.x, lo.x, hi.x);
+                    if (edgeCandidate(pt, edge, best_uv, best_d2, scratch) < edge_d2)
+                    {
+                        next = glm::vec<2, T>(edge.x, clamped.y);
+                    }
+                }
+                prev_d2 = std::numeric_limits<T>::infinity();
+                uv = next;
+                continue;
+            }
+            prev_edge_u = prev_edge_v = false;
+
+            const glm::vec<2, T> step = glm::abs(next - uv);
+            if (step.x <= 4 * eps * std::max(std::abs(uv.x), hi.x - lo.x) &&
+                step.y <= 4 * eps * std::max(std::abs(uv.y), hi.y - lo.y))
+            {
+                // Stalled, typically against the boundary of the rectangle
+                break;
+            }
+            uv = next;
+        }
+        return best_uv;
+    }
+
+    /**
+     * Projector onto the isocurve of the surface along the break at an edge of
+     * a patch, built on first use and kept in the scratch
+     * @param[in] fixed_u Whether the edge is at a fixed u, rather than a fixed v.
+     * @param[in] param Parameter of the edge, possibly moved inside its span.
+     * @param[out] at Break of the edge, the fixed parameter of the isocurve.
+     * @param[inout] scratch Buffers of the calling thread.
+     * @return Projector onto the isocurve
+     */
+    CurveProjector<T> &isoProjector(bool fixed_u, T param, T &at, Scratch &scratch) const
+    {
+        if (scratch.owner != this)
+        {
+            scratch.owner = this;
+            scratch.iso_u.clear();
+            scratch.iso_v.clear();
+        }
+        const std::vector<T> &breaks = fixed_u ? breaks_u : breaks_v;
+        std::vector<std::unique_ptr<CurveProjector<T>>> &cache =
+            fixed_u ? scratch.iso_u : scratch.iso_v;
+        cache.resize(breaks.size());
+        // Ends of spans are moved inside the span, so round up to the break
+        size_t k = std::lower_bound(breaks.begin(), breaks.end(), param) - breaks.begin();
+        k = std::min(k, breaks.size() - 1);
+        at = breaks[k];
+        if (!cache[k])
+        {
+            cache[k].reset(fixed_u ? new CurveProjector<T>(surfaceIsoCurveV(srf, at))
+                                   : new CurveProjector<T>(surfaceIsoCurveU(srf, at)));
+        }
+        return *cache[k];
+    }
+
+    /**
+     * Keep parameters found on an edge if they are closer than the best so far
+     * @return Squared distance at the parameters
+     */
+    T edgeCandidate(const glm::vec<3, T> &pt, const glm::vec<2, T> &uv,
+                       glm::vec<2, T> &best_uv, T &best_d2, Scratch &scratch) const
+    {
+        const glm::vec<3, T> diff = surfacePoint(srf, uv.x, uv.y, scratch.ws) - pt;
+        const T d2 = glm::dot(diff, diff);
+        if (d2 < best_d2)
+        {
+            best_uv = uv;
+            best_d2 = d2;
+        }
+        return d2;
+    }
+};
+
+/**
+ * Project many points onto a surface on several threads. Points are split into
+ * fixed chunks, and each query starts from the result of the previous one in
+ * its chunk, so results do not depend on the number of threads.
+ * @param[in] srf Surface or RationalSurface object
+ * @param[in] points Points to project onto the surface.
+ * @param[out] params Parameters of the closest point for each point.
+ * @param[in] num_threads Number of threads, 0 for one per hardware thread.
+ */
+template <typename T, typename SurfaceType>
+void surfaceClosestPoints(const SurfaceType &srf, const std::vector<glm::vec<3, T>> &points,
+                          std::vector<glm::vec<2, T>> &params, unsigned int num_threads)
+{
+    typedef SurfaceProjector<T, SurfaceType> Projector;
+    const Projector projector(srf);
+    params.resize(points.size());
+
+    const size_t chunk = 64;
+    const size_t num_chunks = (points.size() + chunk - 1) / chunk;
+    const unsigned int threads = util::threadCount(num_threads, num_chunks);
+    std::vector<typename Projector::Scratch> scratch(threads);
+    util::parallelFor(num_chunks, threads, [&](size_t c, unsigned int thread) {
+        glm::vec<2, T> hint(std::numeric_limits<T>::quiet_NaN());
+        for (size_t i = c * chunk; i < std::min(points.size(), (c + 1) * chunk); ++i)
+        {
+            params[i] = hint = projector.project(points[i], hint, scratch[thread]);
+        }
+    });
+}
+
+} // namespace internal
+
+/////////////////////////////////////////////////////////////////////
+
+/**
+ * Find the parameter of the point of a curve closest to a point
+ * @param[in] crv Curve object
+ * @param[in] pt Point to project onto the curve.
+ * @return Parameter of the closest point on the curve
+ */
+template <typename T> T curveClosestPoint(const Curve<T> &crv, const glm::vec<3, T> &pt)
+{
+    internal::CurveProjector<T> projector(crv);
+    return projector.project(pt);
+}
+
+/**
+ * Find the parameter of the point of a rational curve closest to a point
+ * @param[in] crv RationalCurve object
+ * @param[in] pt Point to project onto the curve.
+ * @return Parameter of the closest point on the curve
+ */
+template <typename T> T curveClosestPoint(const RationalCurve<T> &crv, const glm::vec<3, T> &pt)
+{
+    internal::CurveProjector<T> projector(crv);
+    return projector.project(pt);
+}
+
+/**
+ * Find the parameters of the points of a curve closest to many points. Each
+ * query starts from the result of the previous one, which makes points ordered
+ * along the curve cheap to project.
+ * @param[in] crv Curve object
+ * @param[in] points Points to project onto the curve.
+ * @param[out] params Parameter of the closest point for each point.
+ */
+template <typename T>
+void curveClosestPoints(const Curve<T> &crv, const std::vector<glm::vec<3, T>> &points,
+                        std::vector<T> &params)
+{
+    internal::CurveProjector<T> projector(crv);
+    params.resize(points.size());
+    T hint = std::numeric_limits<T>::quiet_NaN();
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        params[i] = hint = projector.project(points[i], hint);
+    }
+}
+
+/**
+ * Find the parameters of the points of a rational curve closest to many points.
+ * Each query starts from the result of the previous one, which makes points
+ * ordered along the curve cheap to project.
+ * @param[in] crv RationalCurve object
+ * @param[in] points Points to project onto the curve.
+ * @param[out] params Parameter of the closest point for each point.
+ */
+template <typename T>
+void curveClosestPoints(const RationalCurve<T> &crv, const std::vector<glm::vec<3, T>> &points,
+                        std::vector<T> &params)
+{
+    internal::CurveProjector<T> projector(crv);
+    params.resize(points.size());
+    T hint = std::numeric_limits<T>::quiet_NaN();
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        params[i] = hint = projector.project(points[i], hint);
+    }
+}
+
+/**
+ * Find the parameters of the point of a surface closest to a point
+ * @param[in] srf Surface object
+ * @param[in] pt Point to project onto the surface.
+ * @return Parameters (u, v) of the closest point on the surface
+ */
+template <typename T>
+glm::vec<2, T> surfaceClosestPoint(const Surface<T> &srf, const glm::vec<3, T> &pt)
+{
+    typename internal::SurfaceProjector<T, Surface<T>>::Scratch scratch;
+    return internal::SurfaceProjector<T, Surface<T>>(srf).project(
+        pt, glm::vec<2, T>(std::numeric_limits<T>::quiet_NaN()), scratch);
+}
+
+/**
+ * Find the parameters of the point of a rational surface closest to a point
+ * @param[in] srf RationalSurface object
+ * @param[in] pt Point to project onto the surface.
+ * @return Parameters (u, v) of the closest point on the surface
+ */
+template <typename T>
+glm::vec<2, T> surfaceClosestPoint(const RationalSurface<T> &srf, const glm::vec<3, T> &pt)
+{
+    typename internal::SurfaceProjector<T, RationalSurface<T>>::Scratch scratch;
+    return internal::SurfaceProjector<T, RationalSurface<T>>(srf).project(
+        pt, glm::vec<2, T>(std::numeric_limits<T>::quiet_NaN()), scratch);
+}
+
+/**
+ * Find the parameters of the points of a surface closest to many points, on
+ * several threads. Each query starts from the result of the previous point, so
+ * scans ordered along the surface are cheap to project.
+ * @param[in] srf Surface object
+ * @param[in] points Points to project onto the surface.
+ * @param[out] params Parameters (u, v) of the closest point for each point.
+ * @param[in] num_threads Number of threads, 0 for one per hardware thread.
+ */
+template <typename T>
+void surfaceClosestPoints(const Surface<T> &srf, const std::vector<glm::vec<3, T>> &points,
+                          std::vector<glm::vec<2, T>> &params, unsigned int num_threads = 0)
+{
+    internal::surfaceClosestPoints(srf, points, params, num_threads);
+}
+
+/**
+ * Find the parameters of the points of a rational surface closest to many
+ * points, on several threads. Each query starts from the result of the previous
+ * point, so scans ordered along the surface are cheap to project.
+ * @param[in] srf RationalSurface object
+ * @param[in] points Points to project onto the surface.
+ * @param[out] params Parameters (u, v) of the closest point for each point.
+ * @param[in] num_threads Number of threads, 0 for one per hardware thread.
+ */
+template <typename T>
+void surfaceClosestPoints(const RationalSurface<T> &srf, const std::vector<glm::vec<3, T>> &points,
+                          std::vector<glm::vec<2, T>> &params, unsigned int num_threads = 0)
+{
+    internal::surfaceClosestPoints(srf, points, params, num_threads);
+}
+
+} // namespace tinynurbs
+
+#endif // TINYNURBS_PROJECT_H
@@ -10,6 +10,7 @@
 #define TINYNURBS_SURFACE_H
 
 #include "../util/array2.h"
+#include "../util/util.h"
 #include "glm/glm.hpp"
 #include <stdexcept>
 #include <vector>
@@ -19,6 +20,7 @@ namespace tinynurbs
 
 // Forward declaration
 template <typename T> struct RationalSurface;
+template <typename T> struct SoaSurface;
 
 /**
 Struct for representing a non-rational NURBS surface
@@ -42,6 +44,20 @@ template <typename T> struct Surface
           control_points(control_points)
     {
     }
+    explicit Surface(const SoaSurface<T> &srf)
+        : degree_u(srf.degree_u), degree_v(srf.degree_v), knots_u(srf.knots_u),
+          knots_v(srf.knots_v), control_points(srf.rows, srf.cols)
+    {
+        for (size_t i = 0; i < srf.rows; ++i)
+        {
+            for (size_t j = 0; j < srf.cols; ++j)
+            {
+                size_t k = i * srf.stride + j;
+                T w = srf.w.empty() ? T(1) : srf.w[k];
+                control_points(i, j) = glm::vec<3, T>(srf.x[k], srf.y[k], srf.z[k]) / w;
+            }
+        }
+    }
 };
 
 /**
@@ -72,6 +88,133 @@ template <typename T> struct RationalSurface
           control_points(control_points), weights(weights)
     {
     }
+    explicit RationalSurface(const SoaSurface<T> &srf)
+        : RationalSurface(Surface<T>(srf), array2<T>(srf.rows, srf.cols, 1.0))
+    {
+        if (!srf.w.empty())
+        {
+            for (size_t i = 0; i < srf.rows; ++i)
+            {
+                for (size_t j = 0; j < srf.cols; ++j)
+                {
+                    weights(i, j) = srf.w[i * srf.stride + j];
+                }
+            }
+        }
+    }
+};
+
+/**
+Struct for representing a rational NURBS surface with its control points
+premultiplied by their weights, i.e., stored in homogenous coordinates. Build it
+once from a RationalSurface to evaluate the same surface repeatedly without
+reweighting.
+\tparam T Data type of control points and knots (float or double)
+*/
+template <typename T> struct HomogenousSurface
+{
+    unsigned int degree_u, degree_v;
+    std::vector<T> knots_u, knots_v;
+    array2<glm::vec<4, T>> control_points;
+
+    HomogenousSurface() = default;
+    HomogenousSurface(const Surface<T> &srf)
+        : HomogenousSurface(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                            srf.control_points,
+                            array2<T>(srf.control_points.rows(), srf.control_points.cols(), 1.0))
+    {
+    }
+    HomogenousSurface(const RationalSurface<T> &srf)
+        : HomogenousSurface(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                            srf.control_points, srf.weights)
+    {
+    }
+    HomogenousSurface(unsigned int degree_u, unsigned int degree_v,
+                      const std::vector<T> &knots_u, const std::vector<T> &knots_v,
+                      const array2<glm::vec<3, T>> &control_points, const array2<T> &weights)
+        : degree_u(degree_u), degree_v(degree_v), knots_u(knots_u), knots_v(knots_v),
+          control_points(util::cartesianToHomogenous(control_points, weights))
+    {
+    }
+};
+
+/**
+Struct for representing a NURBS surface with its control points stored as
+separate planes of x, y, z and, for rational surfaces, w coordinates. Rational
+control points are premultiplied by their weights. Each plane is row-major with
+rows padded to a multiple of the alignment, so that weighted sums over a row of
+control points run over contiguous, aligned memory.
+\tparam T Data type of control points and knots (float or double)
+*/
+template <typename T> struct SoaSurface
+{
+    // Alignment in bytes of each plane and each padded row
+    static constexpr size_t alignment = 64;
+    typedef std::vector<T, util::AlignedAllocator<T, alignment>> plane_type;
+
+    unsigned int degree_u, degree_v;
+    std::vector<T> knots_u, knots_v;
+    // Number of control points along u and v, and padded length of each row
+    size_t rows = 0, cols = 0, stride = 0;
+    // Coordinate (i, j) of each plane is at index i * stride + j. w is empty for
+    // non-rational surfaces.
+    plane_type x, y, z, w;
+
+    SoaSurface() = default;
+    SoaSurface(const Surface<T> &srf)
+        : degree_u(srf.degree_u), degree_v(srf.degree_v), knots_u(srf.knots_u),
+          knots_v(srf.knots_v)
+    {
+        resize(srf.control_points.rows(), srf.control_points.cols(), false);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            for (size_t j = 0; j < cols; ++j)
+            {
+                const glm::vec<3, T> &pt = srf.control_points(i, j);
+                size_t k = i * stride + j;
+                x[k] = pt.x;
+                y[k] = pt.y;
+                z[k] = pt.z;
+            }
+        }
+    }
+    SoaSurface(const RationalSurface<T> &srf)
+        : degree_u(srf.degree_u), degree_v(srf.degree_v), knots_u(srf.knots_u),
+          knots_v(srf.knots_v)
+    {
+        resize(srf.control_points.rows(), srf.control_points.cols(), true);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            for (size_t j = 0; j < cols; ++j)
+            {
+                glm::vec<3, T> pt = srf.control_points(i, j) * srf.weights(i, j);
+                size_t k = i * stride + j;
+                x[k] = pt.x;
+                y[k] = pt.y;
+                z[k] = pt.z;
+                w[k] = srf.weights(i, j);
+            }
+        }
+    }
+
+    /**
+     * Resize the planes to the given number of control points, setting all
+     * coordinates to zero
+     * @param[in] rows Number of control points along u.
+     * @param[in] cols Number of control points along v.
+     * @param[in] rational Whether to allocate the w plane.
+     */
+    void resize(size_t rows, size_t cols, bool rational)
+    {
+        const size_t lanes = alignment / sizeof(T);
+        this->rows = rows;
+        this->cols = cols;
+        stride = (cols + lanes - 1) / lanes * lanes;
+        x.assign(rows * stride, T(0));
+        y.assign(rows * stride, T(0));
+        z.assign(rows * stride, T(0));
+        w.assign(rational ? rows * stride : 0, T(0));
+    }
 };
 
 // Typedefs for ease of use
@@ -79,6 +222,10 @@ typedef Surface<float> Surface3f;
 typedef Surface<double> Surface3d;
 typedef RationalSurface<float> RationalSurface3f;
 typedef RationalSurface<double> RationalSurface3d;
+typedef HomogenousSurface<float> HomogenousSurface3f;
+typedef HomogenousSurface<double> HomogenousSurface3d;
+typedef SoaSurface<float> SoaSurface3f;
+typedef SoaSurface<double> SoaSurface3d;
 
 } // namespace tinynurbs
 
@@ -0,0 +1,1366 @@
+/**
+ * Tessellation of curves and surfaces into polylines and triangle meshes
+ *
+ * Use of this source code is governed by a BSD-style license that can be found in
+ * the LICENSE file.
+ */
+
+#ifndef TINYNURBS_TESSELLATE_H
+#define TINYNURBS_TESSELLATE_H
+
+#include "../util/array2.h"
+#include "../util/parallel.h"
+#include "../util/util.h"
+#include "basis.h"
+#include "compiled.h"
+#include "curve.h"
+#include "evaluate.h"
+#include "glm/glm.hpp"
+#include "surface.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tinynurbs
+{
+
+/**
+Struct for representing an indexed triangle mesh with one position, normal and
+(u, v) parameter per vertex. Triangles are counter-clockwise when viewed from
+the side the normals point to.
+\tparam T Data type of positions and parameters (float or double)
+*/
+template <typename T> struct TriangleMesh
+{
+    std::vector<glm::vec<3, T>> positions, normals;
+    std::vector<glm::vec<2, T>> uvs;
+    // Three vertex indices per triangle
+    std::vector<unsigned int> indices;
+
+    size_t numVertices() const
+    {
+        return positions.size();
+    }
+
+    size_t numTriangles() const
+    {
+        return indices.size() / 3;
+    }
+};
+
+/**
+Struct for a band of rows of a grid tessellation, passed to the sink of
+surfaceTessellateStream(). The mesh holds the vertices of the rows of the band,
+preceded by the vertices of the last row of the previous band for all bands but
+the first, and the triangles between these rows in indices local to the band.
+\tparam T Data type of positions and parameters (float or double)
+*/
+template <typename T> struct TessellationBand
+{
+    TriangleMesh<T> mesh;
+    // Index in the full mesh of the first vertex and the first triangle of the band
+    size_t first_vertex = 0, first_triangle = 0;
+    // Number of leading vertices that already belonged to the previous band
+    size_t num_shared = 0;
+};
+
+/**
+Range of consecutive vertices [first, first + count) of a mesh
+*/
+struct VertexRange
+{
+    size_t first = 0, count = 0;
+};
+
+namespace internal
+{
+
+/**
+ * Append the triangles of a grid of vertices, two per cell, where vertex (i, j)
+ * is at index offset + i * cols + j
+ * @param[in] rows Number of rows of vertices.
+ * @param[in] cols Number of columns of vertices.
+ * @param[in] offset Index of the first vertex of the grid.
+ * @param[inout] indices Triangle indices to append to.
+ */
+inline void gridTriangles(size_t rows, size_t cols, size_t offset,
+                          std::vector<unsigned int> &indices)
+{
+    if (rows < 2 || cols < 2)
+    {
+        return;
+    }
+    indices.reserve(indices.size() + 6 * (rows - 1) * (cols - 1));
+    for (size_t i = 0; i + 1 < rows; ++i)
+    {
+        for (size_t j = 0; j + 1 < cols; ++j)
+        {
+            // Rows follow u and columns follow v, and the normal is der_v x der_u
+            unsigned int a = static_cast<unsigned int>(offset + i * cols + j);
+            unsigned int b = a + 1;
+            unsigned int c = a + static_cast<unsigned int>(cols);
+            unsigned int d = c + 1;
+            indices.insert(indices.end(), {a, b, c, c, b, d});
+        }
+    }
+}
+
+/**
+ * Find the samples that depend on a range of control points along one
+ * direction of a surface
+ * @param[in] spans Span of each sample, in ascending order.
+ * @param[in] degree Degree along the direction.
+ * @param[in] first First control point of the range.
+ * @param[in] last Last control point of the range.
+ * @return First sample and one past the last sample whose non-zero basis
+ * functions overlap the range
+ */
+inline std::pair<size_t, size_t> supportedSamples(const std::vector<int> &spans,
+                                                  unsigned int degree, size_t first, size_t last)
+{
+    // Sample s depends on control points spans[s] - degree ... spans[s]
+    auto lo = std::lower_bound(spans.begin(), spans.end(), static_cast<int>(first));
+    auto hi = std::upper_bound(lo, spans.end(), static_cast<int>(last + degree));
+    return {static_cast<size_t>(lo - spans.begin()), static_cast<size_t>(hi - spans.begin())};
+}
+
+/**
+ * Compute the non-zero basis functions and their first derivatives at
+ * parameters whose spans are given. A parameter on a knot can be evaluated as
+ * the end of the span to its left.
+ * @param[in] degree Degree of the basis functions.
+ * @param[in] knots Knot vector of the basis functions.
+ * @param[in] params Parameters to evaluate the basis functions at.
+ * @param[in] spans Span of each parameter.
+ * @param[out] ders Basis functions and derivatives, laid out as in derBasisRows().
+ */
+template <typename T>
+void spanBasisRows(unsigned int degree, const std::vector<T> &knots, const std::vector<T> &params,
+                   const std::vector<int> &spans, array2<T> &ders)
+{
+    EvalWorkspace<T> ws;
+    ders.resize(params.size(), 2 * (degree + 1));
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        bsplineDerBasis(degree, spans[i], knots, params[i], 1, ws.ders_u, ws.ndu, ws.a);
+        for (int k = 0; k <= 1; ++k)
+        {
+            for (unsigned int j = 0; j <= degree; ++j)
+            {
+                ders(i, k * (degree + 1) + j) = ws.ders_u(k, j);
+            }
+        }
+    }
+}
+
+/**
+ * Evaluate points and unit normals of a non-rational surface, or of a rational
+ * surface in homogenous coordinates, over a block of a grid of samples. The
+ * control points are contracted along u once per row of the block.
+ * @param[in] degree_u Degree of the surface along u.
+ * @param[in] degree_v Degree of the surface along v.
+ * @param[in] control_points Control points of the surface.
+ * @param[in] spans_u Span of each sample along u.
+ * @param[in] ders_u Basis functions and first derivatives of each sample along
+ * u, laid out as in derBasisRows().
+ * @param[in] row_begin First sample along u of the block.
+ * @param[in] row_end One past the last sample along u of the block.
+ * @param[in] spans_v Span of each sample along v.
+ * @param[in] ders_v Basis functions and first derivatives of each sample along v.
+ * @param[in] col_begin First sample along v of the block.
+ * @param[in] col_end One past the last sample along v of the block.
+ * @param[in] stride Distance between rows of the output.
+ * @param[out] positions Point at sample (i, j) of the block in
+ * positions[(i - row_begin) * stride + j - col_begin].
+ * @param[out] normals Unit normals, laid out as the points.
+ */
+template <int dim, typename T>
+void gridFrames(unsigned int degree_u, unsigned int degree_v,
+                const array2<glm::vec<dim, T>> &control_points, const std::vector<int> &spans_u,
+                const array2<T> &ders_u, size_t row_begin, size_t row_end,
+                const std::vector<int> &spans_v, const array2<T> &ders_v, size_t col_begin,
+                size_t col_end, size_t stride, glm::vec<3, T> *positions,
+                glm::vec<3, T> *normals)
+{
+    typedef glm::vec<dim, T> tvecn;
+
+    // Columns of control points used by the block
+    size_t cp_begin = spans_v[col_begin] - degree_v;
+    size_t cp_end = spans_v[col_end - 1] + 1;
+    std::vector<tvecn> temp(cp_end - cp_begin), temp_u(cp_end - cp_begin);
+
+    for (size_t i = row_begin; i < row_end; ++i)
+    {
+        int row0 = spans_u[i] - degree_u;
+        for (size_t c = cp_begin; c < cp_end; ++c)
+        {
+            tvecn sum(0.0), sum_u(0.0);
+            for (unsigned int k = 0; k <= degree_u; ++k)
+            {
+                const tvecn &cp = control_points(row0 + k, c);
+                sum += ders_u(i, k) * cp;
+                sum_u += ders_u(i, degree_u + 1 + k) * cp;
+            }
+            temp[c - cp_begin] = sum;
+            temp_u[c - cp_begin] = sum_u;
+        }
+
+        size_t out = (i - row_begin) * stride;
+        for (size_t j = col_begin; j < col_end; ++j, ++out)
+        {
+            size_t col0 = spans_v[j] - degree_v - cp_begin;
+            tvecn pt(0.0), der_u(0.0), der_v(0.0);
+            for (unsigned int l = 0; l <= degree_v; ++l)
+            {
+                pt += ders_v(j, l) * temp[col0 + l];
+                der_u += ders_v(j, l) * temp_u[col0 + l];
+                der_v += ders_v(j, degree_v + 1 + l) * temp[col0 + l];
+            }
+            glm::vec<3, T> tangent_u, tangent_v;
+            surfaceFrameFromDerivatives(pt, der_u, der_v, positions[out], tangent_u, tangent_v,
+                                        normals[out]);
+        }
+    }
+}
+
+/**
+ * Choose the samples along one direction of a surface for tessellation
+ * @param[in] degree Degree along the direction.
+ * @param[in] knots Knot vector along the direction.
+ * @param[in] n Number of samples, or with knot-aligned sampling the number of
+ * samples that is distributed over the spans in proportion to their length.
+ * @param[in] knot_aligned Whether to sample every knot and to split the samples
+ * into blocks at knots where the surface is only C0.
+ * @param[out] params Parameters of the samples.
+ * @param[out] spans Span of each sample. A sample that ends a block at a knot
+ * uses the span to its left.
+ * @param[out] blocks Start of each block of samples, followed by the number of
+ * samples. Consecutive blocks share the parameter at their boundary.
+ */
+template <typename T>
+void tessellationSamples(unsigned int degree, const std::vector<T> &knots, size_t n,
+                         bool knot_aligned, std::vector<T> &params, std::vector<int> &spans,
+                         std::vector<size_t> &blocks)
+{
+    params.clear();
+    spans.clear();
+    blocks.assign(1, 0);
+
+    std::vector<T> breaks;
+    std::vector<int> break_spans;
+    compiledBreaks(degree, knots, breaks, break_spans);
+    const T lo = breaks.front(), hi = breaks.back();
+    const size_t segments = std::max<size_t>(n, 2) - 1;
+
+    if (!knot_aligned)
+    {
+        int span = -1;
+        for (size_t i = 0; i <= segments; ++i)
+        {
+            T u = (i == segments) ? hi : lo + (hi - lo) * i / segments;
+            span = findSpan(degree, knots, u, span);
+            params.push_back(u);
+            spans.push_back(span);
+        }
+        blocks.push_back(params.size());
+        return;
+    }
+
+    for (size_t s = 0; s + 1 < breaks.size(); ++s)
+    {
+        T a = breaks[s], b = breaks[s + 1];
+        if (s == 0)
+        {
+            params.push_back(a);
+            spans.push_back(break_spans[s]);
+        }
+        else if (break_spans[s] - break_spans[s - 1] >= static_cast<int>(degree))
+        {
+            // Knot of multiplicity >= degree, start a new block on its right
+            blocks.push_back(params.size());
+            params.push_back(a);
+            spans.push_back(break_spans[s]);
+        }
+        size_t k = static_cast<size_t>(std::round(segments * (b - a) / (hi - lo)));
+        k = std::max<size_t>(k, 1);
+        for (size_t i = 1; i <= k; ++i)
+        {
+            params.push_back(i == k ? b : a + (b - a) * i / k);
+            spans.push_back(break_spans[s]);
+        }
+    }
+    blocks.push_back(params.size());
+}
+
+/**
+ * Compute the Bezier control points, in homogenous coordinates, of one segment
+ * of a compiled curve from its power basis coefficients
+ * @param[in] crv CompiledCurve object
+ * @param[in] seg Index of the segment.
+ * @param[out] bezier Control points of the segment over [0, 1].
+ */
+template <typename T>
+void compiledBezier(const CompiledCurve<T> &crv, size_t seg, std::vector<glm::vec<4, T>> &bezier)
+{
+    typedef glm::vec<4, T> tvec4;
+
+    const unsigned int p = crv.degree;
+    const size_t base = seg * (p + 1);
+    const T h = crv.breaks[seg + 1] - crv.breaks[seg];
+    const bool rational = !crv.wcoeffs.empty();
+
+    // Coefficients of the segment reparametrized over [0, 1], then
+    // b_j = sum_{i <= j} (j choose i) / (p choose i) * a_i
+    bezier.assign(p + 1, tvec4(0.0));
+    T h_pow = 1;
+    for (unsigned int i = 0; i <= p; ++i)
+    {
+        T w = rational ? crv.wcoeffs[base + i] : (i == 0 ? T(1) : T(0));
+        tvec4 a = tvec4(crv.coeffs[base + i], w) * h_pow;
+        for (unsigned int j = i; j <= p; ++j)
+        {
+            bezier[j] += static_cast<T>(util::binomial(j, i)) /
+                         static_cast<T>(util::binomial(p, i)) * a;
+        }
+        h_pow *= h;
+    }
+}
+
+/**
+ * Split a Bezier curve in homogenous coordinates with de Casteljau's algorithm
+ * @param[in] bezier Control points of the curve.
+ * @param[in] t Parameter in [0, 1] to split at.
+ * @param[out] left Control points of the part over [0, t].
+ * @param[out] right Control points of the part over [t, 1].
+ */
+template <typename T>
+void bezierSplit(const std::vector<glm::vec<4, T>> &bezier, T t,
+                 std::vector<glm::vec<4, T>> &left, std::vector<glm::vec<4, T>> &right)
+{
+    const size_t n = bezier.size();
+    right = bezier;
+    left.resize(n);
+    left[0] = right[0];
+    for (size_t k = 1; k < n; ++k)
+    {
+        for (size_t j = 0; j < n - k; ++j)
+        {
+            right[j] = (T(1) - t) * right[j] + t * right[j + 1];
+        }
+        left[k] = right[0];
+    }
+}
+
+/**
+ * Upper bound of the distance between a Bezier curve in homogenous coordinates
+ * with positive weights and the chord between its end points. The curve lies in
+ * the convex hull of its control points, and for non-rational curves the
+ * distance is also at most p * (p - 1) / 8 times the largest second difference
+ * of the control points.
+ * @param[in] bezier Control points of the curve.
+ * @param[in] rational Whether the weights may differ from 1.
+ * @return Bound of the distance.
+ */
+template <typename T> T bezierFlatness(const std::vector<glm::vec<4, T>> &bezier, bool rational)
+{
+    typedef glm::vec<3, T> tvec3;
+
+    const size_t n = bezier.size();
+    const tvec3 a = util::homogenousToCartesian(bezier.front());
+    const tvec3 b = util::homogenousToCartesian(bezier.back());
+    const tvec3 ab = b - a;
+    const T len2 = glm::dot(ab, ab);
+
+    T hull = 0;
+    for (size_t j = 1; j + 1 < n; ++j)
+    {
+        tvec3 pt = util::homogenousToCartesian(bezier[j]);
+        T t = len2 > 0 ? glm::clamp(glm::dot(pt - a, ab) / len2, T(0), T(1)) : T(0);
+        hull = std::max(hull, glm::distance(pt, a + t * ab));
+    }
+    if (rational || n < 3)
+    {
+        return hull;
+    }
+
+    T diff = 0;
+    for (size_t j = 0; j + 2 < n; ++j)
+    {
+        tvec3 d2 = util::truncateHomogenous(bezier[j] - T(2) * bezier[j + 1] + bezier[j + 2]);
+        diff = std::max(diff, glm::length(d2));
+    }
+    T p = static_cast<T>(n - 1);
+    return std::min(hull, p * (p - 1) / 8 * diff);
+}
+
+/**
+ * Flatten a Bezier segment of a curve into a polyline within a tolerance. The
+ * segment is first split into as many equal parts as its flatness suggests,
+ * since the distance to the chord shrinks with the square of the part length,
+ * and parts that are still not flat enough are bisected.
+ * @param[in] bezier Control points of the segment in homogenous coordinates.
+ * @param[in] u0 Parameter of the start of the segment.
+ * @param[in] u1 Parameter of the end of the segment.
+ * @param[in] tolerance Largest allowed distance between curve and polyline.
+ * @param[in] rational Whether the weights may differ from 1.
+ * @param[in] depth Number of times the segment was split already.
+ * @param[inout] points Points of the polyline, to which the end points of each
+ * part are appended.
+ * @param[inout] params Parameters of the points.
+ */
+template <typename T>
+void bezierFlatten(const std::vector<glm::vec<4, T>> &bezier, T u0, T u1, T tolerance,
+                   bool rational, int depth, std::vector<glm::vec<3, T>> &points,
+                   std::vector<T> &params)
+{
+    // Limits the output for tolerances below the precision of T
+    const int max_depth = 24;
+
+    T flatness = bezierFlatness(bezier, rational);
+    if (flatness <= tolerance || depth >= max_depth)
+    {
+        points.push_back(util::homogenousToCartesian(bezier.back()));
+        params.push_back(u1);
+        return;
+    }
+
+    int parts = 2;
+    if (depth == 0)
+    {
+        parts = std::max(2, static_cast<int>(std::ceil(std::sqrt(flatness / tolerance))));
+    }
+    std::vector<glm::vec<4, T>> rest = bezier, part, temp;
+    for (int k = 0; k < parts; ++k)
+    {
+        T a = u0 + (u1 - u0) * k / parts;
+        T b = (k + 1 == parts) ? u1 : u0 + (u1 - u0) * (k + 1) / parts;
+        if (k + 1 < parts)
+        {
+            bezierSplit(rest, T(1) / (parts - k), part, temp);
+            rest.swap(temp);
+        }
+        else
+        {
+            part.swap(rest);
+        }
+        bezierFlatten(part, a, b, tolerance, rational, depth + 1, points, params);
+    }
+}
+
+/**
+ * Tessellate a surface into a triangle mesh over a grid of samples
+ * @param[in] degree_u Degree of the surface along u.
+ * @param[in] degree_v Degree of the surface along v.
+ * @param[in] knots_u Knot vector of the surface along u.
+ * @param[in] knots_v Knot vector of the surface along v.
+ * @param[in] control_points Control points of a non-rational surface, or of a
+ * rational surface in homogenous coordinates.
+ * @param[in] nu Number of samples along u.
+ * @param[in] nv Number of samples along v.
+ * @param[in] knot_aligned Whether to sample every knot and duplicate vertices
+ * along knots where the surface is only C0.
+ * @param[out] mesh Triangle mesh of the surface.
+ */
+template <int dim, typename T>
+void surfaceTessellate(unsigned int degree_u, unsigned int degree_v,
+                       const std::vector<T> &knots_u, const std::vector<T> &knots_v,
+                       const array2<glm::vec<dim, T>> &control_points, size_t nu, size_t nv,
+                       bool knot_aligned, TriangleMesh<T> &mesh)
+{
+    std::vector<T> us, vs;
+    std::vector<int> spans_u, spans_v;
+    std::vector<size_t> blocks_u, blocks_v;
+    array2<T> ders_u, ders_v;
+    tessellationSamples(degree_u, knots_u, nu, knot_aligned, us, spans_u, blocks_u);
+    tessellationSamples(degree_v, knots_v, nv, knot_aligned, vs, spans_v, blocks_v);
+    spanBasisRows(degree_u, knots_u, us, spans_u, ders_u);
+    spanBasisRows(degree_v, knots_v, vs, spans_v, ders_v);
+
+    size_t num_vertices = us.size() * vs.size();
+    mesh.positions.resize(num_vertices);
+    mesh.normals.resize(num_vertices);
+    mesh.uvs.resize(num_vertices);
+    mesh.indices.clear();
+
+    // One grid of vertices per pair of blocks
+    size_t offset = 0;
+    for (size_t a = 0; a + 1 < blocks_u.size(); ++a)
+    {
+        size_t row_begin = blocks_u[a], row_end = blocks_u[a + 1];
+        for (size_t b = 0; b + 1 < blocks_v.size(); ++b)
+        {
+            size_t col_begin = blocks_v[b], col_end = blocks_v[b + 1];
+            size_t cols = col_end - col_begin;
+            gridFrames(degree_u, degree_v, control_points, spans_u, ders_u, row_begin, row_end,
+                       spans_v, ders_v, col_begin, col_end, cols, &mesh.positions[offset],
+                       &mesh.normals[offset]);
+            for (size_t i = row_begin; i < row_end; ++i)
+            {
+                for (size_t j = col_begin; j < col_end; ++j)
+                {
+                    mesh.uvs[offset + (i - row_begin) * cols + j - col_begin] =
+                        glm::vec<2, T>(us[i], vs[j]);
+                }
+            }
+            gridTriangles(row_end - row_begin, cols, offset, mesh.indices);
+            offset += (row_end - row_begin) * cols;
+        }
+    }
+}
+
+/**
+ * Tessellate a surface over a uniform grid of samples in bands of rows, without
+ * keeping more than one band in memory
+ * @param[in] degree_u Degree of the surface along u.
+ * @param[in] degree_v Degree of the surface along v.
+ * @param[in] knots_u Knot vector of the surface along u.
+ * @param[in] knots_v Knot vector of the surface along v.
+ * @param[in] control_points Control points of a non-rational surface, or of a
+ * rational surface in homogenous coordinates.
+ * @param[in] nu Number of samples along u.
+ * @param[in] nv Number of samples along v.
+ * @param[in] band_rows Number of rows of samples per band.
+ * @param[in] sink Function called with each TessellationBand in order.
+ */
+template <int dim, typename T, typename Sink>
+void surfaceTessellateStream(unsigned int degree_u, unsigned int degree_v,
+                             const std::vector<T> &knots_u, const std::vector<T> &knots_v,
+                             const array2<glm::vec<dim, T>> &control_points, size_t nu, size_t nv,
+                             size_t band_rows, Sink &sink)
+{
+    std::vector<T> vs;
+    std::vector<int> spans_v;
+    std::vector<size_t> blocks_v;
+    array2<T> ders_v;
+    tessellationSamples(degree_v, knots_v, nv, false, vs, spans_v, blocks_v);
+    spanBasisRows(degree_v, knots_v, vs, spans_v, ders_v);
+    nv = vs.size();
+
+    // Same samples along u as tessellationSamples(), generated one band at a time
+    nu = std::max<size_t>(nu, 2);
+    band_rows = std::max<size_t>(band_rows, 1);
+    const size_t segments = nu - 1;
+    const T lo = knots_u[degree_u], hi = knots_u[knots_u.size() - degree_u - 1];
+
+    TessellationBand<T> band;
+    std::vector<T> us;
+    std::vector<int> spans_u;
+    array2<T> ders_u;
+    int span = -1;
+    for (size_t row_begin = 0; row_begin < nu; row_begin += band_rows)
+    {
+        size_t row_end = std::min(nu, row_begin + band_rows);
+        size_t first = (row_begin == 0) ? 0 : row_begin - 1;
+        size_t rows = row_end - first;
+
+        us.clear();
+        spans_u.clear();
+        for (size_t i = first; i < row_end; ++i)
+        {
+            T u = (i == segments) ? hi : lo + (hi - lo) * i / segments;
+            span = findSpan(degree_u, knots_u, u, span);
+            us.push_back(u);
+            spans_u.push_back(span);
+        }
+        spanBasisRows(degree_u, knots_u, us, spans_u, ders_u);
+
+        TriangleMesh<T> &mesh = band.mesh;
+        mesh.positions.resize(rows * nv);
+        mesh.normals.resize(rows * nv);
+        mesh.uvs.resize(rows * nv);
+        gridFrames(degree_u, degree_v, control_points, spans_u, ders_u, 0, rows, spans_v, ders_v,
+                   0, nv, nv, mesh.positions.data(), mesh.normals.data());
+        for (size_t i = 0; i < rows; ++i)
+        {
+            for (size_t j = 0; j < nv; ++j)
+            {
+                mesh.uvs[i * nv + j] = glm::vec<2, T>(us[i], vs[j]);
+            }
+        }
+        mesh.indices.clear();
+        gridTriangles(rows, nv, 0, mesh.indices);
+
+        band.first_vertex = first * nv;
+        band.first_triangle = 2 * first * (nv - 1);
+        band.num_shared = (row_begin - first) * nv;
+        sink(static_cast<const TessellationBand<T> &>(band));
+    }
+}
+
+/**
+Cell of the parameter-space quadtree of adaptive surface tessellation, in
+integer lattice coordinates. Each top-level cell is one pair of non-empty knot
+spans, divided into resolution x resolution lattice units.
+*/
+struct QuadCell
+{
+    uint32_t x, y, size;
+    unsigned int depth;
+};
+
+/**
+Adaptive tessellation of a non-rational surface, or of a rational surface in
+homogenous coordinates, by refining a quadtree per pair of knot spans until the
+chord and normal deviation are within tolerance. Vertices are shared through
+their lattice coordinates, and leaves with finer neighbors are triangulated as
+fans around their center that include the vertices of the neighbors on their
+edges, so the mesh has no T-junctions.
+*/
+template <int dim, typename T> struct AdaptiveTessellator
+{
+    unsigned int degree_u, degree_v;
+    const std::vector<T> &knots_u, &knots_v;
+    const array2<glm::vec<dim, T>> &control_points;
+    T chord_tol, cos_angle_tol;
+    unsigned int max_depth;
+    uint32_t resolution;
+    std::vector<T> breaks_u, breaks_v;
+
+    AdaptiveTessellator(unsigned int degree_u, unsigned int degree_v,
+                        const std::vector<T> &knots_u, const std::vector<T> &knots_v,
+                        const array2<glm::vec<dim, T>> &control_points, T chord_tol,
+                        T angle_tol, unsigned int max_depth)
+        : degree_u(degree_u), degree_v(degree_v), knots_u(knots_u), knots_v(knots_v),
+          control_points(control_points), chord_tol(chord_tol),
+          cos_angle_tol(std::cos(angle_tol)), max_depth(max_depth),
+          resolution(uint32_t(1) << (max_depth + 1))
+    {
+        std::vector<int> spans;
+        compiledBreaks(degree_u, knots_u, breaks_u, spans);
+        compiledBreaks(degree_v, knots_v, breaks_v, spans);
+
+        // Lattice coordinates run up to the number of cells times the resolution
+        size_t cells = std::max(breaks_u.size(), breaks_v.size()) - 1;
+        if (static_cast<uint64_t>(cells) * resolution > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::runtime_error("Too many knot spans for the adaptive tessellation depth");
+        }
+    }
+
+    /**
+     * Parameter of a lattice coordinate along one direction
+     */
+    T param(const std::vector<T> &breaks, uint32_t x) const
+    {
+        size_t a = std::min<size_t>(x / resolution, breaks.size() - 2);
+        uint32_t rem = x - static_cast<uint32_t>(a * resolution);
+        if (rem == resolution)
+        {
+            return breaks[a + 1];
+        }
+        return breaks[a] + (breaks[a + 1] - breaks[a]) * rem / resolution;
+    }
+
+    void frame(uint32_t x, uint32_t y, glm::vec<3, T> &point, glm::vec<3, T> &normal,
+               EvalWorkspace<T> &ws) const
+    {
+        glm::vec<3, T> tangent_u, tangent_v;
+        surfaceFrame(degree_u, degree_v, knots_u, knots_v, control_points,
+                     param(breaks_u, x), param(breaks_v, y), point, tangent_u, tangent_v,
+                     normal, ws);
+    }
+
+    /**
+     * Whether a cell deviates from its bilinear approximation by more than the
+     * chord tolerance, or its normals deviate from the normal at its center by
+     * more than the angle tolerance, judged from its corners, edge midpoints
+     * and center
+     */
+    bool needsSplit(const QuadCell &cell, EvalWorkspace<T> &ws) const
+    {
+        typedef glm::vec<3, T> tvec3;
+
+        const uint32_t h = cell.size / 2;
+        tvec3 pts[3][3], nrm[3][3];
+        for (int a = 0; a < 3; ++a)
+        {
+            for (int b = 0; b < 3; ++b)
+            {
+                frame(cell.x + a * h, cell.y + b * h, pts[a][b], nrm[a][b], ws);
+            }
+        }
+
+        T chord = glm::distance(pts[1][1],
+                                (pts[0][0] + pts[0][2] + pts[2][0] + pts[2][2]) / T(4));
+        chord = std::max(chord, glm::distance(pts[0][1], (pts[0][0] + pts[0][2]) / T(2)));
+        chord = std::max(chord, glm::distance(pts[2][1], (pts[2][0] + pts[2][2]) / T(2)));
+        chord = std::max(chord, glm::distance(pts[1][0], (pts[0][0] + pts[2][0]) / T(2)));
+        chord = std::max(chord, glm::distance(pts[1][2], (pts[0][2] + pts[2][2]) / T(2)));
+        if (chord > chord_tol)
+        {
+            return true;
+        }
+
+        // Zero normals at degenerate points are ignored
+        const tvec3 &center = nrm[1][1];
+        if (glm::dot(center, center) == 0)
+        {
+            return false;
+        }
+        for (int a = 0; a < 3; ++a)
+        {
+            for (int b = 0; b < 3; ++b)
+            {
+                const tvec3 &n = nrm[a][b];
+                if (glm::dot(n, n) > 0 && glm::dot(n, center) < cos_angle_tol)
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Refine the quadtree of one top-level cell
+     * @param[in] root Top-level cell.
+     * @param[out] leaves Leaves of the quadtree, in depth-first order.
+     * @param[inout] ws Workspace of the calling thread.
+     */
+    void refine(const QuadCell &root, std::vector<QuadCell> &leaves, EvalWorkspace<T> &ws) const
+    {
+        leaves.clear();
+        std::vector<QuadCell> stack(1, root);
+        while (!stack.empty())
+        {
+            QuadCell cell = stack.back();
+            stack.pop_back();
+            if (cell.depth >= max_depth || !needsSplit(cell, ws))
+            {
+                leaves.push_back(cell);
+                continue;
+            }
+            uint32_t h = cell.size / 2;
+            unsigned int d = cell.depth + 1;
+            // Pushed in reverse so that children are visited in order
+            stack.push_back({cell.x + h, cell.y + h, h, d});
+            stack.push_back({cell.x + h, cell.y, h, d});
+            stack.push_back({cell.x, cell.y + h, h, d});
+            stack.push_back({cell.x, cell.y, h, d});
+        }
+    }
+
+    /**
+     * Build the mesh
+     * @param[in] num_threads Number of threads, 0 for one per hardware thread.
+     * @param[out] mesh Triangle mesh of the surface.
+     */
+    void tessellate(unsigned int num_threads, TriangleMesh<T> &mesh) const
+    {
+        const size_t cells_u = breaks_u.size() - 1, cells_v = breaks_v.size() - 1;
+        const size_t num_cells = cells_u * cells_v;
+        const unsigned int threads = util::threadCount(num_threads, num_cells);
+        std::vector<EvalWorkspace<T>> workspaces(threads);
+
+        // Refine the top-level cells in parallel
+        std::vector<std::vector<QuadCell>> leaves(num_cells);
+        util::parallelFor(num_cells, threads, [&](size_t c, unsigned int thread) {
+            QuadCell root = {static_cast<uint32_t>((c / cells_v) * resolution),
+                             static_cast<uint32_t>((c % cells_v) * resolution), resolution, 0};
+            refine(root, leaves[c], workspaces[thread]);
+        });
+
+        // Number the corners of all leaves
+        std::unordered_map<uint64_t, unsigned int> index;
+        std::vector<std::pair<uint32_t, uint32_t>> coords;
+        auto vertex = [&](uint32_t x, uint32_t y) {
+            uint64_t key = (static_cast<uint64_t>(x) << 32) | y;
+            auto it = index.emplace(key, static_cast<unsigned int>(coords.size()));
+            if (it.second)
+            {
+                coords.emplace_back(x, y);
+            }
+            return it.first->second;
+        };
+        for (const std::vector<QuadCell> &cell_leaves : leaves)
+        {
+            for (const QuadCell &leaf : cell_leaves)
+            {
+                vertex(leaf.x, leaf.y);
+                vertex(leaf.x, leaf.y + leaf.size);
+                vertex(leaf.x + leaf.size, leaf.y);
+                vertex(leaf.x + leaf.size, leaf.y + leaf.size);
+            }
+        }
+
+        // Triangulate each leaf, clockwise in (u, v) like gridTriangles()
+        mesh.indices.clear();
+        std::vector<unsigned int> loop;
+        for (const std::vector<QuadCell> &cell_leaves : leaves)
+        {
+            for (const QuadCell &leaf : cell_leaves)
+            {
+                uint32_t x0 = leaf.x, y0 = leaf.y;
+                uint32_t x1 = leaf.x + leaf.size, y1 = leaf.y + leaf.size;
+                loop.clear();
+                loop.push_back(index[(static_cast<uint64_t>(x0) << 32) | y0]);
+                edgeVertices(index, x0, y0, x0, y1, loop);
+                loop.push_back(index[(static_cast<uint64_t>(x0) << 32) | y1]);
+                edgeVertices(index, x0, y1, x1, y1, loop);
+                loop.push_back(index[(static_cast<uint64_t>(x1) << 32) | y1]);
+                edgeVertices(index, x1, y1, x1, y0, loop);
+                loop.push_back(index[(static_cast<uint64_t>(x1) << 32) | y0]);
+                edgeVertices(index, x1, y0, x0, y0, loop);
+
+                if (loop.size() == 4)
+                {
+                    mesh.indices.insert(mesh.indices.end(),
+                                        {loop[0], loop[1], loop[3], loop[3], loop[1], loop[2]});
+                    continue;
+                }
+                // Transition fan around the center of the leaf
+                unsigned int center = vertex(x0 + leaf.size / 2, y0 + leaf.size / 2);
+                for (size_t k = 0; k < loop.size(); ++k)
+                {
+                    mesh.indices.insert(mesh.indices.end(),
+                                        {center, loop[k], loop[(k + 1) % loop.size()]});
+                }
+            }
+        }
+
+        // Evaluate the vertices in parallel
+        mesh.positions.resize(coords.size());
+        mesh.normals.resize(coords.size());
+        mesh.uvs.resize(coords.size());
+        util::parallelFor(
+            coords.size(), threads,
+            [&](size_t k, unsigned int thread) {
+                uint32_t x = coords[k].first, y = coords[k].second;
+                frame(x, y, mesh.positions[k], mesh.normals[k], workspaces[thread]);
+                mesh.uvs[k] = glm::vec<2, T>(param(breaks_u, x), param(breaks_v, y));
+            },
+            256);
+    }
+
+    /**
+     * Append the vertices strictly between two corners of a leaf, in order from
+     * the first corner. A vertex of a finer neighbor on the edge implies one at
+     * the midpoint, so the edge is searched by bisection.
+     */
+    static void edgeVertices(const std::unordered_map<uint64_t, unsigned int> &index, uint32_t xa,
+                             uint32_t ya, uint32_t xb, uint32_t yb,
+                             std::vector<unsigned int> &loop)
+    {
+        uint32_t dx = xa > xb ? xa - xb : xb - xa;
+        uint32_t dy = ya > yb ? ya - yb : yb - ya;
+        if (dx + dy < 2)
+        {
+            return;
+        }
+        uint32_t xm = (xa + xb) / 2, ym = (ya + yb) / 2;
+        auto it = index.find((static_cast<uint64_t>(xm) << 32) | ym);
+        if (it == index.end())
+        {
+            return;
+        }
+        edgeVertices(index, xa, ya, xm, ym, loop);
+        loop.push_back(it->second);
+        edgeVertices(index, xm, ym, xb, yb, loop);
+    }
+};
+
+} // namespace internal
+
+/**
+Struct for keeping a triangle mesh of a surface up to date while its control
+points are edited. The spans and basis functions of the grid of parameters are
+computed once, and an edit of a control point only re-evaluates the vertices in
+its support, at a cost of O(degree_u * degree_v) per affected vertex. The ranges
+of vertices changed since the last clearDirty() can be queried for partial
+uploads.
+
+Vertex (i, j) of the mesh is the sample at (us[i], vs[j]) and has index
+i * vs.size() + j. The parameters must be in ascending order.
+\tparam T Data type of control points and knots (float or double)
+*/
+template <typename T> struct SurfaceTessellation
+{
+    unsigned int degree_u, degree_v;
+    std::vector<T> knots_u, knots_v;
+    // Control points in homogenous coordinates, with weights 1 for non-rational
+    // surfaces
+    array2<glm::vec<4, T>> control_points;
+    bool rational = false;
+    std::vector<T> us, vs;
+    // Spans and basis functions with their first derivatives of the parameters,
+    // laid out as in internal::derBasisRows()
+    std::vector<int> spans_u, spans_v;
+    array2<T> ders_u, ders_v;
+    TriangleMesh<T> mesh;
+    // Columns [first, second) of each row of vertices changed since the last
+    // clearDirty(), and the rows with any changes
+    std::vector<std::pair<size_t, size_t>> dirty_cols;
+    std::vector<size_t> dirty_rows;
+
+    SurfaceTessellation() = default;
+    SurfaceTessellation(const Surface<T> &srf, const std::vector<T> &us, const std::vector<T> &vs)
+        : degree_u(srf.degree_u), degree_v(srf.degree_v), knots_u(srf.knots_u),
+          knots_v(srf.knots_v),
+          control_points(srf.control_points.rows(), srf.control_points.cols()), rational(false),
+          us(us), vs(vs)
+    {
+        for (size_t k = 0; k < control_points.size(); ++k)
+        {
+            control_points[k] = glm::vec<4, T>(srf.control_points[k], 1);
+        }
+        init();
+    }
+    SurfaceTessellation(const RationalSurface<T> &srf, const std::vector<T> &us,
+                        const std::vector<T> &vs)
+        : degree_u(srf.degree_u), degree_v(srf.degree_v), knots_u(srf.knots_u),
+          knots_v(srf.knots_v),
+          control_points(util::cartesianToHomogenous(srf.control_points, srf.weights)),
+          rational(true), us(us), vs(vs)
+    {
+        init();
+    }
+
+    /**
+     * Move one control point and re-evaluate the vertices in its support
+     * @param[in] i Row of the control point.
+     * @param[in] j Column of the control point.
+     * @param[in] pt New position of the control point.
+     * @param[in] w New weight of the control point, 1 for non-rational surfaces.
+     */
+    void setControlPoint(size_t i, size_t j, const glm::vec<3, T> &pt, T w = 1)
+    {
+        control_points(i, j) = util::cartesianToHomogenous(pt, w);
+        update(i, i, j, j);
+    }
+
+    /**
+     * Re-evaluate the vertices in the support of a block of control points,
+     * after modifying control_points directly
+     * @param[in] first_i First row of the block.
+     * @param[in] last_i Last row of the block.
+     * @param[in] first_j First column of the block.
+     * @param[in] last_j Last column of the block.
+     */
+    void update(size_t first_i, size_t last_i, size_t first_j, size_t last_j)
+    {
+        auto rows = internal::supportedSamples(spans_u, degree_u, first_i, last_i);
+        auto cols = internal::supportedSamples(spans_v, degree_v, first_j, last_j);
+        evaluate(rows.first, rows.second, cols.first, cols.second);
+    }
+
+    /**
+     * Ranges of vertices changed since the last clearDirty(), in ascending
+     * order. Ranges of consecutive rows are merged.
+     * @param[out] ranges Changed vertex ranges.
+     */
+    void dirtyRanges(std::vector<VertexRange> &ranges) const
+    {
+        ranges.clear();
+        std::vector<size_t> rows = dirty_rows;
+        std::sort(rows.begin(), rows.end());
+        for (size_t i : rows)
+        {
+            VertexRange range;
+            range.first = i * vs.size() + dirty_cols[i].first;
+            range.count = dirty_cols[i].second - dirty_cols[i].first;
+            if (!ranges.empty() && ranges.back().first + ranges.back().count == range.first)
+            {
+                ranges.back().count += range.count;
+            }
+            else
+            {
+                ranges.push_back(range);
+            }
+        }
+    }
+
+    /**
+     * Mark all vertices as unchanged
+     */
+    void clearDirty()
+    {
+        for (size_t i : dirty_rows)
+        {
+            dirty_cols[i] = {0, 0};
+        }
+        dirty_rows.clear();
+    }
+
+  private:
+    void init()
+    {
+        internal::derBasisRows(degree_u, knots_u, us, 1, spans_u, ders_u);
+        internal::derBasisRows(degree_v, knots_v, vs, 1, spans_v, ders_v);
+
+        size_t num_vertices = us.size() * vs.size();
+        mesh.positions.resize(num_vertices);
+        mesh.normals.resize(num_vertices);
+        mesh.uvs.resize(num_vertices);
+        for (size_t i = 0; i < us.size(); ++i)
+        {
+            for (size_t j = 0; j < vs.size(); ++j)
+            {
+                mesh.uvs[i * vs.size() + j] = glm::vec<2, T>(us[i], vs[j]);
+            }
+        }
+        mesh.indices.clear();
+        internal::gridTriangles(us.size(), vs.size(), 0, mesh.indices);
+
+        dirty_cols.assign(us.size(), {0, 0});
+        dirty_rows.clear();
+        evaluate(0, us.size(), 0, vs.size());
+        clearDirty();
+    }
+
+    /**
+     * Evaluate the vertices in rows [row_begin, row_end) and columns
+     * [col_begin, col_end), and mark them as changed
+     */
+    void evaluate(size_t row_begin, size_t row_end, size_t col_begin, size_t col_end)
+    {
+        if (row_begin >= row_end || col_begin >= col_end)
+        {
+            return;
+        }
+
+        size_t first = row_begin * vs.size() + col_begin;
+        internal::gridFrames(degree_u, degree_v, control_points, spans_u, ders_u, row_begin,
+                             row_end, spans_v, ders_v, col_begin, col_end, vs.size(),
+                             &mesh.positions[first], &mesh.normals[first]);
+
+        for (size_t i = row_begin; i < row_end; ++i)
+        {
+            std::pair<size_t, size_t> &dirty = dirty_cols[i];
+            if (dirty.first == dirty.second)
+            {
+                dirty_rows.push_back(i);
+                dirty = {col_begin, col_end};
+            }
+            else
+            {
+                dirty = {std::min(dirty.first, col_begin), std::max(dirty.second, col_end)};
+            }
+        }
+    }
+};
+
+/**
+ * Flatten a compiled curve into a polyline whose distance to the curve is at
+ * most the given tolerance, using few vertices. Each segment is split
+ * adaptively, based on a bound of the distance between the segment and its
+ * chord derived from its Bezier control points.
+ * @param[in] crv CompiledCurve object, with positive weights if rational
+ * @param[in] tolerance Largest allowed distance between curve and polyline.
+ * @param[out] points Vertices of the polyline, starting and ending at the ends
+ * of the curve.
+ * @param[out] params Parameter of each vertex.
+ */
+template <typename T>
+void curveTessellate(const CompiledCurve<T> &crv, T tolerance,
+                     std::vector<glm::vec<3, T>> &points, std::vector<T> &params)
+{
+    points.clear();
+    params.clear();
+    const bool rational = !crv.wcoeffs.empty();
+    std::vector<glm::vec<4, T>> bezier;
+    for (size_t seg = 0; seg + 1 < crv.breaks.size(); ++seg)
+    {
+        internal::compiledBezier(crv, seg, bezier);
+        if (seg == 0)
+        {
+            points.push_back(util::homogenousToCartesian(bezier.front()));
+            params.push_back(crv.breaks.front());
+        }
+        internal::bezierFlatten(bezier, crv.breaks[seg], crv.breaks[seg + 1], tolerance,
+                                rational, 0, points, params);
+    }
+}
+
+/**
+ * Flatten a curve into a polyline whose distance to the curve is at most the
+ * given tolerance
+ * @param[in] crv Curve or RationalCurve object, with positive weights
+ * @param[in] tolerance Largest allowed distance between curve and polyline.
+ * @param[out] points Vertices of the polyline.
+ * @param[out] params Parameter of each vertex.
+ */
+template <typename CurveType, typename T>
+void curveTessellate(const CurveType &crv, T tolerance, std::vector<glm::vec<3, T>> &points,
+                     std::vector<T> &params)
+{
+    curveTessellate(CompiledCurve<T>(crv), tolerance, points, params);
+}
+
+/**
+ * Flatten a curve into a polyline whose distance to the curve is at most the
+ * given tolerance, with unit tangents and arc lengths of the vertices
+ * @param[in] crv Curve or RationalCurve object, with positive weights
+ * @param[in] tolerance Largest allowed distance between curve and polyline.
+ * @param[out] points Vertices of the polyline.
+ * @param[out] params Parameter of each vertex.
+ * @param[out] tangents Unit tangent of the curve at each vertex.
+ * @param[out] lengths Length of the polyline up to each vertex.
+ */
+template <typename CurveType, typename T>
+void curveTessellate(const CurveType &crv, T tolerance, std::vector<glm::vec<3, T>> &points,
+                     std::vector<T> &params, std::vector<glm::vec<3, T>> &tangents,
+                     std::vector<T> &lengths)
+{
+    CompiledCurve<T> ccrv(crv);
+    curveTessellate(ccrv, tolerance, points, params);
+
+    EvalWorkspace<T> ws;
+    std::vector<glm::vec<3, T>> ders;
+    tangents.resize(points.size());
+    lengths.resize(points.size());
+    for (size_t k = 0; k < points.size(); ++k)
+    {
+        curveDerivatives(ccrv, 1, params[k], ders, ws);
+        T len = glm::length(ders[1]);
+        tangents[k] = util::close(len, T(0)) ? ders[1] : ders[1] / len;
+        lengths[k] = (k == 0) ? T(0) : lengths[k - 1] + glm::distance(points[k - 1], points[k]);
+    }
+}
+
+/**
+ * Flatten a curve into a polyline whose distance to the curve is at most the
+ * given tolerance
+ * @param[in] crv Curve or RationalCurve object, with positive weights
+ * @param[in] tolerance Largest allowed distance between curve and polyline.
+ * @return Vertices of the polyline.
+ */
+template <typename T>
+std::vector<glm::vec<3, T>> curveTessellate(const Curve<T> &crv, T tolerance)
+{
+    std::vector<glm::vec<3, T>> points;
+    std::vector<T> params;
+    curveTessellate(crv, tolerance, points, params);
+    return points;
+}
+
+/**
+ * Flatten a rational curve into a polyline whose distance to the curve is at
+ * most the given tolerance
+ * @param[in] crv RationalCurve object, with positive weights
+ * @param[in] tolerance Largest allowed distance between curve and polyline.
+ * @return Vertices of the polyline.
+ */
+template <typename T>
+std::vector<glm::vec<3, T>> curveTessellate(const RationalCurve<T> &crv, T tolerance)
+{
+    std::vector<glm::vec<3, T>> points;
+    std::vector<T> params;
+    curveTessellate(crv, tolerance, points, params);
+    return points;
+}
+
+/**
+ * Tessellate a surface into an indexed triangle mesh with positions, unit
+ * normals and (u, v) parameters per vertex, over a grid of samples
+ * @param[in] srf Surface object
+ * @param[in] nu Number of samples along u, at least 2.
+ * @param[in] nv Number of samples along v, at least 2.
+ * @param[out] mesh Triangle mesh of the surface.
+ * @param[in] knot_aligned Whether to place samples on every knot, spreading
+ * the others over the spans in proportion to their length, and to duplicate
+ * the vertices along knots where the surface is only C0, so that each side of
+ * a crease gets its own normals.
+ */
+template <typename T>
+void surfaceTessellate(const Surface<T> &srf, size_t nu, size_t nv, TriangleMesh<T> &mesh,
+                       bool knot_aligned = false)
+{
+    internal::surfaceTessellate(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                                srf.control_points, nu, nv, knot_aligned, mesh);
+}
+
+/**
+ * Tessellate a rational surface into an indexed triangle mesh with positions,
+ * unit normals and (u, v) parameters per vertex, over a grid of samples
+ * @param[in] srf RationalSurface object
+ * @param[in] nu Number of samples along u, at least 2.
+ * @param[in] nv Number of samples along v, at least 2.
+ * @param[out] mesh Triangle mesh of the surface.
+ * @param[in] knot_aligned Whether to place samples on every knot and duplicate
+ * the vertices along knots where the surface is only C0.
+ */
+template <typename T>
+void surfaceTessellate(const RationalSurface<T> &srf, size_t nu, size_t nv,
+                       TriangleMesh<T> &mesh, bool knot_aligned = false)
+{
+    internal::surfaceTessellate(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                                util::cartesianToHomogenous(srf.control_points, srf.weights),
+                                nu, nv, knot_aligned, mesh);
+}
+
+/**
+ * Tessellate a surface into an indexed triangle mesh over a grid of samples
+ * @param[in] srf Surface object
+ * @param[in] nu Number of samples along u, at least 2.
+ * @param[in] nv Number of samples along v, at least 2.
+ * @param[in] knot_aligned Whether to place samples on every knot and duplicate
+ * the vertices along knots where the surface is only C0.
+ * @return Triangle mesh of the surface.
+ */
+template <typename T>
+TriangleMesh<T> surfaceTessellate(const Surface<T> &srf, size_t nu, size_t nv,
+                                  bool knot_aligned = false)
+{
+    TriangleMesh<T> mesh;
+    surfaceTessellate(srf, nu, nv, mesh, knot_aligned);
+    return mesh;
+}
+
+/**
+ * Tessellate a rational surface into an indexed triangle mesh over a grid of
+ * samples
+ * @param[in] srf RationalSurface object
+ * @param[in] nu Number of samples along u, at least 2.
+ * @param[in] nv Number of samples along v, at least 2.
+ * @param[in] knot_aligned Whether to place samples on every knot and duplicate
+ * the vertices along knots where the surface is only C0.
+ * @return Triangle mesh of the surface.
+ */
+template <typename T>
+TriangleMesh<T> surfaceTessellate(const RationalSurface<T> &srf, size_t nu, size_t nv,
+                                  bool knot_aligned = false)
+{
+    TriangleMesh<T> mesh;
+    surfaceTessellate(srf, nu, nv, mesh, knot_aligned);
+    return mesh;
+}
+
+/**
+ * Tessellate a surface into a triangle mesh whose density adapts to the shape
+ * of the surface. Each pair of knot spans is refined as a quadtree in parameter
+ * space until the distance of the surface to the bilinear approximation of a
+ * cell is within chord_tol and its normals deviate by at most angle_tol. Cells
+ * next to finer cells are triangulated as fans that include the vertices of the
+ * finer cells on their edges, so the mesh has no T-junctions or cracks. Pairs
+ * of knot spans are refined in parallel.
+ * @param[in] srf Surface object
+ * @param[in] chord_tol Largest allowed distance between surface and mesh.
+ * @param[in] angle_tol Largest allowed normal deviation within a cell, in radians.
+ * @param[out] mesh Triangle mesh of the surface.
+ * @param[in] max_depth Largest number of times a pair of knot spans is split
+ * along each direction, at most 20. Throws std::runtime_error if the number of
+ * knot spans along a direction times 2^(max_depth + 1) does not fit in 32 bits.
+ * @param[in] num_threads Number of threads, 0 for one per hardware thread.
+ */
+template <typename T>
+void surfaceTessellateAdaptive(const Surface<T> &srf, T chord_tol, T angle_tol,
+                               TriangleMesh<T> &mesh, unsigned int max_depth = 8,
+                               unsigned int num_threads = 0)
+{
+    assert(max_depth <= 20);
+    internal::AdaptiveTessellator<3, T> tess(srf.degree_u, srf.degree_v, srf.knots_u,
+                                             srf.knots_v, srf.control_points, chord_tol,
+                                             angle_tol, max_depth);
+    tess.tessellate(num_threads, mesh);
+}
+
+/**
+ * Tessellate a rational surface into a triangle mesh whose density adapts to
+ * the shape of the surface, without T-junctions
+ * @param[in] srf RationalSurface object
+ * @param[in] chord_tol Largest allowed distance between surface and mesh.
+ * @param[in] angle_tol Largest allowed normal deviation within a cell, in radians.
+ * @param[out] mesh Triangle mesh of the surface.
+ * @param[in] max_depth Largest number of times a pair of knot spans is split
+ * along each direction, at most 20. Throws std::runtime_error if the number of
+ * knot spans along a direction times 2^(max_depth + 1) does not fit in 32 bits.
+ * @param[in] num_threads Number of threads, 0 for one per hardware thread.
+ */
+template <typename T>
+void surfaceTessellateAdaptive(const RationalSurface<T> &srf, T chord_tol, T angle_tol,
+                               TriangleMesh<T> &mesh, unsigned int max_depth = 8,
+                               unsigned int num_threads = 0)
+{
+    assert(max_depth <= 20);
+    array2<glm::vec<4, T>> cpws = util::cartesianToHomogenous(srf.control_points, srf.weights);
+    internal::AdaptiveTessellator<4, T> tess(srf.degree_u, srf.degree_v, srf.knots_u,
+                                             srf.knots_v, cpws, chord_tol, angle_tol, max_depth);
+    tess.tessellate(num_threads, mesh);
+}
+
+/**
+ * Tessellate a surface into a triangle mesh whose density adapts to the shape
+ * of the surface, without T-junctions
+ * @param[in] srf Surface object
+ * @param[in] chord_tol Largest allowed distance between surface and mesh.
+ * @param[in] angle_tol Largest allowed normal deviation within a cell, in radians.
+ * @return Triangle mesh of the surface.
+ */
+template <typename T>
+TriangleMesh<T> surfaceTessellateAdaptive(const Surface<T> &srf, T chord_tol, T angle_tol)
+{
+    TriangleMesh<T> mesh;
+    surfaceTessellateAdaptive(srf, chord_tol, angle_tol, mesh);
+    return mesh;
+}
+
+/**
+ * Tessellate a rational surface into a triangle mesh whose density adapts to
+ * the shape of the surface, without T-junctions
+ * @param[in] srf RationalSurface object
+ * @param[in] chord_tol Largest allowed distance between surface and mesh.
+ * @param[in] angle_tol Largest allowed normal deviation within a cell, in radians.
+ * @return Triangle mesh of the surface.
+ */
+template <typename T>
+TriangleMesh<T> surfaceTessellateAdaptive(const RationalSurface<T> &srf, T chord_tol,
+                                          T angle_tol)
+{
+    TriangleMesh<T> mesh;
+    surfaceTessellateAdaptive(srf, chord_tol, angle_tol, mesh);
+    return mesh;
+}
+
+/**
+ * Tessellate a surface over a uniform grid of samples and pass the mesh to a
+ * sink in bands of rows, so that memory use is proportional to the size of a
+ * band rather than of the mesh. Vertices and triangles are numbered as in
+ * surfaceTessellate() with the same number of samples, and bands arrive in
+ * order.
+ * @param[in] srf Surface object
+ * @param[in] nu Number of samples along u, at least 2.
+ * @param[in] nv Number of samples along v, at least 2.
+ * @param[in] band_rows Number of rows of samples per band.
+ * @param[in] sink Function or writer called with each TessellationBand.
+ */
+template <typename T, typename Sink>
+void surfaceTessellateStream(const Surface<T> &srf, size_t nu, size_t nv, size_t band_rows,
+                             Sink &&sink)
+{
+    internal::surfaceTessellateStream(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                                      srf.control_points, nu, nv, band_rows, sink);
+}
+
+/**
+ * Tessellate a rational surface over a uniform grid of samples and pass the
+ * mesh to a sink in bands of rows
+ * @param[in] srf RationalSurface object
+ * @param[in] nu Number of samples along u, at least 2.
+ * @param[in] nv Number of samples along v, at least 2.
+ * @param[in] band_rows Number of rows of samples per band.
+ * @param[in] sink Function or writer called with each TessellationBand.
+ */
+template <typename T, typename Sink>
+void surfaceTessellateStream(const RationalSurface<T> &srf, size_t nu, size_t nv,
+                             size_t band_rows, Sink &&sink)
+{
+    internal::surfaceTessellateStream(srf.degree_u, srf.degree_v, srf.knots_u, srf.knots_v,
+                                      util::cartesianToHomogenous(srf.control_points,
+                                                                  srf.weights),
+                                      nu, nv, band_rows, sink);
+}
+
+// Typedefs for ease of use
+typedef TriangleMesh<float> TriangleMesh3f;
+typedef TriangleMesh<double> TriangleMesh3d;
+typedef SurfaceTessellation<float> SurfaceTessellation3f;
+typedef SurfaceTessellation<double> SurfaceTessellation3d;
+
+} // namespace tinynurbs
+
+#endif // TINYNURBS_TESSELLATE_H
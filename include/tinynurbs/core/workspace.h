@@ -0,0 +1,119 @@
+/**
+ * Reusable scratch memory for evaluating NURBS curves and surfaces without
+ * heap allocations.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found in
+ * the LICENSE file.
+ */
+
+#ifndef TINYNURBS_WORKSPACE_H
+#define TINYNURBS_WORKSPACE_H
+
+#include "../util/array2.h"
+#include "../util/util.h"
+#include "basis.h"
+#include "knots.h"
+#include "glm/glm.hpp"
+#include <array>
+#include <vector>
+
+namespace tinynurbs
+{
+
+/**
+Struct holding the scratch buffers used by the evaluation functions. Buffers
+grow on first use and are reused afterwards, so evaluating through the same
+workspace does not allocate once it has warmed up. A workspace must not be
+shared between threads; use one per thread instead.
+@tparam T Data type of control points and knots (float or double)
+*/
+template <typename T> struct EvalWorkspace
+{
+    // Spans found by the previous evaluation, used as starting points of the
+    // next span search along u and v
+    int span_u = -1, span_v = -1;
+
+    // Optional span locators used instead of searching the knot vectors. They
+    // must be built from the knots along u and v of whatever is evaluated with
+    // this workspace.
+    const SpanLocator<T> *locator_u = nullptr, *locator_v = nullptr;
+
+    // Non-zero basis functions along u and v
+    std::vector<T> basis_u, basis_v;
+
+    // Non-zero basis functions of a block of parameters, see bsplineBasisLanes()
+    std::vector<T> lane_basis;
+
+    // Non-zero basis function derivatives along u and v
+    array2<T> ders_u, ders_v;
+
+    // Scratch tables of bsplineDerBasis()
+    array2<T> ndu, a;
+
+    // Derivatives of the weight function of rational curves and surfaces
+    std::vector<T> curve_wders;
+    array2<T> surf_wders;
+
+    // Per-coordinate derivatives of SoaSurface evaluation and partial sums over
+    // a row of control points
+    std::array<array2<T>, 3> plane_ders;
+    std::vector<T> plane_temp;
+
+    // Derivatives in homogenous coordinates of HomogenousCurve and HomogenousSurface
+    std::vector<glm::vec<4, T>> curve_dersw;
+    array2<glm::vec<4, T>> surf_dersw;
+
+    // Homogenous points or derivatives of every curve of a CurveFamily, one row
+    // per derivative
+    array2<glm::vec<4, T>> family_dersw;
+
+    // Binomial coefficients used by the rational derivative formulas
+    array2<T> binomial_table;
+
+    /**
+     * Find the span of a parameter along u, using the locator if one is set and
+     * otherwise walking from the previous span
+     * @param[in] degree Degree along u.
+     * @param[in] knots Knot vector along u.
+     * @param[in] u Parameter value.
+     * @return Span index into the knot vector
+     */
+    int findSpanU(unsigned int degree, const std::vector<T> &knots, T u)
+    {
+        span_u = locator_u ? findSpan(*locator_u, u) : findSpan(degree, knots, u, span_u);
+        return span_u;
+    }
+
+    /**
+     * Find the span of a parameter along v, using the locator if one is set and
+     * otherwise walking from the previous span
+     * @param[in] degree Degree along v.
+     * @param[in] knots Knot vector along v.
+     * @param[in] v Parameter value.
+     * @return Span index into the knot vector
+     */
+    int findSpanV(unsigned int degree, const std::vector<T> &knots, T v)
+    {
+        span_v = locator_v ? findSpan(*locator_v, v) : findSpan(degree, knots, v, span_v);
+        return span_v;
+    }
+
+    /**
+     * Returns a table of binomial coefficients with bin(n, k) = nCk, growing it
+     * if it does not yet cover the given n
+     * @param[in] n Largest n that needs to be looked up
+     * @return Cached binomial table
+     */
+    const array2<T> &binomials(unsigned int n)
+    {
+        if (binomial_table.rows() <= n)
+        {
+            util::binomialTable(n, binomial_table);
+        }
+        return binomial_table;
+    }
+};
+
+} // namespace tinynurbs
+
+#endif // TINYNURBS_WORKSPACE_H
@@ -0,0 +1,327 @@
+/**
+ * Writers for triangle meshes streamed band by band from surfaceTessellateStream(),
+ * to Wavefront OBJ, binary STL or raw binary buffers.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found in
+ * the LICENSE file.
+ */
+
+#ifndef TINYNURBS_MESH_H
+#define TINYNURBS_MESH_H
+
+#include "../core/surface.h"
+#include "../core/tessellate.h"
+#include "glm/glm.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace tinynurbs
+{
+
+/////////////////////////////////////////////////////////////////////
+
+/**
+Sink for surfaceTessellateStream() writing Wavefront OBJ vertices (v), normals
+(vn) and faces (f). Vertices shared with the previous band are written once, and
+faces refer to vertices by their index in the full mesh, so the vertex and face
+lines come out in the same order for any band size.
+\tparam T Data type of the mesh (float or double)
+*/
+template <typename T> struct MeshObjWriter
+{
+    explicit MeshObjWriter(std::ostream &os) : os(os)
+    {
+    }
+
+    void operator()(const TessellationBand<T> &band)
+    {
+        const TriangleMesh<T> &mesh = band.mesh;
+        for (size_t k = band.num_shared; k < mesh.numVertices(); ++k)
+        {
+            const glm::vec<3, T> &pt = mesh.positions[k];
+            const glm::vec<3, T> &n = mesh.normals[k];
+            os << "v " << pt.x << " " << pt.y << " " << pt.z << "\n";
+            os << "vn " << n.x << " " << n.y << " " << n.z << "\n";
+        }
+        // OBJ indices start at 1
+        const size_t base = band.first_vertex + 1;
+        for (size_t k = 0; k < mesh.indices.size(); k += 3)
+        {
+            os << "f";
+            for (size_t c = 0; c < 3; ++c)
+            {
+                size_t idx = base + mesh.indices[k + c];
+                os << " " << idx << "//" << idx;
+            }
+            os << "\n";
+        }
+    }
+
+  private:
+    std::ostream &os;
+};
+
+/**
+Sink for surfaceTessellateStream() writing binary STL. The header with the
+number of triangles is written on construction, and each triangle is written with
+the normal of its plane. All values are stored as little-endian 32-bit floats.
+\tparam T Data type of the mesh (float or double)
+*/
+template <typename T> struct MeshStlWriter
+{
+    /**
+     * Write the STL header
+     * @param[in] os Binary output stream
+     * @param[in] num_triangles Number of triangles that will be written.
+     */
+    MeshStlWriter(std::ostream &os, size_t num_triangles) : os(os)
+    {
+        if (num_triangles > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::runtime_error("Too many triangles for binary STL");
+        }
+        char header[80] = "tinynurbs";
+        os.write(header, sizeof(header));
+        writeUint32(static_cast<uint32_t>(num_triangles));
+    }
+
+    void operator()(const TessellationBand<T> &band)
+    {
+        const TriangleMesh<T> &mesh = band.mesh;
+        for (size_t k = 0; k < mesh.indices.size(); k += 3)
+        {
+            const glm::vec<3, T> &a = mesh.positions[mesh.indices[k]];
+            const glm::vec<3, T> &b = mesh.positions[mesh.indices[k + 1]];
+            const glm::vec<3, T> &c = mesh.positions[mesh.indices[k + 2]];
+            glm::vec<3, T> n = glm::cross(b - a, c - a);
+            T len = glm::length(n);
+            writeVec(len > T(0) ? n / len : n);
+            writeVec(a);
+            writeVec(b);
+            writeVec(c);
+            // Attribute byte count
+            os.put(0);
+            os.put(0);
+        }
+    }
+
+  private:
+    std::ostream &os;
+
+    void writeUint32(uint32_t value)
+    {
+        char bytes[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+        }
+        os.write(bytes, 4);
+    }
+
+    void writeVec(const glm::vec<3, T> &v)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            float f = static_cast<float>(v[i]);
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            writeUint32(bits);
+        }
+    }
+};
+
+/**
+Sink for surfaceTessellateStream() writing raw binary buffers in the layout of
+TriangleMesh, for upload to a GPU or memory mapping. Each new vertex is written
+to the vertex stream as position, normal and uv (8 values of type T), and each
+triangle to the index stream as three uint32_t vertex indices in the full mesh,
+all in native byte order.
+\tparam T Data type of the mesh (float or double)
+*/
+template <typename T> struct MeshRawWriter
+{
+    MeshRawWriter(std::ostream &vertices, std::ostream &indices)
+        : vertices(vertices), indices(indices)
+    {
+    }
+
+    void operator()(const TessellationBand<T> &band)
+    {
+        const TriangleMesh<T> &mesh = band.mesh;
+        for (size_t k = band.num_shared; k < mesh.numVertices(); ++k)
+        {
+            T vertex[8] = {mesh.positions[k].x, mesh.positions[k].y, mesh.positions[k].z,
+                           mesh.normals[k].x,   mesh.normals[k].y,   mesh.normals[k].z,
+                           mesh.uvs[k].x,       mesh.uvs[k].y};
+            vertices.write(reinterpret_cast<const char *>(vertex), sizeof(vertex));
+        }
+        for (unsigned int idx : mesh.indices)
+        {
+            uint32_t global = static_cast<uint32_t>(band.first_vertex + idx);
+            indices.write(reinterpret_cast<const char *>(&global), sizeof(global));
+        }
+    }
+
+  private:
+    std::ostream &vertices, &indices;
+};
+
+/////////////////////////////////////////////////////////////////////
+
+namespace internal
+{
+
+/**
+ * Number of triangles of a uniform grid tessellation
+ * @param[in] nu Number of samples along u.
+ * @param[in] nv Number of samples along v.
+ * @return Number of triangles written by surfaceTessellateStream()
+ */
+inline size_t gridTriangleCount(size_t nu, size_t nv)
+{
+    return 2 * (std::max<size_t>(nu, 2) - 1) * (std::max<size_t>(nv, 2) - 1);
+}
+
+} // namespace internal
+
+/**
+ * Tessellate a surface and write the mesh to a Wavefront OBJ stream one band
+ * of rows at a time
+ * @param[in] os Output stream
+ * @param[in] srf Surface object
+ * @param[in] nu Number of samples along u.
+ * @param[in] nv Number of samples along v.
+ * @param[in] band_rows Number of rows of samples held in memory at once.
+ */
+template <typename T>
+void surfaceSaveMeshOBJ(std::ostream &os, const Surface<T> &srf, size_t nu, size_t nv,
+                        size_t band_rows = 64)
+{
+    surfaceTessellateStream(srf, nu, nv, band_rows, MeshObjWriter<T>(os));
+}
+
+/**
+ * Tessellate a rational surface and write the mesh to a Wavefront OBJ stream
+ * one band of rows at a time
+ * @param[in] os Output stream
+ * @param[in] srf RationalSurface object
+ * @param[in] nu Number of samples along u.
+ * @param[in] nv Number of samples along v.
+ * @param[in] band_rows Number of rows of samples held in memory at once.
+ */
+template <typename T>
+void surfaceSaveMeshOBJ(std::ostream &os, const RationalSurface<T> &srf, size_t nu, size_t nv,
+                        size_t band_rows = 64)
+{
+    surfaceTessellateStream(srf, nu, nv, band_rows, MeshObjWriter<T>(os));
+}
+
+/**
+ * Tessellate a surface and write the mesh to a binary STL stream one band of
+ * rows at a time
+ * @param[in] os Binary output stream
+ * @param[in] srf Surface object
+ * @param[in] nu Number of samples along u.
+ * @param[in] nv Number of samples along v.
+ * @param[in] band_rows Number of rows of samples held in memory at once.
+ */
+template <typename T>
+void surfaceSaveMeshSTL(std::ostream &os, const Surface<T> &srf, size_t nu, size_t nv,
+                        size_t band_rows = 64)
+{
+    MeshStlWriter<T> writer(os, internal::gridTriangleCount(nu, nv));
+    surfaceTessellateStream(srf, nu, nv, band_rows, writer);
+}
+
+/**
+ * Tessellate a rational surface and write the mesh to a binary STL stream one
+ * band of rows at a time
+ * @param[in] os Binary output stream
+ * @param[in] srf RationalSurface object
+ * @param[in] nu Number of samples along u.
+ * @param[in] nv Number of samples along v.
+ * @param[in] band_rows Number of rows of samples held in memory at once.
+ */
+template <typename T>
+void surfaceSaveMeshSTL(std::ostream &os, const RationalSurface<T> &srf, size_t nu, size_t nv,
+                        size_t band_rows = 64)
+{
+    MeshStlWriter<T> writer(os, internal::gridTriangleCount(nu, nv));
+    surfaceTessellateStream(srf, nu, nv, band_rows, writer);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+/**
+ * Tessellate a surface and write the mesh to a Wavefront OBJ file
+ * @param[in] filename Name of the file
+ * @param[in] srf Surface object
+ * @param[in] nu Number of samples along u.
+ * @param[in] nv Number of samples along v.
+ * @param[in] band_rows Number of rows of samples held in memory at once.
+ */
+template <typename T>
+void surfaceSaveMeshOBJ(const std::string &filename, const Surface<T> &srf, size_t nu, size_t nv,
+                        size_t band_rows = 64)
+{
+    std::ofstream fout(filename);
+    surfaceSaveMeshOBJ(fout, srf, nu, nv, band_rows);
+}
+
+/**
+ * Tessellate a rational surface and write the mesh to a Wavefront OBJ file
+ * @param[in] filename Name of the file
+ * @param[in] srf RationalSurface object
+ * @param[in] nu Number of samples along u.
+ * @param[in] nv Number of samples along v.
+ * @param[in] band_rows Number of rows of samples held in memory at once.
+ */
+template <typename T>
+void surfaceSaveMeshOBJ(const std::string &filename, const RationalSurface<T> &srf, size_t nu,
+                        size_t nv, size_t band_rows = 64)
+{
+    std::ofstream fout(filename);
+    surfaceSaveMeshOBJ(fout, srf, nu, nv, band_rows);
+}
+
+/**
+ * Tessellate a surface and write the mesh to a binary STL file
+ * @param[in] filename Name of the file
+ * @param[in] srf Surface object
+ * @param[in] nu Number of samples along u.
+ * @param[in] nv Number of samples along v.
+ * @param[in] band_rows Number of rows of samples held in memory at once.
+ */
+template <typename T>
+void surfaceSaveMeshSTL(const std::string &filename, const Surface<T> &srf, size_t nu, size_t nv,
+                        size_t band_rows = 64)
+{
+    std::ofstream fout(filename, std::ios::binary);
+    surfaceSaveMeshSTL(fout, srf, nu, nv, band_rows);
+}
+
+/**
+ * Tessellate a rational surface and write the mesh to a binary STL file
+ * @param[in] filename Name of the file
+ * @param[in] srf RationalSurface object
+ * @param[in] nu Number of samples along u.
+ * @param[in] nv Number of samples along v.
+ * @param[in] band_rows Number of rows of samples held in memory at once.
+ */
+template <typename T>
+void surfaceSaveMeshSTL(const std::string &filename, const RationalSurface<T> &srf, size_t nu,
+                        size_t nv, size_t band_rows = 64)
+{
+    std::ofstream fout(filename, std::ios::binary);
+    surfaceSaveMeshSTL(fout, srf, nu, nv, band_rows);
+}
+
+} // namespace tinynurbs
+
+#endif // TINYNURBS_MESH_H
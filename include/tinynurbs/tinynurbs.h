@@ -6,9 +6,21 @@
  */
 
 #include "core/basis.h"
+#include "core/bvh.h"
 #include "core/check.h"
+#include "core/collocation.h"
+#include "core/compiled.h"
+#include "core/curvature.h"
 #include "core/curve.h"
 #include "core/evaluate.h"
+#include "core/family.h"
+#include "core/intersect.h"
+#include "core/knots.h"
 #include "core/modify.h"
+#include "core/project.h"
+#include "core/stepper.h"
 #include "core/surface.h"
+#include "core/tessellate.h"
+#include "core/workspace.h"
+#include "io/mesh.h"
 #include "io/obj.h"
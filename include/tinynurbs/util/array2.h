@@ -70,9 +70,11 @@ template <typename T> class array2
     size_t rows() const { return rows_; }
     size_t cols() const { return cols_; }
     size_t size() const { return data_.size(); }
+    T *data() { return data_.data(); }
+    const T *data() const { return data_.data(); }
 
   private:
-    size_t rows_, cols_;
+    size_t rows_ = 0, cols_ = 0;
     std::vector<T> data_;
 };
 
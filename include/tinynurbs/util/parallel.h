@@ -0,0 +1,96 @@
+/**
+ * Helpers for running independent work items on several threads
+ *
+ * Use of this source code is governed by a BSD-style license that can be found in
+ * the LICENSE file.
+ */
+
+#ifndef TINYNURBS_PARALLEL_H
+#define TINYNURBS_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace tinynurbs
+{
+namespace util
+{
+
+/**
+ * Number of threads to use for a requested count, where 0 selects one thread
+ * per hardware thread
+ * @param[in] num_threads Requested number of threads.
+ * @param[in] num_items Number of work items, no more threads than items are used.
+ * @return Number of threads, at least 1
+ */
+inline unsigned int threadCount(unsigned int num_threads, size_t num_items)
+{
+    if (num_threads == 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return static_cast<unsigned int>(
+        std::max<size_t>(1, std::min<size_t>(num_threads, num_items)));
+}
+
+/**
+ * Call a function for every index in [0, count), distributing chunks of
+ * consecutive indices over threads. The function must be safe to call
+ * concurrently for different indices.
+ * @param[in] count Number of indices.
+ * @param[in] num_threads Number of threads, 0 for one per hardware thread.
+ * @param[in] func Function called as func(index, thread), where thread is less
+ * than threadCount(num_threads, count) and identifies per-thread scratch data.
+ * @param[in] chunk Number of consecutive indices taken by a thread at once.
+ */
+template <typename Func>
+void parallelFor(size_t count, unsigned int num_threads, Func func, size_t chunk = 1)
+{
+    chunk = std::max<size_t>(chunk, 1);
+    unsigned int threads = threadCount(num_threads, (count + chunk - 1) / chunk);
+    if (threads <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            func(i, 0u);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto worker = [&](unsigned int thread) {
+        for (;;)
+        {
+            size_t begin = next.fetch_add(chunk);
+            if (begin >= count)
+            {
+                return;
+            }
+            size_t end = std::min(count, begin + chunk);
+            for (size_t i = begin; i < end; ++i)
+            {
+                func(i, thread);
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned int t = 1; t < threads; ++t)
+    {
+        pool.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread &thread : pool)
+    {
+        thread.join();
+    }
+}
+
+} // namespace util
+} // namespace tinynurbs
+
+#endif // TINYNURBS_PARALLEL_H
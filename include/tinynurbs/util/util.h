@@ -9,7 +9,10 @@
 #define TINYNURBS_UTIL
 
 #include "array2.h"
+#include <cstddef>
+#include <cstdint>
 #include <glm/glm.hpp>
+#include <new>
 #include <vector>
 
 namespace tinynurbs
@@ -161,6 +164,73 @@ inline unsigned int binomial(unsigned int n, unsigned int k)
     return result;
 }
 
+/**
+ * Allocator returning memory aligned to the given number of bytes, for
+ * containers that are processed with vector instructions
+ * @tparam T Type of the allocated elements
+ * @tparam Alignment Alignment in bytes, a power of two
+ */
+template <typename T, size_t Alignment> struct AlignedAllocator
+{
+    typedef T value_type;
+    template <typename U> struct rebind
+    {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator() = default;
+    template <typename U> AlignedAllocator(const AlignedAllocator<U, Alignment> &)
+    {
+    }
+
+    T *allocate(size_t n)
+    {
+        // Over-allocate and keep the original pointer right before the aligned block
+        void *raw = ::operator new(n * sizeof(T) + Alignment + sizeof(void *));
+        uintptr_t addr = reinterpret_cast<uintptr_t>(raw) + sizeof(void *);
+        addr = (addr + Alignment - 1) & ~static_cast<uintptr_t>(Alignment - 1);
+        reinterpret_cast<void **>(addr)[-1] = raw;
+        return reinterpret_cast<T *>(addr);
+    }
+
+    void deallocate(T *p, size_t)
+    {
+        ::operator delete(reinterpret_cast<void **>(p)[-1]);
+    }
+};
+
+template <typename T, typename U, size_t Alignment>
+inline bool operator==(const AlignedAllocator<T, Alignment> &,
+                       const AlignedAllocator<U, Alignment> &)
+{
+    return true;
+}
+
+template <typename T, typename U, size_t Alignment>
+inline bool operator!=(const AlignedAllocator<T, Alignment> &,
+                       const AlignedAllocator<U, Alignment> &)
+{
+    return false;
+}
+
+/**
+ * Compute a table of binomial coefficients using Pascal's triangle
+ * @param[in] max_n Largest n to compute coefficients for
+ * @param[out] bin Table where bin(n, k) = nCk for 0 <= k <= n <= max_n, and 0 for k > n
+ */
+template <typename T> inline void binomialTable(unsigned int max_n, array2<T> &bin)
+{
+    bin.resize(max_n + 1, max_n + 1);
+    for (unsigned int n = 0; n <= max_n; ++n)
+    {
+        bin(n, 0) = T(1);
+        for (unsigned int k = 1; k <= max_n; ++k)
+        {
+            bin(n, k) = (k > n) ? T(0) : bin(n - 1, k - 1) + bin(n - 1, k);
+        }
+    }
+}
+
 /**
  * Check if two numbers are close enough within eps
  * @param[in] a First number
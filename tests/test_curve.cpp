@@ -2,6 +2,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 #include <cmath>
+#include <limits>
 
 #include "catch.hpp"
 
@@ -18,6 +19,163 @@ tinynurbs::Curve3f getNonrationalBezierCurve() {
     return crv;
 }
 
+// Cubic curve with interior knots, one of them double
+template <typename T = double> tinynurbs::Curve<T> getCubicCurve() {
+    tinynurbs::Curve<T> crv;
+    crv.degree = 3;
+    crv.knots = {0, 0, 0, 0, T(0.2), T(0.5), T(0.5), T(0.8), 1, 1, 1, 1};
+    crv.control_points = {glm::vec<3, T>(0, 0, 0), glm::vec<3, T>(1, 2, 0),
+                          glm::vec<3, T>(2, -1, 1), glm::vec<3, T>(3, 0, 2),
+                          glm::vec<3, T>(4, 3, 0),  glm::vec<3, T>(5, 1, -1),
+                          glm::vec<3, T>(6, 0, 0),  glm::vec<3, T>(7, 2, 1)};
+    return crv;
+}
+
+// Whether a point lies in a box up to a tolerance
+template <typename V> bool inBox(const V &pt, const V &lo, const V &hi, double tol) {
+    return glm::distance(glm::max(lo, glm::min(pt, hi)), pt) <= tol;
+}
+
+// Textbook recursive definition of the ith basis function of degree p
+double referenceBasis(int i, int p, const std::vector<double> &U, double u) {
+    if (p == 0) {
+        return (U[i] <= u && u < U[i + 1]) ? 1.0 : 0.0;
+    }
+    double a = U[i + p] - U[i], b = U[i + p + 1] - U[i + 1];
+    double left = a > 0 ? (u - U[i]) / a * referenceBasis(i, p - 1, U, u) : 0.0;
+    double right = b > 0 ? (U[i + p + 1] - u) / b * referenceBasis(i + 1, p - 1, U, u) : 0.0;
+    return left + right;
+}
+
+// Derivative of the ith basis function of degree p
+double referenceDerBasis(int i, int p, const std::vector<double> &U, double u) {
+    double a = U[i + p] - U[i], b = U[i + p + 1] - U[i + 1];
+    double left = a > 0 ? p / a * referenceBasis(i, p - 1, U, u) : 0.0;
+    double right = b > 0 ? p / b * referenceBasis(i + 1, p - 1, U, u) : 0.0;
+    return left - right;
+}
+
+TEST_CASE("bsplineBasis and bsplineDerBasis", "[basis]")
+{
+    // Covers the degrees with unrolled kernels as well as the generic path
+    for (unsigned int deg = 1; deg <= 7; ++deg) {
+        std::vector<double> knots(deg + 1, 0.0);
+        for (double k : {0.1, 0.25, 0.25, 0.6, 0.7}) {
+            knots.push_back(k);
+        }
+        knots.insert(knots.end(), deg + 1, 1.0);
+        for (double u : {0.0, 0.05, 0.25, 0.3, 0.65, 0.99}) {
+            int span = tinynurbs::findSpan(deg, knots, u);
+            std::vector<double> N = tinynurbs::bsplineBasis(deg, span, knots, u);
+            tinynurbs::array2<double> ders = tinynurbs::bsplineDerBasis(deg, span, knots, u, 1);
+            REQUIRE(N.size() == deg + 1);
+            double sum = 0.0;
+            for (unsigned int j = 0; j <= deg; ++j) {
+                int i = span - deg + j;
+                REQUIRE(N[j] == Approx(referenceBasis(i, deg, knots, u)).margin(1e-12));
+                REQUIRE(ders(0, j) == Approx(N[j]).margin(1e-12));
+                REQUIRE(ders(1, j) == Approx(referenceDerBasis(i, deg, knots, u)).margin(1e-9));
+                sum += N[j];
+            }
+            REQUIRE(sum == Approx(1.0));
+        }
+    }
+}
+
+template <unsigned int Lanes, typename T>
+void checkBasisLanes(unsigned int deg) {
+    std::vector<T> knots(deg + 1, T(0));
+    for (T k : {T(0.1), T(0.25), T(0.25), T(0.6), T(0.7)}) {
+        knots.push_back(k);
+    }
+    knots.insert(knots.end(), deg + 1, T(1));
+    // Each lane falls in a different span
+    T u[Lanes];
+    int spans[Lanes];
+    for (unsigned int l = 0; l < Lanes; ++l) {
+        u[l] = T(0.97) * (Lanes - l) / Lanes;
+        spans[l] = tinynurbs::findSpan(deg, knots, u[l]);
+    }
+    std::vector<T> N((deg + 1) * Lanes);
+    tinynurbs::bsplineBasisLanes<Lanes>(deg, spans, knots, u, N.data());
+    for (unsigned int l = 0; l < Lanes; ++l) {
+        std::vector<T> ref = tinynurbs::bsplineBasis(deg, spans[l], knots, u[l]);
+        for (unsigned int j = 0; j <= deg; ++j) {
+            REQUIRE(N[j * Lanes + l] == Approx(ref[j]).margin(1e-6));
+        }
+    }
+}
+
+TEST_CASE("bsplineBasisLanes", "[basis]")
+{
+    for (unsigned int deg = 1; deg <= 6; ++deg) {
+        checkBasisLanes<tinynurbs::simdLanes<float>(), float>(deg);
+        checkBasisLanes<tinynurbs::simdLanes<double>(), double>(deg);
+        checkBasisLanes<16, float>(deg);
+    }
+}
+
+template <typename T>
+void checkSpanLocator(const std::vector<T> &knots, unsigned int deg,
+                      typename tinynurbs::SpanLocator<T>::Strategy strategy) {
+    tinynurbs::SpanLocator<T> locator(deg, knots);
+    REQUIRE(locator.strategy == strategy);
+    T lo = knots[deg], hi = knots[knots.size() - deg - 1];
+    for (int i = -10; i <= 1010; ++i) {
+        T u = lo + (hi - lo) * i / 1000;
+        REQUIRE(tinynurbs::findSpan(locator, u) == tinynurbs::findSpan(deg, knots, u));
+    }
+    for (T u : knots) {
+        REQUIRE(tinynurbs::findSpan(locator, u) == tinynurbs::findSpan(deg, knots, u));
+    }
+}
+
+TEST_CASE("SpanLocator", "[basis]")
+{
+    typedef tinynurbs::SpanLocator<double>::Strategy Strategy;
+    std::vector<double> uniform = {0, 0, 0};
+    for (int i = 1; i < 50; ++i) {
+        uniform.push_back(0.1 * i);
+    }
+    uniform.insert(uniform.end(), 3, 5.0);
+    checkSpanLocator(uniform, 2, Strategy::Uniform);
+
+    // Slightly perturbed knots and a double knot keep the buckets small
+    std::vector<double> near_uniform = {0, 0, 0, 0};
+    for (int i = 1; i < 40; ++i) {
+        near_uniform.push_back(i + 0.2 * std::sin(double(i)));
+    }
+    near_uniform.push_back(near_uniform.back());
+    near_uniform.insert(near_uniform.end(), 4, 40.0);
+    checkSpanLocator(near_uniform, 3, Strategy::Buckets);
+
+    // Knots clustered near the start overload the first buckets
+    std::vector<double> clustered = {0, 0};
+    for (int i = 1; i < 30; ++i) {
+        clustered.push_back(std::pow(2.0, i - 30.0));
+    }
+    clustered.insert(clustered.end(), 2, 1.0);
+    checkSpanLocator(clustered, 1, Strategy::Search);
+
+    std::vector<float> uniform_f(uniform.begin(), uniform.end());
+    checkSpanLocator(uniform_f, 2, tinynurbs::SpanLocator<float>::Strategy::Uniform);
+
+    // Evaluation through a workspace that uses the locator
+    tinynurbs::Curve3d crv;
+    crv.degree = 3;
+    crv.knots = near_uniform;
+    for (size_t i = 0; i + 4 < near_uniform.size(); ++i) {
+        crv.control_points.push_back(glm::dvec3(i, std::cos(double(i)), 0));
+    }
+    tinynurbs::SpanLocator<double> locator(crv.degree, crv.knots);
+    tinynurbs::EvalWorkspace<double> ws;
+    ws.locator_u = &locator;
+    for (double u : {39.5, 0.3, 17.2, 40.0, 3.9}) {
+        glm::dvec3 pt = tinynurbs::curvePoint(crv, u, ws);
+        REQUIRE(glm::distance(pt, tinynurbs::curvePoint(crv, u)) == Approx(0).margin(1e-12));
+    }
+}
+
 TEST_CASE("curvePoint (non-rational)", "[curve, non-rational, evaluate]")
 {
     auto crv = getNonrationalBezierCurve();
@@ -37,6 +195,359 @@ TEST_CASE("curveTangent (glm::vec2)", "[curve, non-rational, evaluate]")
     REQUIRE(tgt1.y == Approx(0));
 }
 
+TEST_CASE("curvePoints and curveDerivativesBatch (non-rational)", "[curve, non-rational, evaluate]")
+{
+    auto crv = getCubicCurve<float>();
+
+    // Sorted parameters, including repeated values and both ends of the domain
+    std::vector<float> params = {0.f, 0.1f, 0.2f, 0.2f, 0.35f, 0.5f, 0.7f, 0.9f, 1.f};
+    // Unsorted parameters fall back to a search
+    std::vector<float> shuffled = {0.7f, 0.1f, 1.f, 0.5f, 0.f, 0.9f};
+
+    for (const auto &us : {params, shuffled}) {
+        std::vector<glm::vec3> pts;
+        tinynurbs::curvePoints(crv, us, pts);
+        tinynurbs::array2<glm::vec3> ders;
+        tinynurbs::curveDerivativesBatch(crv, 2, us, ders);
+        REQUIRE(pts.size() == us.size());
+        REQUIRE(ders.rows() == us.size());
+        REQUIRE(ders.cols() == 3);
+        for (size_t i = 0; i < us.size(); ++i) {
+            glm::vec3 pt = tinynurbs::curvePoint(crv, us[i]);
+            REQUIRE(pts[i].x == Approx(pt.x));
+            REQUIRE(pts[i].y == Approx(pt.y));
+            REQUIRE(pts[i].z == Approx(pt.z));
+            auto ref = tinynurbs::curveDerivatives(crv, 2, us[i]);
+            for (int k = 0; k <= 2; ++k) {
+                REQUIRE(ders(i, k).x == Approx(ref[k].x));
+                REQUIRE(ders(i, k).y == Approx(ref[k].y));
+                REQUIRE(ders(i, k).z == Approx(ref[k].z));
+            }
+        }
+    }
+}
+
+TEST_CASE("CompiledCurve (non-rational)", "[curve, non-rational, evaluate]")
+{
+    auto crv = getCubicCurve();
+    tinynurbs::CompiledCurve3d ccrv(crv);
+    // The double knot at 0.5 leaves four non-empty spans
+    REQUIRE(ccrv.breaks.size() == 5);
+    REQUIRE(ccrv.wcoeffs.empty());
+    REQUIRE(tinynurbs::curveCompiledError(ccrv, crv) < 1e-12);
+
+    for (double u : {0.0, 0.15, 0.2, 0.5, 0.65, 0.99}) {
+        auto ref = tinynurbs::curveDerivatives(crv, 4, u);
+        auto ders = tinynurbs::curveDerivatives(ccrv, 4, u);
+        for (int k = 0; k <= 4; ++k) {
+            REQUIRE(glm::distance(ders[k], ref[k]) == Approx(0).margin(1e-9));
+        }
+    }
+}
+
+TEST_CASE("CurveFamily (non-rational)", "[curve, non-rational, evaluate]")
+{
+    std::vector<tinynurbs::Curve3d> curves(5);
+    for (size_t c = 0; c < curves.size(); ++c) {
+        curves[c].degree = 3;
+        curves[c].knots = {0, 0, 0, 0, 0.2, 0.5, 0.5, 0.8, 1, 1, 1, 1};
+        for (int i = 0; i < 8; ++i) {
+            curves[c].control_points.push_back(
+                glm::dvec3(i, std::sin(i + 0.7 * c), std::cos(0.3 * i * c)));
+        }
+    }
+    tinynurbs::CurveFamily3d family(curves);
+    REQUIRE(family.size() == 5);
+    REQUIRE_FALSE(family.rational);
+
+    std::vector<double> params = {0.0, 0.15, 0.2, 0.5, 0.65, 1.0};
+    tinynurbs::EvalWorkspace<double> ws;
+    tinynurbs::array2<glm::dvec3> points, ders;
+    tinynurbs::curveFamilyPoints(family, params, points, ws);
+    for (size_t i = 0; i < params.size(); ++i) {
+        auto row = tinynurbs::curveFamilyPoints(family, params[i]);
+        tinynurbs::curveFamilyDerivatives(family, 4, params[i], ders, ws);
+        for (size_t c = 0; c < curves.size(); ++c) {
+            auto ref = tinynurbs::curveDerivatives(curves[c], 4, params[i]);
+            REQUIRE(glm::distance(points(i, c), ref[0]) == Approx(0).margin(1e-12));
+            REQUIRE(glm::distance(row[c], ref[0]) == Approx(0).margin(1e-12));
+            for (int k = 0; k <= 4; ++k) {
+                REQUIRE(glm::distance(ders(c, k), ref[k]) == Approx(0).margin(1e-9));
+            }
+        }
+    }
+
+    // Curves with other knots cannot join the family
+    tinynurbs::Curve3d other = curves[0];
+    other.knots[4] = 0.3;
+    REQUIRE_THROWS(family.setCurve(0, other));
+
+    // Weights would be dropped by a non-rational family
+    tinynurbs::RationalCurve3d weighted(curves[0]);
+    REQUIRE_THROWS(family.setCurve(0, weighted));
+}
+
+TEST_CASE("curveCollocationMatrix (non-rational)", "[curve, non-rational, evaluate]")
+{
+    auto crv = getCubicCurve();
+    std::vector<double> params = {0.0, 0.15, 0.2, 0.5, 0.65, 1.0};
+    tinynurbs::CsrMatrix<double> mat;
+    tinynurbs::curveCollocationMatrix(crv, params, mat, 4);
+    REQUIRE(mat.rows == params.size() * 5);
+    REQUIRE(mat.cols == crv.control_points.size());
+    // The fourth derivative of a cubic is zero and its rows are empty
+    REQUIRE(mat.nonZeros() == params.size() * 4 * 4);
+
+    std::vector<glm::dvec3> samples;
+    tinynurbs::csrMultiply(mat, crv.control_points, samples);
+    for (size_t i = 0; i < params.size(); ++i) {
+        auto ref = tinynurbs::curveDerivatives(crv, 4, params[i]);
+        for (int k = 0; k <= 4; ++k) {
+            REQUIRE(glm::distance(samples[i * 5 + k], ref[k]) == Approx(0).margin(1e-9));
+        }
+    }
+
+    // Moving the control points only needs another multiply
+    for (auto &pt : crv.control_points) {
+        pt = glm::dvec3(pt.y, 2 * pt.x, pt.z - 1);
+    }
+    tinynurbs::csrMultiply(mat, crv.control_points, samples);
+    for (size_t i = 0; i < params.size(); ++i) {
+        glm::dvec3 ref = tinynurbs::curvePoint(crv, params[i]);
+        REQUIRE(glm::distance(samples[i * 5], ref) == Approx(0).margin(1e-12));
+    }
+}
+
+// Distance from a point to the segment between a and b
+double segmentDistance(const glm::dvec3 &pt, const glm::dvec3 &a, const glm::dvec3 &b) {
+    glm::dvec3 ab = b - a;
+    double len2 = glm::dot(ab, ab);
+    double t = len2 > 0 ? glm::clamp(glm::dot(pt - a, ab) / len2, 0.0, 1.0) : 0.0;
+    return glm::distance(pt, a + t * ab);
+}
+
+TEST_CASE("curveTessellate (non-rational)", "[curve, non-rational, tessellate]")
+{
+    auto crv = getCubicCurve();
+
+    for (double tol : {1e-1, 1e-3}) {
+        std::vector<glm::dvec3> points;
+        std::vector<double> params;
+        tinynurbs::curveTessellate(crv, tol, points, params);
+        REQUIRE(points.size() == params.size());
+        REQUIRE(params.front() == 0);
+        REQUIRE(params.back() == 1);
+        for (size_t k = 0; k + 1 < points.size(); ++k) {
+            REQUIRE(params[k] < params[k + 1]);
+            REQUIRE(glm::distance(points[k], tinynurbs::curvePoint(crv, params[k])) ==
+                    Approx(0).margin(1e-12));
+            for (int s = 1; s < 16; ++s) {
+                double u = params[k] + (params[k + 1] - params[k]) * s / 16;
+                glm::dvec3 pt = tinynurbs::curvePoint(crv, u);
+                REQUIRE(segmentDistance(pt, points[k], points[k + 1]) <= tol);
+            }
+        }
+    }
+
+    // Straight segments need no subdivision
+    tinynurbs::Curve3d line = crv;
+    for (size_t i = 0; i < line.control_points.size(); ++i) {
+        line.control_points[i] = glm::dvec3(i * i, 2.0 * i * i, 0);
+    }
+    auto points = tinynurbs::curveTessellate(line, 1e-6);
+    REQUIRE(points.size() == 5);
+}
+
+TEST_CASE("curveClosestPoint (non-rational)", "[curve, non-rational, project]")
+{
+    auto crv = getCubicCurve();
+
+    // Dense samples give an upper bound of the distance to the curve
+    std::vector<double> samples(20001);
+    std::vector<glm::dvec3> sample_points;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = double(i) / (samples.size() - 1);
+    }
+    tinynurbs::curvePoints(crv, samples, sample_points);
+
+    std::vector<glm::dvec3> points;
+    for (int i = 0; i < 200; ++i) {
+        double t = i / 199.0;
+        points.push_back(glm::dvec3(8 * t - 0.5, 3 * std::sin(17 * t), 2 * std::cos(11 * t)));
+    }
+    std::vector<double> params;
+    tinynurbs::curveClosestPoints(crv, points, params);
+    REQUIRE(params.size() == points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        double u = tinynurbs::curveClosestPoint(crv, points[i]);
+        double dist = glm::distance(tinynurbs::curvePoint(crv, u), points[i]);
+        double sampled = std::numeric_limits<double>::infinity();
+        for (const auto &pt : sample_points) {
+            sampled = std::min(sampled, glm::distance(pt, points[i]));
+        }
+        REQUIRE(u >= 0);
+        REQUIRE(u <= 1);
+        REQUIRE(dist <= sampled + 1e-12);
+        REQUIRE(glm::distance(tinynurbs::curvePoint(crv, params[i]), points[i]) ==
+                Approx(dist).margin(1e-9));
+
+        // Interior minima are orthogonal to the tangent
+        if (u > 0 && u < 1 && u != 0.5) {
+            auto ders = tinynurbs::curveDerivatives(crv, 1, u);
+            REQUIRE(glm::dot(ders[1], ders[0] - points[i]) ==
+                    Approx(0).margin(1e-6 * glm::length(ders[1]) * (dist + 1)));
+        }
+    }
+
+    // Points on the curve project to themselves, and points beyond the ends
+    // clamp to the ends
+    for (double u : {0.0, 0.13, 0.5, 0.77, 1.0}) {
+        REQUIRE(tinynurbs::curveClosestPoint(crv, tinynurbs::curvePoint(crv, u)) ==
+                Approx(u).margin(1e-9));
+    }
+    REQUIRE(tinynurbs::curveClosestPoint(crv, glm::dvec3(-5, -5, 0)) == 0);
+    REQUIRE(tinynurbs::curveClosestPoint(crv, glm::dvec3(12, 4, 2)) == 1);
+
+    // A span ending at a corner is refined with its own derivatives
+    tinynurbs::Curve3d polyline(1, {0, 0, 0.5, 1, 1},
+                                {glm::dvec3(0, 0, 0), glm::dvec3(2, 0, 0), glm::dvec3(2, 2, 0)});
+    double u = tinynurbs::curveClosestPoint(polyline, glm::dvec3(1.6, 0.3, 0));
+    REQUIRE(u == Approx(0.4));
+    REQUIRE(glm::distance(tinynurbs::curvePoint(polyline, u), glm::dvec3(1.6, 0.3, 0)) ==
+            Approx(0.3));
+}
+
+TEST_CASE("curveBvh (non-rational)", "[curve, non-rational, bvh]")
+{
+    auto crv = getCubicCurve();
+
+    auto check = [&](const tinynurbs::Bvh3d &bvh) {
+        REQUIRE(bvh.nodes.size() == 2 * bvh.leaves.size() - 1);
+        for (size_t k = 0; k < bvh.leaves.size(); ++k) {
+            const auto &leaf = bvh.leaves[k];
+            REQUIRE(leaf.lo.x < leaf.hi.x);
+            for (int i = 0; i <= 20; ++i) {
+                double u = leaf.lo.x + (leaf.hi.x - leaf.lo.x) * i / 20;
+                glm::dvec3 pt = tinynurbs::curvePoint(crv, u);
+                REQUIRE(inBox(pt, leaf.box_min, leaf.box_max, 1e-12));
+                REQUIRE(inBox(pt, bvh.nodes[0].box_min, bvh.nodes[0].box_max, 1e-12));
+                if (!bvh.oriented_boxes.empty()) {
+                    const auto &box = bvh.oriented_boxes[k];
+                    for (int a = 0; a < 3; ++a) {
+                        REQUIRE(std::abs(glm::dot(pt - box.center, box.axes[a])) <=
+                                box.half_extents[a] + 1e-12);
+                    }
+                }
+            }
+        }
+    };
+
+    // Four non-empty spans, the double knot at 0.5 has none
+    auto bvh = tinynurbs::curveBvh(crv);
+    REQUIRE(bvh.leaves.size() == 4);
+    check(bvh);
+    auto fine = tinynurbs::curveBvh(crv, 5, true);
+    REQUIRE(fine.leaves.size() == 20);
+    check(fine);
+
+    crv.control_points[3] = glm::dvec3(3, 5, -2);
+    tinynurbs::curveBvhRefit(crv, fine);
+    check(fine);
+    REQUIRE(fine.nodes[0].box_max.y > 3);
+}
+
+TEST_CASE("curveCurvatures and curve frames (non-rational)", "[curve, non-rational, evaluate]")
+{
+    // Planar S-curve with an inflection, and a non-planar curve
+    tinynurbs::Curve3d crv;
+    crv.degree = 3;
+    crv.knots = {0, 0, 0, 0, 0.5, 1, 1, 1, 1};
+    crv.control_points = {glm::dvec3(0, 0, 0), glm::dvec3(1, 2, 0), glm::dvec3(2, 2, 0),
+                          glm::dvec3(3, -2, 0), glm::dvec3(4, 0, 0)};
+    tinynurbs::Curve3d crv3 = crv;
+    crv3.control_points[2].z = 1.5;
+    crv3.control_points[3].z = -1;
+
+    std::vector<double> us;
+    for (int i = 0; i <= 200; ++i) {
+        us.push_back(i / 200.0);
+    }
+
+    std::vector<double> kappa, tau;
+    std::vector<glm::dvec3> ts, ns, bs;
+    tinynurbs::EvalWorkspace<double> ws;
+    tinynurbs::curveCurvatures(crv3, us, kappa, ws);
+    tinynurbs::curveTorsions(crv3, us, tau, ws);
+    tinynurbs::curveFrenetFrames(crv3, us, ts, ns, bs, ws);
+    REQUIRE(kappa.size() == us.size());
+    for (size_t i = 0; i < us.size(); ++i) {
+        auto ders = tinynurbs::curveDerivatives(crv3, 3, us[i]);
+        glm::dvec3 b = glm::cross(ders[1], ders[2]);
+        double speed = glm::length(ders[1]);
+        REQUIRE(kappa[i] == Approx(glm::length(b) / (speed * speed * speed)));
+        REQUIRE(tau[i] == Approx(glm::dot(b, ders[3]) / glm::dot(b, b)));
+        REQUIRE(glm::distance(ts[i], glm::normalize(ders[1])) == Approx(0).margin(1e-12));
+        REQUIRE(glm::distance(bs[i], glm::normalize(b)) == Approx(0).margin(1e-12));
+        REQUIRE(glm::dot(ns[i], ts[i]) == Approx(0).margin(1e-12));
+        REQUIRE(glm::length(ns[i]) == Approx(1));
+    }
+
+    // The Frenet binormal of the planar curve flips at the inflection, while
+    // the rotation minimizing frame keeps it
+    tinynurbs::curveFrenetFrames(crv, us, ts, ns, bs);
+    REQUIRE(glm::dot(bs.front(), bs.back()) == Approx(-1));
+    tinynurbs::curveRotationMinimizingFrames(crv, us, ts, ns, bs, ws);
+    for (size_t i = 0; i < us.size(); ++i) {
+        REQUIRE(glm::distance(bs[i], bs[0]) == Approx(0).margin(1e-9));
+        REQUIRE(glm::dot(ns[i], ts[i]) == Approx(0).margin(1e-9));
+        REQUIRE(glm::length(ns[i]) == Approx(1));
+    }
+
+    // Rotation minimizing frames of the non-planar curve stay orthonormal and
+    // converge as the sampling is refined
+    std::vector<double> fine_us;
+    for (int i = 0; i <= 2000; ++i) {
+        fine_us.push_back(i / 2000.0);
+    }
+    std::vector<glm::dvec3> fine_ts, fine_ns, fine_bs;
+    tinynurbs::curveRotationMinimizingFrames(crv3, us, ts, ns, bs);
+    tinynurbs::curveRotationMinimizingFrames(crv3, fine_us, fine_ts, fine_ns, fine_bs);
+    for (size_t i = 0; i < us.size(); ++i) {
+        REQUIRE(glm::dot(ns[i], ts[i]) == Approx(0).margin(1e-9));
+        REQUIRE(glm::dot(bs[i], ns[i]) == Approx(0).margin(1e-9));
+        REQUIRE(glm::length(bs[i]) == Approx(1));
+        REQUIRE(glm::distance(ns[i], fine_ns[10 * i]) == Approx(0).margin(1e-6));
+    }
+}
+
+TEST_CASE("CurveStepper (non-rational)", "[curve, non-rational, evaluate]")
+{
+    tinynurbs::Curve3f crv;
+    crv.degree = 3;
+    crv.knots = {0, 0, 0, 0, 0.2f, 0.5f, 0.5f, 0.9f, 1, 1, 1, 1};
+    for (int i = 0; i < 8; ++i) {
+        crv.control_points.push_back(glm::vec3(i, std::sin(float(i)), std::cos(2.f * i)));
+    }
+
+    // Many steps per segment, across a double knot and past the end of the domain
+    const size_t count = 20001;
+    const float step = 1.f / 20000;
+    std::vector<glm::vec3> pts;
+    tinynurbs::curveStepPoints(crv, 0.f, step, count, pts);
+    REQUIRE(pts.size() == count);
+    for (size_t k = 0; k < count; ++k) {
+        glm::vec3 ref = tinynurbs::curvePoint(crv, k * step);
+        REQUIRE(glm::distance(pts[k], ref) == Approx(0).margin(1e-5 * 8));
+    }
+
+    tinynurbs::CurveStepper3f stepper(crv, 0.05f, 0.013f, 16);
+    for (int k = 0; k < 60; ++k, stepper.advance()) {
+        REQUIRE(stepper.param() == Approx(0.05f + k * 0.013f));
+        glm::vec3 ref = tinynurbs::curvePoint(crv, stepper.param());
+        REQUIRE(glm::distance(stepper.point(), ref) == Approx(0).margin(1e-5 * 8));
+    }
+}
+
 TEST_CASE("curveIsValid (non-rational)", "[curve, non-rational, check]")
 {
     auto crv = getNonrationalBezierCurve();
@@ -74,6 +585,70 @@ TEST_CASE("curveKnotMultiplicity (non-rational)", "[knots, check]")
     }
 }
 
+TEST_CASE("KnotVector", "[knots, check]")
+{
+    std::vector<double> knots = {0, 0, 0, 0.5, 1, 1, 1.5, 2, 2, 2};
+    tinynurbs::KnotVector<double> kv(2, knots);
+    REQUIRE(kv.breakpoints == std::vector<double>({0, 0.5, 1, 1.5, 2}));
+    REQUIRE(kv.multiplicities == std::vector<unsigned int>({3, 1, 2, 1, 3}));
+    REQUIRE(kv.lo == 0);
+    REQUIRE(kv.hi == 2);
+    REQUIRE(kv.monotonic);
+    REQUIRE(kv.clamped);
+    REQUIRE(!kv.uniform);
+    REQUIRE(tinynurbs::internal::isKnotVectorMonotonic(kv));
+    REQUIRE(tinynurbs::internal::isKnotVectorClosed(2, kv) ==
+            tinynurbs::internal::isKnotVectorClosed(2, knots));
+    const std::vector<double> &back = kv;
+    REQUIRE(back == knots);
+
+    for (int i = -10; i <= 210; ++i) {
+        double u = i / 100.0;
+        REQUIRE(tinynurbs::findSpan(kv, u) == tinynurbs::findSpan(2u, knots, u));
+        REQUIRE(tinynurbs::knotMultiplicity(kv, u) == tinynurbs::knotMultiplicity(knots, u));
+    }
+
+    // Uniform knots are located arithmetically
+    std::vector<float> uniform = {0, 0, 0, 0};
+    for (int i = 1; i < 30; ++i) {
+        uniform.push_back(0.1f * i);
+    }
+    uniform.insert(uniform.end(), 4, 3.f);
+    tinynurbs::KnotVector<float> kv_f(3, uniform);
+    REQUIRE(kv_f.uniform);
+    REQUIRE(kv_f.clamped);
+    for (int i = 0; i <= 300; ++i) {
+        float u = i / 100.f;
+        REQUIRE(tinynurbs::findSpan(kv_f, u) == tinynurbs::findSpan(3u, uniform, u));
+    }
+
+    // Copies locate spans in their own knots
+    tinynurbs::KnotVector<double> copy = kv;
+    REQUIRE(copy.locator.knots == copy.knots.data());
+    REQUIRE(tinynurbs::findSpan(copy, 1.25) == tinynurbs::findSpan(2u, knots, 1.25));
+
+    // Knot insertion through the cached knot vector
+    tinynurbs::Curve3d crv;
+    crv.degree = 2;
+    crv.knots = knots;
+    for (int i = 0; i < 7; ++i) {
+        crv.control_points.push_back(glm::dvec3(i, i % 2, 0));
+    }
+    tinynurbs::Curve3d ins = crv;
+    tinynurbs::internal::curveKnotInsert(kv, crv.control_points, 1.25, 2, ins.knots,
+                                         ins.control_points);
+    REQUIRE(ins.knots == std::vector<double>({0, 0, 0, 0.5, 1, 1, 1.25, 1.25, 1.5, 2, 2, 2}));
+    REQUIRE(ins.control_points.size() == 9);
+    for (int i = 0; i <= 20; ++i) {
+        double u = i / 10.0;
+        glm::dvec3 pt = tinynurbs::curvePoint(crv, u);
+        glm::dvec3 new_pt = tinynurbs::curvePoint(ins, u);
+        REQUIRE(new_pt.x == Approx(pt.x));
+        REQUIRE(new_pt.y == Approx(pt.y));
+        REQUIRE(new_pt.z == Approx(pt.z));
+    }
+}
+
 TEST_CASE("curveInsertKnot (non-rational)", "[curve, non-rational, modify]")
 {
     auto crv = getNonrationalBezierCurve();
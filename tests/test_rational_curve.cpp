@@ -45,6 +45,10 @@ TEST_CASE("curvePoint (rational)", "[curve, rational, evaluate]")
     REQUIRE(pt2.x == Approx(-1));
     REQUIRE(pt2.y == Approx(0));
     REQUIRE(pt2.z == Approx(0));
+    // Last knot of the domain
+    glm::vec3 pt3 = curvePoint(crv, glm::two_pi<float>());
+    REQUIRE(pt3.x == Approx(1));
+    REQUIRE(pt3.y == Approx(0).margin(1e-6));
 }
 
 TEST_CASE("curveTangent (rational)", "[curve, rational, evaluate]")
@@ -60,6 +64,226 @@ TEST_CASE("curveTangent (rational)", "[curve, rational, evaluate]")
     REQUIRE(tgt2.z == Approx(0));
 }
 
+TEST_CASE("curvePoint and curveDerivatives (homogenous)", "[curve, rational, evaluate]")
+{
+    auto crv = getCircle();
+    tinynurbs::HomogenousCurve3f hcrv(crv);
+    for (float u : {0.f, 0.3f, 2.f, 4.5f, 6.f}) {
+        glm::vec3 pt = tinynurbs::curvePoint(crv, u);
+        glm::vec3 hpt = tinynurbs::curvePoint(hcrv, u);
+        REQUIRE(glm::length(hpt) == Approx(1));
+        REQUIRE(hpt.x == Approx(pt.x));
+        REQUIRE(hpt.y == Approx(pt.y));
+        auto ders = tinynurbs::curveDerivatives(crv, 2, u);
+        auto hders = tinynurbs::curveDerivatives(hcrv, 2, u);
+        for (int k = 0; k <= 2; ++k) {
+            REQUIRE(hders[k].x == Approx(ders[k].x).margin(1e-5));
+            REQUIRE(hders[k].y == Approx(ders[k].y).margin(1e-5));
+        }
+    }
+}
+
+TEST_CASE("curvePoints and curveDerivativesBatch (rational)", "[curve, rational, evaluate]")
+{
+    auto crv = getCircle();
+    std::vector<float> params;
+    for (int i = 0; i < 50; ++i) {
+        params.push_back(6.f * i / 49.f);
+    }
+    std::vector<glm::vec3> pts;
+    tinynurbs::curvePoints(crv, params, pts);
+    tinynurbs::array2<glm::vec3> ders;
+    tinynurbs::curveDerivativesBatch(crv, 1, params, ders);
+    REQUIRE(pts.size() == params.size());
+    for (size_t i = 0; i < params.size(); ++i) {
+        REQUIRE(glm::length(pts[i]) == Approx(1));
+        glm::vec3 pt = tinynurbs::curvePoint(crv, params[i]);
+        REQUIRE(pts[i].x == Approx(pt.x).margin(1e-6));
+        REQUIRE(pts[i].y == Approx(pt.y).margin(1e-6));
+        auto ref = tinynurbs::curveDerivatives(crv, 1, params[i]);
+        REQUIRE(ders(i, 1).x == Approx(ref[1].x).margin(1e-5));
+        REQUIRE(ders(i, 1).y == Approx(ref[1].y).margin(1e-5));
+        // Tangent of a circle is orthogonal to the radius
+        REQUIRE(glm::dot(ders(i, 0), ders(i, 1)) == Approx(0).margin(1e-5));
+    }
+}
+
+TEST_CASE("curveDerivatives with workspace (rational)", "[curve, rational, evaluate]")
+{
+    auto crv = getCircle();
+    tinynurbs::EvalWorkspace<float> ws;
+    std::vector<glm::vec3> ders;
+    // Parameters run backwards across spans so that the span hint is invalidated
+    for (float u : {6.f, 4.5f, 3.f, 2.f, 1.f, 0.3f, 0.f}) {
+        tinynurbs::curveDerivatives(crv, 2, u, ders, ws);
+        auto ref = tinynurbs::curveDerivatives(crv, 2, u);
+        glm::vec3 pt = tinynurbs::curvePoint(crv, u, ws);
+        REQUIRE(glm::length(pt) == Approx(1));
+        REQUIRE(ders.size() == 3);
+        for (int k = 0; k <= 2; ++k) {
+            REQUIRE(ders[k].x == Approx(ref[k].x).margin(1e-5));
+            REQUIRE(ders[k].y == Approx(ref[k].y).margin(1e-5));
+        }
+        // Curvature of the unit circle is one
+        REQUIRE(glm::length(glm::cross(ders[1], ders[2])) / std::pow(glm::length(ders[1]), 3) ==
+                Approx(1).margin(1e-4));
+    }
+}
+
+TEST_CASE("CompiledCurve (rational)", "[curve, rational, evaluate]")
+{
+    auto crv = getCircle();
+    tinynurbs::CompiledCurve3f ccrv(crv);
+    REQUIRE(ccrv.breaks.size() == 5);
+    REQUIRE(tinynurbs::curveCompiledError(ccrv, crv) < 1e-5f);
+    for (float u : {0.f, 0.3f, 2.f, 4.5f, 6.f}) {
+        REQUIRE(glm::length(tinynurbs::curvePoint(ccrv, u)) == Approx(1));
+        auto ref = tinynurbs::curveDerivatives(crv, 2, u);
+        auto ders = tinynurbs::curveDerivatives(ccrv, 2, u);
+        for (int k = 0; k <= 2; ++k) {
+            REQUIRE(ders[k].x == Approx(ref[k].x).margin(1e-4));
+            REQUIRE(ders[k].y == Approx(ref[k].y).margin(1e-4));
+        }
+    }
+}
+
+TEST_CASE("CurveFamily (rational)", "[curve, rational, evaluate]")
+{
+    // Circles of different radii and centers, and one with perturbed weights
+    std::vector<tinynurbs::RationalCurve3f> curves(4, getCircle());
+    for (size_t c = 0; c < curves.size(); ++c) {
+        for (auto &pt : curves[c].control_points) {
+            pt = pt * float(c + 1) + glm::vec3(c, -1, 0.5f * c);
+        }
+    }
+    curves[3].weights[3] = 2.f;
+    tinynurbs::CurveFamily3f family(curves);
+    REQUIRE(family.rational);
+
+    tinynurbs::EvalWorkspace<float> ws;
+    std::vector<glm::vec3> points;
+    tinynurbs::array2<glm::vec3> ders;
+    for (float u : {0.f, 0.3f, 2.f, 4.5f, 6.f}) {
+        tinynurbs::curveFamilyPoints(family, u, points, ws);
+        tinynurbs::curveFamilyDerivatives(family, 2, u, ders, ws);
+        for (size_t c = 0; c < curves.size(); ++c) {
+            auto ref = tinynurbs::curveDerivatives(curves[c], 2, u);
+            REQUIRE(glm::distance(points[c], ref[0]) == Approx(0).margin(1e-5));
+            for (int k = 0; k <= 2; ++k) {
+                REQUIRE(glm::distance(ders(c, k), ref[k]) == Approx(0).margin(1e-4));
+            }
+        }
+        REQUIRE(glm::distance(points[0], glm::vec3(0, -1, 0)) == Approx(1));
+    }
+}
+
+TEST_CASE("curveTessellate (rational)", "[curve, rational, tessellate]")
+{
+    auto crv = getCircle();
+    const float tol = 1e-3f;
+    std::vector<glm::vec3> points, tangents;
+    std::vector<float> params, lengths;
+    tinynurbs::curveTessellate(crv, tol, points, params, tangents, lengths);
+    // A polygon inscribed in the unit circle needs at least 71 edges
+    REQUIRE(points.size() >= 72);
+    REQUIRE(points.size() <= 2 * 72);
+    REQUIRE(glm::distance(points.front(), points.back()) == Approx(0).margin(1e-5));
+    for (size_t k = 0; k + 1 < points.size(); ++k) {
+        REQUIRE(glm::length(points[k]) == Approx(1));
+        REQUIRE(glm::dot(tangents[k], glm::vec3(-points[k].y, points[k].x, 0)) == Approx(1));
+        glm::vec3 mid = 0.5f * (points[k] + points[k + 1]);
+        REQUIRE(1 - glm::length(mid) <= tol * 1.001f);
+    }
+    REQUIRE(lengths.back() == Approx(glm::two_pi<float>()).epsilon(1e-3));
+}
+
+TEST_CASE("curveClosestPoint (rational)", "[curve, rational, project]")
+{
+    auto crv = getCircle();
+    std::vector<glm::vec3> points;
+    for (int i = 0; i < 360; ++i) {
+        float angle = glm::two_pi<float>() * i / 360;
+        float radius = 0.2f + 0.01f * (i % 300);
+        points.push_back(glm::vec3(radius * std::cos(angle), radius * std::sin(angle), 0.1f));
+    }
+    std::vector<float> params;
+    tinynurbs::curveClosestPoints(crv, points, params);
+    for (size_t i = 0; i < points.size(); ++i) {
+        // The closest point on the unit circle is along the radius
+        glm::vec3 expected = glm::normalize(glm::vec3(points[i].x, points[i].y, 0));
+        glm::vec3 found = tinynurbs::curvePoint(crv, params[i]);
+        REQUIRE(glm::distance(found, expected) == Approx(0).margin(1e-4));
+        float u = tinynurbs::curveClosestPoint(crv, points[i]);
+        REQUIRE(glm::distance(tinynurbs::curvePoint(crv, u), expected) == Approx(0).margin(1e-4));
+    }
+
+    // A span ending at a corner is refined with its own derivatives
+    tinynurbs::RationalCurve3d polyline(
+        1, {0, 0, 0.5, 1, 1}, {glm::dvec3(0, 0, 0), glm::dvec3(2, 0, 0), glm::dvec3(2, 2, 0)},
+        {1, 0.5, 1});
+    glm::dvec3 pt(1.6, 0.3, 0);
+    double u = tinynurbs::curveClosestPoint(polyline, pt);
+    REQUIRE(glm::distance(tinynurbs::curvePoint(polyline, u), glm::dvec3(1.6, 0, 0)) ==
+            Approx(0).margin(1e-9));
+}
+
+TEST_CASE("curveCurvatures and curve frames (rational)", "[curve, rational, evaluate]")
+{
+    auto crv = getCircle();
+    std::vector<float> us;
+    for (int i = 0; i <= 64; ++i) {
+        us.push_back(glm::two_pi<float>() * i / 64);
+    }
+    std::vector<float> kappa, tau;
+    std::vector<glm::vec3> ts, ns, bs;
+    tinynurbs::curveCurvatures(crv, us, kappa);
+    tinynurbs::curveTorsions(crv, us, tau);
+    tinynurbs::curveFrenetFrames(crv, us, ts, ns, bs);
+    for (size_t i = 0; i < us.size(); ++i) {
+        glm::vec3 pt = tinynurbs::curvePoint(crv, us[i]);
+        REQUIRE(kappa[i] == Approx(1).epsilon(1e-4));
+        REQUIRE(tau[i] == Approx(0).margin(1e-4));
+        // Principal normal points to the center
+        REQUIRE(glm::distance(ns[i], -pt) == Approx(0).margin(1e-4));
+        REQUIRE(glm::distance(bs[i], glm::vec3(0, 0, 1)) == Approx(0).margin(1e-4));
+    }
+
+    // For a planar curve the rotation minimizing frame matches the Frenet frame
+    std::vector<glm::vec3> rts, rns, rbs;
+    tinynurbs::curveRotationMinimizingFrames(crv, us, rts, rns, rbs);
+    for (size_t i = 0; i < us.size(); ++i) {
+        REQUIRE(glm::distance(rts[i], ts[i]) == Approx(0).margin(1e-4));
+        REQUIRE(glm::distance(rns[i], ns[i]) == Approx(0).margin(1e-4));
+        REQUIRE(glm::distance(rbs[i], bs[i]) == Approx(0).margin(1e-4));
+    }
+}
+
+TEST_CASE("CurveStepper (rational)", "[curve, rational, evaluate]")
+{
+    auto crv = getCircle();
+    tinynurbs::RationalCurve3d dcrv;
+    dcrv.degree = crv.degree;
+    dcrv.knots.assign(crv.knots.begin(), crv.knots.end());
+    for (size_t i = 0; i < crv.control_points.size(); ++i) {
+        dcrv.control_points.push_back(glm::dvec3(crv.control_points[i]));
+        dcrv.weights.push_back((i % 2 == 0) ? 1.0 : std::sqrt(0.5));
+    }
+    const double step = glm::two_pi<double>() / 10000;
+    std::vector<glm::dvec3> pts;
+    tinynurbs::curveStepPoints(dcrv, 0.0, step, 10001, pts);
+    for (size_t k = 0; k < pts.size(); ++k) {
+        REQUIRE(glm::length(pts[k]) == Approx(1).epsilon(1e-12));
+        glm::dvec3 ref = tinynurbs::curvePoint(dcrv, k * step);
+        REQUIRE(glm::distance(pts[k], ref) == Approx(0).margin(1e-12));
+    }
+
+    std::vector<glm::vec3> pts_f;
+    tinynurbs::curveStepPoints(crv, 0.f, 0.001f, 6000, pts_f);
+    for (size_t k = 0; k < pts_f.size(); ++k) {
+        REQUIRE(glm::length(pts_f[k]) == Approx(1).epsilon(1e-5));
+    }
+}
+
 TEST_CASE("curveIsValid (rational)", "[curve, rational, check]")
 {
     auto crv = getCircle();
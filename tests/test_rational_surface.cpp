@@ -1,7 +1,11 @@
 #include <tinynurbs/tinynurbs.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstring>
+#include <sstream>
 
 #include "catch.hpp"
 
@@ -32,6 +36,11 @@ tinynurbs::RationalSurface3f getHemisphere() {
     return srf;
 }
 
+// Whether a point lies in a box up to a tolerance
+template <typename V> bool inBox(const V &pt, const V &lo, const V &hi, double tol) {
+    return glm::distance(glm::max(lo, glm::min(pt, hi)), pt) <= tol;
+}
+
 TEST_CASE("surfacePoint (rational)", "[surface, rational, evaluate]")
 {
     auto srf = getHemisphere();
@@ -79,6 +88,462 @@ TEST_CASE("surfaceNormal (rational)", "[surface, rational, evaluate]")
     REQUIRE(n.z == Approx(0));
 }
 
+TEST_CASE("surfaceFrame and surfaceFrameGrid (rational)", "[surface, rational, evaluate]")
+{
+    auto srf = getHemisphere();
+    glm::vec3 pt, tu, tv, n;
+    std::tie(pt, tu, tv, n) = tinynurbs::surfaceFrame(srf, 0.5f, 0.5f);
+    REQUIRE(glm::length(pt) == Approx(1));
+    REQUIRE(glm::length(tu) == Approx(1));
+    REQUIRE(glm::length(tv) == Approx(1));
+    REQUIRE(n.x == Approx(0).margin(1e-6));
+    REQUIRE(n.y == Approx(-1));
+    REQUIRE(n.z == Approx(0).margin(1e-6));
+
+    // Normal stays zero at the pinched pole
+    std::tie(pt, tu, tv, n) = tinynurbs::surfaceFrame(srf, 0.f, 0.f);
+    REQUIRE(glm::length(n) == Approx(0));
+
+    tinynurbs::HomogenousSurface3f hsrf(srf);
+    std::vector<float> us, vs;
+    for (int i = 0; i <= 8; ++i) {
+        us.push_back(i / 8.f);
+    }
+    for (int j = 0; j <= 5; ++j) {
+        vs.push_back(j / 5.f);
+    }
+    tinynurbs::array2<glm::vec3> pts, tus, tvs, ns, hpts, htus, htvs, hns;
+    tinynurbs::surfaceFrameGrid(srf, us, vs, pts, tus, tvs, ns);
+    tinynurbs::surfaceFrameGrid(hsrf, us, vs, hpts, htus, htvs, hns);
+    for (size_t i = 0; i < us.size(); ++i) {
+        for (size_t j = 0; j < vs.size(); ++j) {
+            glm::vec3 ref_pt = tinynurbs::surfacePoint(srf, us[i], vs[j]);
+            glm::vec3 ref_n = tinynurbs::surfaceNormal(srf, us[i], vs[j]);
+            std::tie(pt, tu, tv, n) = tinynurbs::surfaceFrame(hsrf, us[i], vs[j]);
+            REQUIRE(glm::distance(pts(i, j), ref_pt) == Approx(0).margin(1e-5));
+            REQUIRE(glm::distance(ns(i, j), ref_n) == Approx(0).margin(1e-5));
+            REQUIRE(glm::distance(hpts(i, j), pt) == Approx(0).margin(1e-5));
+            REQUIRE(glm::distance(htus(i, j), tu) == Approx(0).margin(1e-5));
+            REQUIRE(glm::distance(htvs(i, j), tv) == Approx(0).margin(1e-5));
+            REQUIRE(glm::distance(hns(i, j), n) == Approx(0).margin(1e-5));
+            REQUIRE(glm::distance(tus(i, j), tu) == Approx(0).margin(1e-5));
+            REQUIRE(glm::distance(tvs(i, j), tv) == Approx(0).margin(1e-5));
+        }
+    }
+}
+
+TEST_CASE("surfaceCurvatureGrid (rational)", "[surface, rational, evaluate]")
+{
+    auto srf_f = getHemisphere();
+    tinynurbs::RationalSurface3d srf;
+    srf.degree_u = srf_f.degree_u;
+    srf.degree_v = srf_f.degree_v;
+    srf.knots_u.assign(srf_f.knots_u.begin(), srf_f.knots_u.end());
+    srf.knots_v.assign(srf_f.knots_v.begin(), srf_f.knots_v.end());
+    srf.control_points.resize(4, 4);
+    srf.weights.resize(4, 4);
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            srf.control_points(i, j) = glm::dvec3(srf_f.control_points(i, j));
+            srf.weights(i, j) = ((i % 3 == 0) ? 1.0 : 1.0 / 3) * ((j % 3 == 0) ? 1.0 : 1.0 / 3);
+        }
+    }
+    std::vector<double> us = {0.1, 0.3, 0.5, 0.8};
+    std::vector<double> vs = {0.2, 0.4, 0.5, 0.9};
+    tinynurbs::SurfaceCurvatureField<double> field;
+    tinynurbs::surfaceCurvatureGrid(srf, us, vs, field);
+    for (size_t i = 0; i < us.size(); ++i) {
+        for (size_t j = 0; j < vs.size(); ++j) {
+            // Unit sphere, where every point is umbilic
+            REQUIRE(field.gaussian(i, j) == Approx(1).epsilon(1e-6));
+            REQUIRE(std::abs(field.mean(i, j)) == Approx(1).epsilon(1e-6));
+            REQUIRE(field.k1(i, j) == Approx(field.mean(i, j)).margin(1e-3));
+            REQUIRE(field.k2(i, j) == Approx(field.mean(i, j)).margin(1e-3));
+            REQUIRE(glm::length(field.dir1(i, j)) == Approx(1));
+            REQUIRE(glm::dot(field.dir1(i, j), field.dir2(i, j)) == Approx(0).margin(1e-9));
+        }
+    }
+}
+
+TEST_CASE("surfacePoint and surfaceDerivatives (homogenous)", "[surface, rational, evaluate]")
+{
+    auto srf = getHemisphere();
+    tinynurbs::HomogenousSurface3f hsrf(srf);
+    glm::vec3 pt = tinynurbs::surfacePoint(srf, 0.3f, 0.6f);
+    glm::vec3 hpt = tinynurbs::surfacePoint(hsrf, 0.3f, 0.6f);
+    REQUIRE(glm::length(hpt) == Approx(1));
+    REQUIRE(hpt.x == Approx(pt.x));
+    REQUIRE(hpt.y == Approx(pt.y));
+    REQUIRE(hpt.z == Approx(pt.z));
+
+    auto ders = tinynurbs::surfaceDerivatives(srf, 2, 0.3f, 0.6f);
+    auto hders = tinynurbs::surfaceDerivatives(hsrf, 2, 0.3f, 0.6f);
+    for (int k = 0; k <= 2; ++k) {
+        for (int l = 0; l <= 2 - k; ++l) {
+            REQUIRE(hders(k, l).x == Approx(ders(k, l).x).margin(1e-4));
+            REQUIRE(hders(k, l).y == Approx(ders(k, l).y).margin(1e-4));
+            REQUIRE(hders(k, l).z == Approx(ders(k, l).z).margin(1e-4));
+        }
+    }
+}
+
+TEST_CASE("surfaceDerivatives mixed partial (rational)", "[surface, rational, evaluate]")
+{
+    auto srf = getHemisphere();
+    const float u = 0.4f, v = 0.3f, h = 1e-3f;
+    auto ders = tinynurbs::surfaceDerivatives(srf, 2, u, v);
+    // Central difference of the u-derivative along v
+    glm::vec3 su_p = tinynurbs::surfaceDerivatives(srf, 1, u, v + h)(1, 0);
+    glm::vec3 su_m = tinynurbs::surfaceDerivatives(srf, 1, u, v - h)(1, 0);
+    glm::vec3 suv = (su_p - su_m) / (2 * h);
+    REQUIRE(ders(1, 1).x == Approx(suv.x).margin(1e-2));
+    REQUIRE(ders(1, 1).y == Approx(suv.y).margin(1e-2));
+    REQUIRE(ders(1, 1).z == Approx(suv.z).margin(1e-2));
+}
+
+TEST_CASE("surfaceGrid (rational)", "[surface, rational, evaluate]")
+{
+    auto srf = getHemisphere();
+    std::vector<float> us, vs;
+    for (int i = 0; i <= 8; ++i) {
+        us.push_back(i / 8.f);
+    }
+    for (int j = 0; j <= 5; ++j) {
+        vs.push_back(j / 5.f);
+    }
+    tinynurbs::array2<glm::vec3> pts;
+    tinynurbs::surfaceGrid(srf, us, vs, pts);
+    for (size_t i = 0; i < us.size(); ++i) {
+        for (size_t j = 0; j < vs.size(); ++j) {
+            glm::vec3 pt = tinynurbs::surfacePoint(srf, us[i], vs[j]);
+            REQUIRE(glm::length(pts(i, j)) == Approx(1));
+            REQUIRE(pts(i, j).x == Approx(pt.x).margin(1e-6));
+            REQUIRE(pts(i, j).y == Approx(pt.y).margin(1e-6));
+            REQUIRE(pts(i, j).z == Approx(pt.z).margin(1e-6));
+        }
+    }
+}
+
+TEST_CASE("surfaceDerivatives with workspace (rational)", "[surface, rational, evaluate]")
+{
+    auto srf = getHemisphere();
+    tinynurbs::HomogenousSurface3f hsrf(srf);
+    tinynurbs::EvalWorkspace<float> ws;
+    tinynurbs::array2<glm::vec3> ders, hders;
+    // Reuse one workspace across surfaces, parameters and derivative orders
+    for (unsigned int num_ders : {2u, 1u, 3u}) {
+        for (float u : {0.7f, 0.2f, 0.5f}) {
+            const float v = 1.f - u;
+            tinynurbs::surfaceDerivatives(srf, num_ders, u, v, ders, ws);
+            tinynurbs::surfaceDerivatives(hsrf, num_ders, u, v, hders, ws);
+            auto ref = tinynurbs::surfaceDerivatives(srf, num_ders, u, v);
+            glm::vec3 pt = tinynurbs::surfacePoint(srf, u, v, ws);
+            REQUIRE(pt.x == Approx(ref(0, 0).x).margin(1e-6));
+            REQUIRE(pt.z == Approx(ref(0, 0).z).margin(1e-6));
+            REQUIRE(ders.rows() == num_ders + 1);
+            for (int k = 0; k <= num_ders; ++k) {
+                for (int l = 0; l <= num_ders - k; ++l) {
+                    REQUIRE(ders(k, l).x == Approx(ref(k, l).x).margin(1e-4));
+                    REQUIRE(ders(k, l).y == Approx(ref(k, l).y).margin(1e-4));
+                    REQUIRE(ders(k, l).z == Approx(ref(k, l).z).margin(1e-4));
+                    REQUIRE(hders(k, l).x == Approx(ref(k, l).x).margin(1e-3));
+                    REQUIRE(hders(k, l).y == Approx(ref(k, l).y).margin(1e-3));
+                    REQUIRE(hders(k, l).z == Approx(ref(k, l).z).margin(1e-3));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("SoaSurface (rational)", "[surface, rational, evaluate]")
+{
+    auto srf = getHemisphere();
+    tinynurbs::SoaSurface3f soa(srf);
+    REQUIRE(soa.w.size() == soa.x.size());
+
+    tinynurbs::RationalSurface3f back(soa);
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            REQUIRE(back.weights(i, j) == Approx(srf.weights(i, j)));
+            REQUIRE(back.control_points(i, j).x == Approx(srf.control_points(i, j).x));
+            REQUIRE(back.control_points(i, j).y == Approx(srf.control_points(i, j).y));
+            REQUIRE(back.control_points(i, j).z == Approx(srf.control_points(i, j).z));
+        }
+    }
+
+    std::vector<float> us = {0.f, 0.3f, 0.5f, 1.f}, vs = {0.1f, 0.6f, 0.9f};
+    tinynurbs::array2<glm::vec3> pts;
+    tinynurbs::surfaceGrid(soa, us, vs, pts);
+    tinynurbs::EvalWorkspace<float> ws;
+    tinynurbs::array2<glm::vec3> ders;
+    for (size_t i = 0; i < us.size(); ++i) {
+        for (size_t j = 0; j < vs.size(); ++j) {
+            REQUIRE(glm::length(pts(i, j)) == Approx(1));
+            REQUIRE(glm::length(tinynurbs::surfacePoint(soa, us[i], vs[j], ws)) == Approx(1));
+            auto ref = tinynurbs::surfaceDerivatives(srf, 2, us[i], vs[j]);
+            tinynurbs::surfaceDerivatives(soa, 2, us[i], vs[j], ders, ws);
+            for (int k = 0; k <= 2; ++k) {
+                for (int l = 0; l <= 2 - k; ++l) {
+                    REQUIRE(ders(k, l).x == Approx(ref(k, l).x).margin(1e-4));
+                    REQUIRE(ders(k, l).y == Approx(ref(k, l).y).margin(1e-4));
+                    REQUIRE(ders(k, l).z == Approx(ref(k, l).z).margin(1e-4));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("SurfaceTessellation (rational)", "[surface, rational, evaluate]")
+{
+    auto srf = getHemisphere();
+    std::vector<float> us, vs;
+    for (int i = 0; i <= 10; ++i) {
+        us.push_back(i / 10.f);
+        vs.push_back(i / 10.f);
+    }
+    tinynurbs::SurfaceTessellation3f tess(srf, us, vs);
+    for (size_t k = 0; k < tess.mesh.numVertices(); ++k) {
+        REQUIRE(glm::length(tess.mesh.positions[k]) == Approx(1));
+    }
+
+    // Changing a weight moves the surface off the sphere
+    srf.weights(1, 1) = 0.5f;
+    tess.setControlPoint(1, 1, srf.control_points(1, 1), srf.weights(1, 1));
+    std::vector<tinynurbs::VertexRange> ranges;
+    tess.dirtyRanges(ranges);
+    REQUIRE(!ranges.empty());
+    for (size_t i = 0; i < us.size(); ++i) {
+        for (size_t j = 0; j < vs.size(); ++j) {
+            glm::vec3 pt = tinynurbs::surfacePoint(srf, us[i], vs[j]);
+            REQUIRE(glm::distance(tess.mesh.positions[i * vs.size() + j], pt) ==
+                    Approx(0).margin(1e-5));
+        }
+    }
+}
+
+TEST_CASE("surfaceTessellate (rational)", "[surface, rational, tessellate]")
+{
+    auto srf = getHemisphere();
+    auto mesh = tinynurbs::surfaceTessellate(srf, 17, 33);
+    REQUIRE(mesh.numVertices() == 17 * 33);
+    REQUIRE(mesh.numTriangles() == 2 * 16 * 32);
+    for (size_t k = 0; k < mesh.numVertices(); ++k) {
+        REQUIRE(glm::length(mesh.positions[k]) == Approx(1));
+        // Normals are radial away from the degenerate poles
+        if (mesh.uvs[k].x > 0 && mesh.uvs[k].x < 1) {
+            REQUIRE(std::abs(glm::dot(mesh.normals[k], mesh.positions[k])) == Approx(1));
+        }
+    }
+}
+
+TEST_CASE("surfaceTessellateStream (rational)", "[surface, rational, tessellate]")
+{
+    auto srf = getHemisphere();
+    auto full = tinynurbs::surfaceTessellate(srf, 17, 33);
+
+    std::ostringstream vertices, indices;
+    tinynurbs::surfaceTessellateStream(srf, 17, 33, 5,
+                                       tinynurbs::MeshRawWriter<float>(vertices, indices));
+    const std::string vertex_data = vertices.str(), index_data = indices.str();
+    REQUIRE(vertex_data.size() == 8 * sizeof(float) * full.numVertices());
+    REQUIRE(index_data.size() == sizeof(uint32_t) * full.indices.size());
+    for (size_t k = 0; k < full.numVertices(); ++k) {
+        float vertex[8];
+        std::memcpy(vertex, vertex_data.data() + sizeof(vertex) * k, sizeof(vertex));
+        REQUIRE(glm::distance(glm::vec3(vertex[0], vertex[1], vertex[2]), full.positions[k]) ==
+                Approx(0).margin(1e-6));
+        REQUIRE(glm::distance(glm::vec3(vertex[3], vertex[4], vertex[5]), full.normals[k]) ==
+                Approx(0).margin(1e-5));
+        REQUIRE(glm::vec2(vertex[6], vertex[7]) == full.uvs[k]);
+    }
+    for (size_t k = 0; k < full.indices.size(); ++k) {
+        uint32_t idx;
+        std::memcpy(&idx, index_data.data() + sizeof(idx) * k, sizeof(idx));
+        REQUIRE(idx == full.indices[k]);
+    }
+}
+
+TEST_CASE("surfaceTessellateAdaptive (rational)", "[surface, rational, tessellate]")
+{
+    auto srf = getHemisphere();
+    const float chord_tol = 1e-3f;
+    auto mesh = tinynurbs::surfaceTessellateAdaptive(srf, chord_tol, 0.2f);
+    REQUIRE(mesh.numTriangles() > 0);
+    for (size_t k = 0; k < mesh.numVertices(); ++k) {
+        REQUIRE(glm::length(mesh.positions[k]) == Approx(1));
+    }
+    for (size_t t = 0; t < mesh.numTriangles(); ++t) {
+        glm::vec3 centroid = (mesh.positions[mesh.indices[3 * t]] +
+                              mesh.positions[mesh.indices[3 * t + 1]] +
+                              mesh.positions[mesh.indices[3 * t + 2]]) / 3.f;
+        REQUIRE(glm::length(centroid) > 1 - 4 * chord_tol);
+    }
+}
+
+TEST_CASE("surfaceClosestPoint (rational)", "[surface, rational, project]")
+{
+    auto srf = getHemisphere();
+    std::vector<glm::vec3> points;
+    for (int i = 0; i < 2000; ++i) {
+        float theta = 0.1f + 2.9f * (i % 40) / 39, phi = 0.05f + 3.0f * (i / 40) / 49;
+        float radius = 0.3f + 0.05f * (i % 37);
+        points.push_back(radius * glm::vec3(std::cos(theta) * std::sin(phi),
+                                            std::sin(theta) * std::sin(phi), std::cos(phi)));
+    }
+    std::vector<glm::vec2> params;
+    tinynurbs::surfaceClosestPoints(srf, points, params);
+    for (size_t k = 0; k < points.size(); ++k) {
+        // The closest point on the unit hemisphere is along the radius
+        glm::vec3 expected = glm::normalize(points[k]);
+        glm::vec3 found = tinynurbs::surfacePoint(srf, params[k].x, params[k].y);
+        REQUIRE(glm::distance(found, expected) == Approx(0).margin(1e-3));
+    }
+    glm::vec2 uv = tinynurbs::surfaceClosestPoint(srf, points[123]);
+    REQUIRE(glm::distance(tinynurbs::surfacePoint(srf, uv.x, uv.y),
+                          glm::normalize(points[123])) == Approx(0).margin(1e-3));
+}
+
+TEST_CASE("surfaceBvh (rational)", "[surface, rational, bvh]")
+{
+    auto srf = getHemisphere();
+    for (unsigned int subdivisions : {1u, 4u, 16u}) {
+        auto bvh = tinynurbs::surfaceBvh(srf, subdivisions, true);
+        REQUIRE(bvh.leaves.size() == subdivisions * subdivisions);
+        REQUIRE(bvh.nodes.size() == 2 * bvh.leaves.size() - 1);
+        for (size_t k = 0; k < bvh.leaves.size(); ++k) {
+            const auto &leaf = bvh.leaves[k];
+            const auto &box = bvh.oriented_boxes[k];
+            for (int i = 0; i <= 4; ++i) {
+                for (int j = 0; j <= 4; ++j) {
+                    glm::vec2 uv = leaf.lo + (leaf.hi - leaf.lo) * glm::vec2(i / 4.f, j / 4.f);
+                    glm::vec3 pt = tinynurbs::surfacePoint(srf, uv.x, uv.y);
+                    REQUIRE(inBox(pt, leaf.box_min, leaf.box_max, 1e-5f));
+                    for (int a = 0; a < 3; ++a) {
+                        REQUIRE(std::abs(glm::dot(pt - box.center, box.axes[a])) <=
+                                box.half_extents[a] + 1e-5f);
+                    }
+                }
+            }
+        }
+    }
+
+    // The hierarchy of small pieces bounds the hemisphere closely, although
+    // the control points span [-2, 2] x [0, 4]
+    auto bvh = tinynurbs::surfaceBvh(srf, 16);
+    REQUIRE(bvh.nodes[0].box_min.x == Approx(-1).margin(0.01));
+    REQUIRE(bvh.nodes[0].box_max.x == Approx(1).margin(0.01));
+    REQUIRE(bvh.nodes[0].box_max.y == Approx(1).margin(0.01));
+
+    // Refitting after changing weights bounds the new surface
+    srf.weights(1, 1) = srf.weights(1, 2) = 1.f / 3.f;
+    tinynurbs::surfaceBvhRefit(srf, bvh);
+    for (float u = 0; u <= 1; u += 0.05f) {
+        for (float v = 0; v <= 1; v += 0.05f) {
+            glm::vec3 pt = tinynurbs::surfacePoint(srf, u, v);
+            REQUIRE(inBox(pt, bvh.nodes[0].box_min, bvh.nodes[0].box_max, 1e-5f));
+        }
+    }
+}
+
+TEST_CASE("surfaceRayIntersect (rational)", "[surface, rational, intersect]")
+{
+    auto srf = getHemisphere();
+
+    // Rays towards the center hit the hemisphere at unit distance from it,
+    // and rays from the center hit it after one unit
+    for (int i = 0; i < 100; ++i) {
+        float theta = 0.1f + 2.9f * (i % 10) / 9, phi = 0.1f + 2.9f * (i / 10) / 9;
+        glm::vec3 dir(std::cos(theta) * std::sin(phi), std::sin(theta) * std::sin(phi),
+                      std::cos(phi));
+        auto hit = tinynurbs::surfaceRayIntersect(srf, tinynurbs::Ray3f(3.f * dir, -dir));
+        REQUIRE(hit.hit);
+        REQUIRE(hit.t == Approx(2).margin(1e-4));
+        REQUIRE(std::abs(glm::dot(hit.normal, dir)) == Approx(1).margin(1e-4));
+        glm::vec3 pt = tinynurbs::surfacePoint(srf, hit.uv.x, hit.uv.y);
+        REQUIRE(glm::distance(pt, dir) == Approx(0).margin(1e-4));
+
+        hit = tinynurbs::surfaceRayIntersect(srf, tinynurbs::Ray3f(glm::vec3(0), 0.5f * dir));
+        REQUIRE(hit.hit);
+        REQUIRE(hit.t == Approx(2).margin(1e-4));
+    }
+
+    // A thin closed tube of radius 0.01 made of rational quadratic arcs. Rays
+    // across it hit the near wall, although both walls lie in the same spans
+    const float r = 0.01f, s = std::sqrt(0.5f);
+    const glm::vec2 circle[9] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0},
+                                 {-1, -1}, {0, -1}, {1, -1}, {1, 0}};
+    tinynurbs::RationalSurface3f tube;
+    tube.degree_u = 2;
+    tube.degree_v = 1;
+    tube.knots_u = {0, 0, 0, 0.25f, 0.25f, 0.5f, 0.5f, 0.75f, 0.75f, 1, 1, 1};
+    tube.knots_v = {0, 0, 1, 1};
+    tube.control_points.resize(9, 2);
+    tube.weights.resize(9, 2);
+    for (int i = 0; i < 9; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            tube.control_points(i, j) = glm::vec3(r * circle[i], float(j));
+            tube.weights(i, j) = i % 2 == 0 ? 1.f : s;
+        }
+    }
+    std::vector<tinynurbs::Ray3f> rays;
+    for (int i = 0; i < 21; ++i) {
+        for (int j = 0; j < 5; ++j) {
+            rays.push_back(tinynurbs::Ray3f(glm::vec3(-1, r * (i - 10) / 10.5f, 0.1f + 0.2f * j),
+                                            glm::vec3(1, 0, 0)));
+        }
+    }
+    std::vector<tinynurbs::RayHit3f> hits;
+    tinynurbs::surfaceRayIntersect(tube, rays, hits);
+    for (size_t k = 0; k < rays.size(); ++k) {
+        float y = rays[k].origin.y;
+        REQUIRE(hits[k].hit);
+        REQUIRE(hits[k].t == Approx(1 - std::sqrt(r * r - y * y)).margin(1e-5));
+        REQUIRE(hits[k].normal.x < 0);
+    }
+}
+
+TEST_CASE("surfaceRayIntersect throughput", "[.][benchmark]")
+{
+    auto srf = getHemisphere();
+    const int width = 1024, height = 1024;
+    std::vector<tinynurbs::Ray3f> rays;
+    rays.reserve(width * height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            glm::vec3 target(-1.2f + 2.4f * x / width, 0, -1.2f + 2.4f * y / height);
+            glm::vec3 eye(0.3f, 4, 0.5f);
+            rays.push_back(tinynurbs::Ray3f(eye, target - eye));
+        }
+    }
+    std::vector<tinynurbs::RayHit3f> hits;
+    auto start = std::chrono::steady_clock::now();
+    tinynurbs::surfaceRayIntersect(srf, rays, hits);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    size_t num_hits = std::count_if(hits.begin(), hits.end(),
+                                    [](const tinynurbs::RayHit3f &hit) { return hit.hit; });
+    WARN(rays.size() / elapsed.count() << " rays/s, " << num_hits << " hits");
+    REQUIRE(num_hits > 0);
+}
+
+TEST_CASE("CompiledSurface (rational)", "[surface, rational, evaluate]")
+{
+    auto srf = getHemisphere();
+    tinynurbs::CompiledSurface3f csrf(srf);
+    REQUIRE(tinynurbs::surfaceCompiledError(csrf, srf) < 1e-5f);
+    for (float u : {0.1f, 0.5f, 0.8f}) {
+        REQUIRE(glm::length(tinynurbs::surfacePoint(csrf, u, 0.3f)) == Approx(1));
+        auto ref = tinynurbs::surfaceDerivatives(srf, 2, u, 0.3f);
+        auto ders = tinynurbs::surfaceDerivatives(csrf, 2, u, 0.3f);
+        for (int k = 0; k <= 2; ++k) {
+            for (int l = 0; l <= 2 - k; ++l) {
+                REQUIRE(ders(k, l).x == Approx(ref(k, l).x).margin(1e-3));
+                REQUIRE(ders(k, l).y == Approx(ref(k, l).y).margin(1e-3));
+                REQUIRE(ders(k, l).z == Approx(ref(k, l).z).margin(1e-3));
+            }
+        }
+    }
+}
+
 TEST_CASE("surfaceIsValid (rational)", "[surface, rational, check]")
 {
     auto srf = getHemisphere();
@@ -2,6 +2,9 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 #include <cmath>
+#include <limits>
+#include <map>
+#include <sstream>
 #include "catch.hpp"
 
 using namespace std;
@@ -21,6 +24,44 @@ tinynurbs::Surface3f getBilinearPatch() {
     return srf;
 }
 
+// Biquadratic-by-bicubic surface with interior knots and a 4x6 grid of control points
+template <typename T = double> tinynurbs::Surface<T> getWavySurface() {
+    tinynurbs::Surface<T> srf;
+    srf.degree_u = 2;
+    srf.degree_v = 3;
+    srf.knots_u = {0, 0, 0, T(0.4), 1, 1, 1};
+    srf.knots_v = {0, 0, 0, 0, T(0.3), T(0.6), 1, 1, 1, 1};
+    srf.control_points.resize(4, 6);
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 6; ++j) {
+            srf.control_points(i, j) = glm::vec<3, T>(i, j, std::sin(T(i * j)));
+        }
+    }
+    return srf;
+}
+
+// Quadratic along u with a double knot at 0.5, where the surface has a crease, over a 5x6 grid
+// of control points
+template <typename T = double> tinynurbs::Surface<T> getCreasedSurface() {
+    tinynurbs::Surface<T> srf;
+    srf.degree_u = 2;
+    srf.degree_v = 3;
+    srf.knots_u = {0, 0, 0, T(0.5), T(0.5), 1, 1, 1};
+    srf.knots_v = {0, 0, 0, 0, T(0.3), T(0.6), 1, 1, 1, 1};
+    srf.control_points.resize(5, 6);
+    for (int i = 0; i < 5; ++i) {
+        for (int j = 0; j < 6; ++j) {
+            srf.control_points(i, j) = glm::vec<3, T>(i, j, (i % 2) + T(0.1) * std::sin(T(j)));
+        }
+    }
+    return srf;
+}
+
+// Whether a point lies in a box up to a tolerance
+template <typename V> bool inBox(const V &pt, const V &lo, const V &hi, double tol) {
+    return glm::distance(glm::max(lo, glm::min(pt, hi)), pt) <= tol;
+}
+
 TEST_CASE("surfacePoint (non-rational)", "[surface, non-rational, evaluate]")
 {
     auto srf = getBilinearPatch();
@@ -66,6 +107,650 @@ TEST_CASE("surfaceNormal (non-rational)", "[surface, non-rational, evaluate]")
     REQUIRE(n.z == Approx(0));
 }
 
+TEST_CASE("surfaceGrid (non-rational)", "[surface, non-rational, evaluate]")
+{
+    auto srf = getWavySurface<float>();
+    std::vector<float> us = {0.f, 0.25f, 0.4f, 0.7f, 1.f};
+    std::vector<float> vs = {0.f, 0.1f, 0.3f, 0.45f, 0.6f, 0.8f, 1.f};
+    tinynurbs::array2<glm::vec3> pts;
+    tinynurbs::surfaceGrid(srf, us, vs, pts);
+    REQUIRE(pts.rows() == us.size());
+    REQUIRE(pts.cols() == vs.size());
+    for (size_t i = 0; i < us.size(); ++i) {
+        for (size_t j = 0; j < vs.size(); ++j) {
+            glm::vec3 pt = tinynurbs::surfacePoint(srf, us[i], vs[j]);
+            REQUIRE(pts(i, j).x == Approx(pt.x));
+            REQUIRE(pts(i, j).y == Approx(pt.y));
+            REQUIRE(pts(i, j).z == Approx(pt.z).margin(1e-6));
+        }
+    }
+}
+
+TEST_CASE("surfaceFrame and surfaceFrameGrid (non-rational)", "[surface, non-rational, evaluate]")
+{
+    auto srf = getWavySurface();
+    std::vector<double> us = {0, 0.25, 0.4, 0.7, 1};
+    std::vector<double> vs = {0, 0.1, 0.3, 0.45, 0.6, 0.8, 1};
+    tinynurbs::array2<glm::dvec3> pts, tus, tvs, ns;
+    tinynurbs::surfaceFrameGrid(srf, us, vs, pts, tus, tvs, ns);
+    REQUIRE(ns.rows() == us.size());
+    REQUIRE(ns.cols() == vs.size());
+    tinynurbs::EvalWorkspace<double> ws;
+    for (size_t i = 0; i < us.size(); ++i) {
+        for (size_t j = 0; j < vs.size(); ++j) {
+            glm::dvec3 pt, tu, tv, n;
+            std::tie(pt, tu, tv, n) = tinynurbs::surfaceFrame(srf, us[i], vs[j], ws);
+            auto ders = tinynurbs::surfaceDerivatives(srf, 1, us[i], vs[j]);
+            REQUIRE(glm::distance(pt, ders(0, 0)) == Approx(0).margin(1e-12));
+            REQUIRE(glm::distance(tu, glm::normalize(ders(1, 0))) == Approx(0).margin(1e-12));
+            REQUIRE(glm::distance(tv, glm::normalize(ders(0, 1))) == Approx(0).margin(1e-12));
+            glm::dvec3 ref_n = glm::normalize(glm::cross(ders(0, 1), ders(1, 0)));
+            REQUIRE(glm::distance(n, ref_n) == Approx(0).margin(1e-12));
+
+            REQUIRE(glm::distance(pts(i, j), pt) == Approx(0).margin(1e-12));
+            REQUIRE(glm::distance(tus(i, j), tu) == Approx(0).margin(1e-12));
+            REQUIRE(glm::distance(tvs(i, j), tv) == Approx(0).margin(1e-12));
+            REQUIRE(glm::distance(ns(i, j), n) == Approx(0).margin(1e-12));
+        }
+    }
+}
+
+TEST_CASE("surfaceCurvatureGrid (non-rational)", "[surface, non-rational, evaluate]")
+{
+    auto srf = getWavySurface();
+    std::vector<double> us = {0, 0.25, 0.4, 0.7, 1};
+    std::vector<double> vs = {0, 0.1, 0.3, 0.45, 0.6, 0.8, 1};
+    tinynurbs::SurfaceCurvatureField<double> field;
+    tinynurbs::surfaceCurvatureGrid(srf, us, vs, field);
+    REQUIRE(field.gaussian.rows() == us.size());
+    REQUIRE(field.gaussian.cols() == vs.size());
+    for (size_t i = 0; i < us.size(); ++i) {
+        for (size_t j = 0; j < vs.size(); ++j) {
+            auto d = tinynurbs::surfaceDerivatives(srf, 2, us[i], vs[j]);
+            glm::dvec3 n = tinynurbs::surfaceNormal(srf, us[i], vs[j]);
+            double E = glm::dot(d(1, 0), d(1, 0));
+            double F = glm::dot(d(1, 0), d(0, 1));
+            double G = glm::dot(d(0, 1), d(0, 1));
+            double L = glm::dot(d(2, 0), n);
+            double M = glm::dot(d(1, 1), n);
+            double N = glm::dot(d(0, 2), n);
+            double K = (L * N - M * M) / (E * G - F * F);
+            double H = (E * N - 2 * F * M + G * L) / (2 * (E * G - F * F));
+            REQUIRE(field.E(i, j) == Approx(E));
+            REQUIRE(field.F(i, j) == Approx(F).margin(1e-12));
+            REQUIRE(field.G(i, j) == Approx(G));
+            REQUIRE(field.L(i, j) == Approx(L).margin(1e-12));
+            REQUIRE(field.M(i, j) == Approx(M).margin(1e-12));
+            REQUIRE(field.N(i, j) == Approx(N).margin(1e-12));
+            REQUIRE(field.gaussian(i, j) == Approx(K).margin(1e-12));
+            REQUIRE(field.mean(i, j) == Approx(H).margin(1e-12));
+            REQUIRE(field.k1(i, j) * field.k2(i, j) == Approx(K).margin(1e-9));
+            REQUIRE(field.k1(i, j) + field.k2(i, j) == Approx(2 * H).margin(1e-9));
+            REQUIRE(field.k1(i, j) >= field.k2(i, j));
+
+            // Principal directions are orthonormal, tangent to the surface, and
+            // have normal curvature k1 and k2
+            glm::dvec3 e1 = field.dir1(i, j), e2 = field.dir2(i, j);
+            REQUIRE(glm::length(e1) == Approx(1));
+            REQUIRE(glm::dot(e1, e2) == Approx(0).margin(1e-9));
+            REQUIRE(glm::dot(e1, n) == Approx(0).margin(1e-9));
+            // Parametric coordinates of e1 in the tangent basis
+            double a = glm::dot(e1, d(1, 0)), b = glm::dot(e1, d(0, 1));
+            double det = E * G - F * F;
+            double du = (G * a - F * b) / det, dv = (E * b - F * a) / det;
+            double kn = (L * du * du + 2 * M * du * dv + N * dv * dv) /
+                        (E * du * du + 2 * F * du * dv + G * dv * dv);
+            REQUIRE(kn == Approx(field.k1(i, j)).margin(1e-6));
+        }
+    }
+}
+
+TEST_CASE("surfaceIsoCurveU and surfaceIsoCurveV (non-rational)", "[surface, non-rational, evaluate]")
+{
+    auto srf = getWavySurface();
+    auto iso_u = tinynurbs::surfaceIsoCurveU(srf, 0.45);
+    auto iso_v = tinynurbs::surfaceIsoCurveV(srf, 0.7);
+    std::vector<glm::dvec3> pts_u, pts_v;
+    tinynurbs::curveStepPoints(iso_u, 0.0, 0.001, 1001, pts_u);
+    tinynurbs::curveStepPoints(iso_v, 0.0, 0.001, 1001, pts_v);
+    for (int k = 0; k <= 1000; ++k) {
+        double t = k * 0.001;
+        REQUIRE(glm::distance(pts_u[k], tinynurbs::surfacePoint(srf, t, 0.45)) ==
+                Approx(0).margin(1e-12));
+        REQUIRE(glm::distance(pts_v[k], tinynurbs::surfacePoint(srf, 0.7, t)) ==
+                Approx(0).margin(1e-12));
+    }
+}
+
+TEST_CASE("surfaceCollocationMatrix (non-rational)", "[surface, non-rational, evaluate]")
+{
+    auto srf = getWavySurface();
+    std::vector<double> us = {0, 0.25, 0.4, 0.7, 1};
+    std::vector<double> vs = {0.1, 0.3, 0.45, 0.8, 1};
+    tinynurbs::CsrMatrix<double> mat;
+    tinynurbs::surfaceCollocationMatrix(srf, us, vs, mat, 2);
+    REQUIRE(mat.rows == us.size() * 9);
+    REQUIRE(mat.cols == 24);
+    // Six derivatives with k + l <= 2 per sample, each over 3 x 4 control points
+    REQUIRE(mat.nonZeros() == us.size() * 6 * 12);
+
+    std::vector<glm::dvec3> samples;
+    tinynurbs::csrMultiply(mat, srf.control_points, samples);
+    for (size_t i = 0; i < us.size(); ++i) {
+        auto ref = tinynurbs::surfaceDerivatives(srf, 2, us[i], vs[i]);
+        for (int k = 0; k <= 2; ++k) {
+            for (int l = 0; l + k <= 2; ++l) {
+                glm::dvec3 d = samples[(i * 3 + k) * 3 + l];
+                REQUIRE(glm::distance(d, ref(k, l)) == Approx(0).margin(1e-9));
+            }
+        }
+    }
+}
+
+TEST_CASE("SurfaceTessellation (non-rational)", "[surface, non-rational, evaluate]")
+{
+    tinynurbs::Surface3d srf;
+    srf.degree_u = 2;
+    srf.degree_v = 3;
+    srf.knots_u = {0, 0, 0, 0.2, 0.4, 0.6, 0.8, 1, 1, 1};
+    srf.knots_v = {0, 0, 0, 0, 0.25, 0.5, 0.75, 1, 1, 1, 1};
+    srf.control_points.resize(7, 7);
+    for (int i = 0; i < 7; ++i) {
+        for (int j = 0; j < 7; ++j) {
+            srf.control_points(i, j) = glm::dvec3(i, j, std::sin(double(i * j)));
+        }
+    }
+    std::vector<double> us, vs;
+    for (int i = 0; i <= 20; ++i) {
+        us.push_back(i / 20.0);
+        vs.push_back(i / 20.0);
+    }
+    tinynurbs::SurfaceTessellation3d tess(srf, us, vs);
+    REQUIRE(tess.mesh.numVertices() == 21 * 21);
+    REQUIRE(tess.mesh.numTriangles() == 2 * 20 * 20);
+    std::vector<tinynurbs::VertexRange> ranges;
+    tess.dirtyRanges(ranges);
+    REQUIRE(ranges.empty());
+
+    // Triangles wind counter-clockwise around the normals
+    const auto &m = tess.mesh;
+    for (size_t t = 0; t < m.numTriangles(); t += 37) {
+        unsigned int a = m.indices[3 * t], b = m.indices[3 * t + 1], c = m.indices[3 * t + 2];
+        glm::dvec3 n = glm::cross(m.positions[b] - m.positions[a], m.positions[c] - m.positions[a]);
+        REQUIRE(glm::dot(n, m.normals[a]) > 0);
+    }
+
+    // Only the vertices in the support of the edited control point change
+    std::vector<glm::dvec3> before = tess.mesh.positions;
+    srf.control_points(3, 2) += glm::dvec3(0, 0, 2);
+    tess.setControlPoint(3, 2, srf.control_points(3, 2));
+    tess.dirtyRanges(ranges);
+    REQUIRE(!ranges.empty());
+    std::vector<bool> dirty(before.size(), false);
+    for (const auto &range : ranges) {
+        for (size_t k = range.first; k < range.first + range.count; ++k) {
+            dirty[k] = true;
+        }
+    }
+    size_t num_dirty = std::count(dirty.begin(), dirty.end(), true);
+    REQUIRE(num_dirty < before.size() / 2);
+    for (size_t i = 0; i < us.size(); ++i) {
+        for (size_t j = 0; j < vs.size(); ++j) {
+            size_t k = i * vs.size() + j;
+            glm::dvec3 pt = tinynurbs::surfacePoint(srf, us[i], vs[j]);
+            REQUIRE(glm::distance(tess.mesh.positions[k], pt) == Approx(0).margin(1e-12));
+            if (!dirty[k]) {
+                REQUIRE(tess.mesh.positions[k] == before[k]);
+            }
+            glm::dvec3 n = tinynurbs::surfaceNormal(srf, us[i], vs[j]);
+            REQUIRE(glm::distance(tess.mesh.normals[k], n) == Approx(0).margin(1e-9));
+        }
+    }
+
+    tess.clearDirty();
+    tess.dirtyRanges(ranges);
+    REQUIRE(ranges.empty());
+}
+
+TEST_CASE("surfaceTessellate (non-rational)", "[surface, non-rational, tessellate]")
+{
+    auto srf = getCreasedSurface();
+
+    auto mesh = tinynurbs::surfaceTessellate(srf, 7, 9);
+    REQUIRE(mesh.numVertices() == 7 * 9);
+    REQUIRE(mesh.numTriangles() == 2 * 6 * 8);
+    for (size_t k = 0; k < mesh.numVertices(); ++k) {
+        glm::dvec3 pt = tinynurbs::surfacePoint(srf, mesh.uvs[k].x, mesh.uvs[k].y);
+        glm::dvec3 n = tinynurbs::surfaceNormal(srf, mesh.uvs[k].x, mesh.uvs[k].y);
+        REQUIRE(glm::distance(mesh.positions[k], pt) == Approx(0).margin(1e-12));
+        REQUIRE(glm::distance(mesh.normals[k], n) == Approx(0).margin(1e-9));
+    }
+
+    // Knot-aligned sampling hits every knot and splits the mesh at the crease
+    tinynurbs::surfaceTessellate(srf, 7, 9, mesh, true);
+    size_t num_crease = 0;
+    for (size_t k = 0; k < mesh.numVertices(); ++k) {
+        REQUIRE(glm::distance(mesh.positions[k],
+                              tinynurbs::surfacePoint(srf, mesh.uvs[k].x, mesh.uvs[k].y)) ==
+                Approx(0).margin(1e-12));
+        if (mesh.uvs[k].x == 0.5) {
+            ++num_crease;
+        }
+    }
+    size_t cols = mesh.numVertices() / 8;
+    REQUIRE(mesh.numVertices() == 8 * cols);
+    REQUIRE(num_crease == 2 * cols);
+    for (double v : {0.3, 0.6}) {
+        REQUIRE(std::count_if(mesh.uvs.begin(), mesh.uvs.end(),
+                              [v](const glm::dvec2 &uv) { return uv.y == v; }) == 8);
+    }
+    for (size_t k = 0; k < cols; ++k) {
+        // Rows 3 and 4 are the crease seen from the left and from the right
+        size_t left = 3 * cols + k, right = 4 * cols + k;
+        REQUIRE(mesh.uvs[left] == mesh.uvs[right]);
+        REQUIRE(glm::distance(mesh.positions[left], mesh.positions[right]) == Approx(0));
+        glm::dvec3 n_left = tinynurbs::surfaceNormal(srf, 0.5 - 1e-9, mesh.uvs[left].y);
+        glm::dvec3 n_right = tinynurbs::surfaceNormal(srf, 0.5 + 1e-9, mesh.uvs[left].y);
+        REQUIRE(glm::distance(mesh.normals[left], n_left) == Approx(0).margin(1e-6));
+        REQUIRE(glm::distance(mesh.normals[right], n_right) == Approx(0).margin(1e-6));
+        REQUIRE(glm::dot(n_left, n_right) < 0.9);
+    }
+}
+
+TEST_CASE("surfaceTessellateStream (non-rational)", "[surface, non-rational, tessellate]")
+{
+    auto srf = getCreasedSurface();
+    const size_t nu = 11, nv = 9;
+    auto full = tinynurbs::surfaceTessellate(srf, nu, nv);
+
+    // Reassemble the bands and compare with the mesh built at once
+    for (size_t band_rows : {1, 3, 4, 11, 20}) {
+        tinynurbs::TriangleMesh3d mesh;
+        size_t max_vertices = 0;
+        tinynurbs::surfaceTessellateStream(srf, nu, nv, band_rows,
+                                           [&](const tinynurbs::TessellationBand<double> &band) {
+            REQUIRE(band.first_vertex + band.num_shared == mesh.numVertices());
+            REQUIRE(band.first_triangle == mesh.numTriangles());
+            max_vertices = std::max(max_vertices, band.mesh.numVertices());
+            for (size_t k = band.num_shared; k < band.mesh.numVertices(); ++k) {
+                mesh.positions.push_back(band.mesh.positions[k]);
+                mesh.normals.push_back(band.mesh.normals[k]);
+                mesh.uvs.push_back(band.mesh.uvs[k]);
+            }
+            for (unsigned int idx : band.mesh.indices) {
+                mesh.indices.push_back(static_cast<unsigned int>(band.first_vertex + idx));
+            }
+        });
+        REQUIRE(max_vertices <= (std::min(band_rows, nu) + 1) * nv);
+        REQUIRE(mesh.indices == full.indices);
+        REQUIRE(mesh.uvs == full.uvs);
+        for (size_t k = 0; k < full.numVertices(); ++k) {
+            REQUIRE(glm::distance(mesh.positions[k], full.positions[k]) == Approx(0).margin(1e-12));
+            REQUIRE(glm::distance(mesh.normals[k], full.normals[k]) == Approx(0).margin(1e-12));
+        }
+    }
+
+    // Writers produce the same output whatever the band size
+    std::ostringstream obj_a, obj_b, stl_a, stl_b;
+    tinynurbs::surfaceSaveMeshOBJ(obj_a, srf, nu, nv, 2);
+    tinynurbs::surfaceSaveMeshOBJ(obj_b, srf, nu, nv, 64);
+    // Vertex and face lines are interleaved by band, but each kind keeps its order
+    std::map<std::string, std::vector<std::string>> lines_a, lines_b;
+    for (auto &obj : {std::make_pair(&obj_a, &lines_a), std::make_pair(&obj_b, &lines_b)}) {
+        std::istringstream lines(obj.first->str());
+        std::string line;
+        while (std::getline(lines, line)) {
+            (*obj.second)[line.substr(0, line.find(' '))].push_back(line);
+        }
+    }
+    REQUIRE(lines_a == lines_b);
+    REQUIRE(lines_a.size() == 3);
+    REQUIRE(lines_a["v"].size() == full.numVertices());
+    REQUIRE(lines_a["vn"].size() == full.numVertices());
+    REQUIRE(lines_a["f"].size() == full.numTriangles());
+    REQUIRE(lines_a["f"][0] == "f 1//1 2//2 10//10");
+
+    tinynurbs::surfaceSaveMeshSTL(stl_a, srf, nu, nv, 2);
+    tinynurbs::surfaceSaveMeshSTL(stl_b, srf, nu, nv, 64);
+    REQUIRE(stl_a.str() == stl_b.str());
+    REQUIRE(stl_a.str().size() == 84 + 50 * full.numTriangles());
+    const std::string stl = stl_a.str();
+    uint32_t count = 0;
+    for (int i = 0; i < 4; ++i) {
+        count |= uint32_t(static_cast<unsigned char>(stl[80 + i])) << (8 * i);
+    }
+    REQUIRE(count == full.numTriangles());
+}
+
+// Check that every edge of a mesh is shared by two triangles with opposite
+// orientation, except edges on the boundary of the parameter domain
+template <typename T>
+void requireCrackFree(const tinynurbs::TriangleMesh<T> &mesh, T u_min, T u_max, T v_min, T v_max) {
+    std::map<std::pair<unsigned int, unsigned int>, int> edges;
+    for (size_t t = 0; t < mesh.numTriangles(); ++t) {
+        for (int e = 0; e < 3; ++e) {
+            unsigned int a = mesh.indices[3 * t + e], b = mesh.indices[3 * t + (e + 1) % 3];
+            REQUIRE(a != b);
+            REQUIRE(++edges[{a, b}] == 1);
+        }
+    }
+    for (const auto &edge : edges) {
+        if (edges.count({edge.first.second, edge.first.first}) == 0) {
+            auto uv_a = mesh.uvs[edge.first.first], uv_b = mesh.uvs[edge.first.second];
+            bool on_boundary = (uv_a.x == u_min && uv_b.x == u_min) ||
+                               (uv_a.x == u_max && uv_b.x == u_max) ||
+                               (uv_a.y == v_min && uv_b.y == v_min) ||
+                               (uv_a.y == v_max && uv_b.y == v_max);
+            REQUIRE(on_boundary);
+        }
+    }
+}
+
+TEST_CASE("surfaceTessellateAdaptive (non-rational)", "[surface, non-rational, tessellate]")
+{
+    // Flat plate with a bump near one corner
+    tinynurbs::Surface3d srf;
+    srf.degree_u = 3;
+    srf.degree_v = 3;
+    srf.knots_u = {0, 0, 0, 0, 0.25, 0.5, 0.75, 1, 1, 1, 1};
+    srf.knots_v = {0, 0, 0, 0, 0.25, 0.5, 0.75, 1, 1, 1, 1};
+    srf.control_points.resize(7, 7);
+    for (int i = 0; i < 7; ++i) {
+        for (int j = 0; j < 7; ++j) {
+            srf.control_points(i, j) = glm::dvec3(i, j, (i == 1 && j == 1) ? 2.0 : 0.0);
+        }
+    }
+
+    const double chord_tol = 1e-3, angle_tol = 0.1;
+    tinynurbs::TriangleMesh3d mesh;
+    tinynurbs::surfaceTessellateAdaptive(srf, chord_tol, angle_tol, mesh, 6, 4);
+    requireCrackFree(mesh, 0.0, 1.0, 0.0, 1.0);
+    for (size_t k = 0; k < mesh.numVertices(); ++k) {
+        glm::dvec3 pt = tinynurbs::surfacePoint(srf, mesh.uvs[k].x, mesh.uvs[k].y);
+        REQUIRE(glm::distance(mesh.positions[k], pt) == Approx(0).margin(1e-12));
+    }
+    for (size_t t = 0; t < mesh.numTriangles(); ++t) {
+        unsigned int a = mesh.indices[3 * t], b = mesh.indices[3 * t + 1],
+                     c = mesh.indices[3 * t + 2];
+        glm::dvec2 uv = (mesh.uvs[a] + mesh.uvs[b] + mesh.uvs[c]) / 3.0;
+        glm::dvec3 centroid = (mesh.positions[a] + mesh.positions[b] + mesh.positions[c]) / 3.0;
+        REQUIRE(glm::distance(tinynurbs::surfacePoint(srf, uv.x, uv.y), centroid) <
+                4 * chord_tol);
+    }
+
+    // A uniform grid at the finest level of the quadtree would need 2 * 256^2 triangles
+    REQUIRE(mesh.numTriangles() < 2 * 256 * 256 / 4);
+
+    // The result does not depend on the number of threads
+    tinynurbs::TriangleMesh3d serial;
+    tinynurbs::surfaceTessellateAdaptive(srf, chord_tol, angle_tol, serial, 6, 1);
+    REQUIRE(serial.indices == mesh.indices);
+    REQUIRE(serial.positions == mesh.positions);
+
+    // Lattice coordinates of 2048 spans at depth 20 do not fit in 32 bits
+    tinynurbs::Surface3d strip;
+    strip.degree_u = 1;
+    strip.degree_v = 1;
+    strip.knots_u = {0};
+    for (int i = 0; i <= 2048; ++i) {
+        strip.knots_u.push_back(i);
+    }
+    strip.knots_u.push_back(2048);
+    strip.knots_v = {0, 0, 1, 1};
+    strip.control_points.resize(2049, 2);
+    for (int i = 0; i < 2049; ++i) {
+        strip.control_points(i, 0) = glm::dvec3(i, 0, 0);
+        strip.control_points(i, 1) = glm::dvec3(i, 1, 0);
+    }
+    REQUIRE_THROWS_AS(tinynurbs::surfaceTessellateAdaptive(strip, chord_tol, angle_tol, mesh, 20),
+                      std::runtime_error);
+    tinynurbs::surfaceTessellateAdaptive(strip, chord_tol, angle_tol, mesh, 19);
+    REQUIRE(mesh.numTriangles() == 2 * 2048);
+}
+
+TEST_CASE("surfaceClosestPoint (non-rational)", "[surface, non-rational, project]")
+{
+    auto srf = getCreasedSurface();
+
+    // Dense samples give an upper bound of the distance to the surface
+    std::vector<double> samples(301);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = double(i) / (samples.size() - 1);
+    }
+    tinynurbs::array2<glm::dvec3> grid;
+    tinynurbs::surfaceGrid(srf, samples, samples, grid);
+
+    std::vector<glm::dvec3> points;
+    for (int i = 0; i < 150; ++i) {
+        double t = i / 149.0;
+        points.push_back(glm::dvec3(5 * t - 0.5, 6 * std::abs(std::sin(7 * t)) - 0.5,
+                                    1.5 * std::cos(13 * t)));
+    }
+    std::vector<glm::dvec2> params;
+    tinynurbs::surfaceClosestPoints(srf, points, params, 3);
+    REQUIRE(params.size() == points.size());
+    for (size_t k = 0; k < points.size(); ++k) {
+        glm::dvec2 uv = tinynurbs::surfaceClosestPoint(srf, points[k]);
+        REQUIRE(uv.x >= 0);
+        REQUIRE(uv.x <= 1);
+        REQUIRE(uv.y >= 0);
+        REQUIRE(uv.y <= 1);
+        double dist = glm::distance(tinynurbs::surfacePoint(srf, uv.x, uv.y), points[k]);
+        double sampled = std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < grid.rows(); ++i) {
+            for (size_t j = 0; j < grid.cols(); ++j) {
+                sampled = std::min(sampled, glm::distance(grid(i, j), points[k]));
+            }
+        }
+        REQUIRE(dist <= sampled + 1e-12);
+        REQUIRE(glm::distance(tinynurbs::surfacePoint(srf, params[k].x, params[k].y),
+                              points[k]) == Approx(dist).margin(1e-9));
+    }
+
+    // Points on the surface project to themselves
+    for (double u : {0.0, 0.2, 0.5, 0.9}) {
+        for (double v : {0.1, 0.3, 0.75, 1.0}) {
+            glm::dvec2 uv = tinynurbs::surfaceClosestPoint(srf, tinynurbs::surfacePoint(srf, u, v));
+            REQUIRE(uv.x == Approx(u).margin(1e-9));
+            REQUIRE(uv.y == Approx(v).margin(1e-9));
+        }
+    }
+
+    // Points beyond the boundary u = 1 project onto the boundary curve
+    glm::dvec3 pt(7, 2.5, 0.3);
+    glm::dvec2 uv = tinynurbs::surfaceClosestPoint(srf, pt);
+    REQUIRE(uv.x == 1);
+    auto ders = tinynurbs::surfaceDerivatives(srf, 1, uv.x, uv.y);
+    REQUIRE(glm::dot(ders(0, 1), ders(0, 0) - pt) == Approx(0).margin(1e-9));
+    tinynurbs::Curve3d boundary = tinynurbs::surfaceIsoCurveV(srf, 1.0);
+    REQUIRE(uv.y == Approx(tinynurbs::curveClosestPoint(boundary, pt)).margin(1e-9));
+
+    // Newton on the saddle steps out across the boundary v = 0, where the
+    // closest point lies
+    tinynurbs::Surface3d saddle;
+    saddle.degree_u = saddle.degree_v = 1;
+    saddle.knots_u = saddle.knots_v = {0, 0, 1, 1};
+    saddle.control_points = {2, 2,
+                             {glm::dvec3(0, 0, 0), glm::dvec3(0, 1, 0), glm::dvec3(1, 0, 0),
+                              glm::dvec3(1, 1, 1)}};
+    pt = glm::dvec3(0.3, -1, 0.5);
+    uv = tinynurbs::surfaceClosestPoint(saddle, pt);
+    REQUIRE(uv.x == Approx(0.3).margin(1e-9));
+    REQUIRE(uv.y == Approx(0).margin(1e-9));
+    REQUIRE(glm::distance(tinynurbs::surfacePoint(saddle, uv.x, uv.y), pt) ==
+            Approx(std::sqrt(1.25)));
+}
+
+TEST_CASE("surfaceBvh (non-rational)", "[surface, non-rational, bvh]")
+{
+    auto srf = getCreasedSurface();
+
+    // Every sample of a leaf lies in its boxes, and in the boxes of its ancestors
+    auto check = [&](const tinynurbs::Bvh3d &bvh) {
+        REQUIRE(bvh.nodes.size() == 2 * bvh.leaves.size() - 1);
+        std::vector<size_t> parent(bvh.nodes.size(), 0);
+        std::vector<int> visits(bvh.leaves.size(), 0);
+        for (size_t k = 0; k < bvh.nodes.size(); ++k) {
+            const auto &node = bvh.nodes[k];
+            if (node.isLeaf()) {
+                ++visits[node.leaf];
+                continue;
+            }
+            REQUIRE(node.right > k + 1);
+            parent[k + 1] = parent[node.right] = k;
+        }
+        for (size_t k = 0; k < bvh.nodes.size(); ++k) {
+            if (!bvh.nodes[k].isLeaf()) {
+                continue;
+            }
+            const auto &leaf = bvh.leaves[bvh.nodes[k].leaf];
+            for (int i = 0; i <= 4; ++i) {
+                for (int j = 0; j <= 4; ++j) {
+                    glm::dvec2 uv = leaf.lo + (leaf.hi - leaf.lo) * glm::dvec2(i / 4.0, j / 4.0);
+                    glm::dvec3 pt = tinynurbs::surfacePoint(srf, uv.x, uv.y);
+                    for (size_t n = k;; n = parent[n]) {
+                        REQUIRE(inBox(pt, bvh.nodes[n].box_min, bvh.nodes[n].box_max, 1e-12));
+                        if (n == 0) {
+                            break;
+                        }
+                    }
+                    if (!bvh.oriented_boxes.empty()) {
+                        const auto &box = bvh.oriented_boxes[bvh.nodes[k].leaf];
+                        for (int a = 0; a < 3; ++a) {
+                            REQUIRE(std::abs(glm::dot(pt - box.center, box.axes[a])) <=
+                                    box.half_extents[a] + 1e-12);
+                        }
+                    }
+                }
+            }
+        }
+        for (int count : visits) {
+            REQUIRE(count == 1);
+        }
+    };
+
+    tinynurbs::Bvh3d bvh = tinynurbs::surfaceBvh(srf);
+    REQUIRE(bvh.leaves.size() == 2 * 3);
+    REQUIRE(bvh.oriented_boxes.empty());
+    check(bvh);
+
+    // Sub-span leaves are bounded more tightly than the spans they split
+    tinynurbs::Bvh3d fine = tinynurbs::surfaceBvh(srf, 3, true);
+    REQUIRE(fine.leaves.size() == 2 * 3 * 9);
+    REQUIRE(fine.oriented_boxes.size() == fine.leaves.size());
+    check(fine);
+    for (const auto &leaf : fine.leaves) {
+        glm::dvec3 extent = leaf.box_max - leaf.box_min;
+        REQUIRE(extent.x <= 1.0);
+        REQUIRE(extent.y <= 1.0);
+    }
+
+    // Refitting after moving control points matches a new build
+    srf.control_points(2, 3) += glm::dvec3(0.5, -1, 2);
+    srf.control_points(4, 0) *= 1.5;
+    tinynurbs::surfaceBvhRefit(srf, fine);
+    check(fine);
+    tinynurbs::Bvh3d rebuilt = tinynurbs::surfaceBvh(srf, 3, true);
+    REQUIRE(rebuilt.leaves.size() == fine.leaves.size());
+    for (size_t k = 0; k < fine.leaves.size(); ++k) {
+        REQUIRE(glm::distance(fine.leaves[k].box_min, rebuilt.leaves[k].box_min) == 0);
+        REQUIRE(glm::distance(fine.leaves[k].box_max, rebuilt.leaves[k].box_max) == 0);
+    }
+    REQUIRE(glm::distance(fine.nodes[0].box_min, rebuilt.nodes[0].box_min) == 0);
+    REQUIRE(glm::distance(fine.nodes[0].box_max, rebuilt.nodes[0].box_max) == 0);
+}
+
+TEST_CASE("surfaceRayIntersect (non-rational)", "[surface, non-rational, intersect]")
+{
+    auto srf = getCreasedSurface();
+
+    // The surface is a height field over [0, 4] x [0, 5], vertical rays hit it once
+    std::vector<tinynurbs::Ray3d> rays;
+    for (int i = 0; i < 40; ++i) {
+        for (int j = 0; j < 40; ++j) {
+            glm::dvec3 origin(-0.5 + 5.0 * i / 39, -0.5 + 6.0 * j / 39, 5);
+            rays.push_back(tinynurbs::Ray3d(origin, glm::dvec3(0, 0, -2)));
+        }
+    }
+    std::vector<tinynurbs::RayHit3d> hits;
+    tinynurbs::surfaceRayIntersect(srf, rays, hits, 3);
+    REQUIRE(hits.size() == rays.size());
+    for (size_t k = 0; k < rays.size(); ++k) {
+        const glm::dvec3 &o = rays[k].origin;
+        bool inside = o.x > 1e-9 && o.x < 4 - 1e-9 && o.y > 1e-9 && o.y < 5 - 1e-9;
+        bool outside = o.x < 0 || o.x > 4 || o.y < 0 || o.y > 5;
+        if (outside) {
+            REQUIRE(!hits[k].hit);
+        }
+        if (!inside) {
+            continue;
+        }
+        REQUIRE(hits[k].hit);
+        auto ders = tinynurbs::surfaceDerivatives(srf, 1, hits[k].uv.x, hits[k].uv.y);
+        glm::dvec3 pt = o + hits[k].t * rays[k].direction;
+        REQUIRE(glm::distance(ders(0, 0), pt) == Approx(0).margin(1e-9));
+        REQUIRE(glm::length(hits[k].normal) == Approx(1));
+        REQUIRE(glm::dot(hits[k].normal, ders(1, 0)) == Approx(0).margin(1e-9));
+        REQUIRE(glm::dot(hits[k].normal, ders(0, 1)) == Approx(0).margin(1e-9));
+
+        tinynurbs::RayHit3d single = tinynurbs::surfaceRayIntersect(srf, rays[k]);
+        REQUIRE(single.hit);
+        REQUIRE(single.t == hits[k].t);
+        REQUIRE(single.uv == hits[k].uv);
+    }
+
+    // Hits beyond the range of the ray are ignored, and a ray from below the
+    // surface pointing up hits it from the other side
+    tinynurbs::Ray3d ray(glm::dvec3(1.5, 2.5, 5), glm::dvec3(0, 0, -1), 0, 3);
+    REQUIRE(!tinynurbs::surfaceRayIntersect(srf, ray).hit);
+    ray.t_max = 10;
+    tinynurbs::RayHit3d down = tinynurbs::surfaceRayIntersect(srf, ray);
+    REQUIRE(down.hit);
+    tinynurbs::RayHit3d up =
+        tinynurbs::surfaceRayIntersect(srf, tinynurbs::Ray3d(glm::dvec3(1.5, 2.5, -5),
+                                                             glm::dvec3(0, 0, 1)));
+    REQUIRE(up.hit);
+    REQUIRE(up.t == Approx(10 - down.t));
+    REQUIRE(up.uv.x == Approx(down.uv.x));
+    REQUIRE(up.uv.y == Approx(down.uv.y));
+}
+
+TEST_CASE("SoaSurface (non-rational)", "[surface, non-rational, evaluate]")
+{
+    auto srf = getWavySurface();
+    tinynurbs::SoaSurface3d soa(srf);
+    REQUIRE(soa.w.empty());
+    REQUIRE(soa.stride % 8 == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(soa.x.data()) % 64 == 0);
+
+    tinynurbs::Surface3d back(soa);
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 6; ++j) {
+            REQUIRE(back.control_points(i, j) == srf.control_points(i, j));
+        }
+    }
+
+    std::vector<double> us = {0., 0.25, 0.4, 0.7, 1.};
+    std::vector<double> vs = {0., 0.1, 0.3, 0.45, 0.6, 0.8, 1.};
+    tinynurbs::array2<glm::dvec3> pts;
+    tinynurbs::surfaceGrid(soa, us, vs, pts);
+    for (size_t i = 0; i < us.size(); ++i) {
+        for (size_t j = 0; j < vs.size(); ++j) {
+            glm::dvec3 pt = tinynurbs::surfacePoint(srf, us[i], vs[j]);
+            glm::dvec3 soa_pt = tinynurbs::surfacePoint(soa, us[i], vs[j]);
+            REQUIRE(glm::distance(pts(i, j), pt) == Approx(0).margin(1e-12));
+            REQUIRE(glm::distance(soa_pt, pt) == Approx(0).margin(1e-12));
+            auto ders = tinynurbs::surfaceDerivatives(srf, 2, us[i], vs[j]);
+            auto soa_ders = tinynurbs::surfaceDerivatives(soa, 2, us[i], vs[j]);
+            for (int k = 0; k <= 2; ++k) {
+                for (int l = 0; l <= 2 - k; ++l) {
+                    REQUIRE(glm::distance(soa_ders(k, l), ders(k, l)) == Approx(0).margin(1e-9));
+                }
+            }
+        }
+    }
+}
+
 TEST_CASE("surfaceIsValid (non-rational)", "[surface, check]")
 {
     auto srf = getBilinearPatch();